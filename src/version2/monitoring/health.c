@@ -26,6 +26,7 @@ void init_backend_pool(struct backend_pool* pool) {
         server->total_response_time = 0;
         server->avg_response_time = 0;
         server->failure_rate = 0;
+        upstream_pool_init(&server->idle_connections);
     }
 }
 
@@ -33,6 +34,7 @@ void cleanup_backend_pool(struct backend_pool* pool) {
     pthread_mutex_destroy(&pool->pool_mutex);
     for (int i = 0; i < pool->server_count; i++) {
         pthread_mutex_destroy(&pool->servers[i].server_mutex);
+        upstream_pool_destroy(&pool->servers[i].idle_connections);
     }
 }
 
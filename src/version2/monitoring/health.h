@@ -4,6 +4,7 @@
 #include <stdbool.h>
 #include <time.h>
 #include <pthread.h>
+#include "upstream_pool.h"
 
 #define MAX_FAILURES 3
 #define MAX_BACKENDS 5 // HTTP 서버 최대 개수
@@ -26,6 +27,9 @@ struct backend_server
     double failure_rate;
 
     pthread_mutex_t server_mutex; // 개별 서버 상태를 위한 뮤텍스
+
+    // 백엔드 서버와의 keep-alive 연결 풀
+    struct upstream_pool idle_connections;
 };
 
 struct backend_pool
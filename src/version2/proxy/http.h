@@ -0,0 +1,125 @@
+#ifndef HTTP_H
+#define HTTP_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define HTTP_LINE_MAX 64 // 응답 헤더 해석에 필요한 줄 앞부분 (이보다 긴 줄은 잘라서 해석)
+
+/**
+ * HTTP/1.x 응답의 끝을 판단하기 위한 스트리밍 해석기
+ * - 응답 데이터를 받는 대로 넣으면 상태 줄과 헤더를 해석하고 본문 길이를 계산
+ * - 버퍼를 복사해 두지 않으므로 청크 경계에 걸친 헤더도 줄 단위로 이어서 해석
+ * - chunked 본문은 청크 크기 줄과 trailer만 해석하고 데이터는 길이만큼 건너뜀
+ * - 응답의 끝을 알 수 없으면(Content-Length, chunked 모두 없음) 백엔드가 연결을 닫을 때까지가 응답
+ */
+struct http_response
+{
+    int headers_done;
+    int head_request; // HEAD 요청에 대한 응답은 본문이 없음
+
+    char line[HTTP_LINE_MAX];
+    size_t line_len;
+    int status_line_done;
+
+    int status;
+    int http_minor;            // HTTP/1.x의 x
+    long long content_length;  // Content-Length, 없으면 -1
+    int chunked;               // Transfer-Encoding: chunked
+    int connection_close;      // Connection: close
+    int connection_keep_alive; // Connection: keep-alive (HTTP/1.0)
+    int trailing_data;         // 응답이 끝난 뒤에 데이터가 더 온 경우
+    int malformed;             // chunked 형식 오류 (이후로는 연결이 닫힐 때까지 그대로 중계)
+
+    int chunk_state;                    // chunked 본문 해석 위치
+    unsigned long long chunk_size;      // 해석 중인 청크 크기 줄의 값
+    int chunk_digits;                   // 청크 크기 줄에서 읽은 16진수 자릿수
+    unsigned long long chunk_remaining; // 현재 청크에서 남은 데이터
+
+    unsigned long long body_received; // 헤더 이후 받은 바이트 (chunked면 청크 크기 줄 포함)
+};
+
+void http_response_init(struct http_response *resp, int head_request);
+
+// 받은 응답 데이터를 해석 (Content-Length 본문은 길이만 세므로 data가 NULL이어도 됨, chunked 본문은 data 필요)
+// 반환값: 이 응답에 속하는 바이트 수 (len보다 작으면 응답이 끝난 뒤의 데이터)
+size_t http_response_feed(struct http_response *resp, const char *data, size_t len);
+
+// 본문 길이를 알고 있고 끝까지 받았는지
+int http_response_complete(const struct http_response *resp);
+
+// 남은 본문 길이 (길이를 모르거나 chunked면 (size_t)-1)
+size_t http_response_remaining(const struct http_response *resp);
+
+// 본문을 data 없이 길이만으로 따라갈 수 있는지 (splice로 중계해도 응답의 끝을 알 수 있음)
+int http_response_length_known(const struct http_response *resp);
+
+// 응답이 끝난 뒤 같은 연결로 다음 요청을 보낼 수 있는지
+int http_response_keep_alive(const struct http_response *resp);
+
+// 요청 헤더 안의 위치 (요청 시작 기준 오프셋, 복사하지 않고 버퍼를 그대로 가리킴)
+struct http_slice
+{
+    uint32_t offset;
+    uint32_t length;
+};
+
+// 요청 처리에 필요한 헤더, 파싱하면서 이름으로 분류해 두므로 조회는 배열 접근 한 번
+enum http_header_id
+{
+    HTTP_HEADER_HOST,
+    HTTP_HEADER_CONTENT_LENGTH,
+    HTTP_HEADER_TRANSFER_ENCODING,
+    HTTP_HEADER_CONNECTION,
+    HTTP_HEADER_COUNT
+};
+
+#define HTTP_PARSE_AGAIN 0  // 헤더가 아직 끝나지 않음
+#define HTTP_PARSE_DONE 1   // 헤더 끝까지 해석함
+#define HTTP_PARSE_ERROR -1 // 잘못된 요청
+
+/**
+ * HTTP/1.x 요청 헤더를 나누어 받는 대로 이어서 해석하는 파서
+ * - 마지막으로 본 위치를 기억하므로 recv마다 처음부터 다시 찾지 않음 (전체 O(헤더 길이))
+ * - 줄 끝, ':', 제어 문자는 http_scan_line()으로 한 번에 찾음 (SIMD)
+ * - 요청 줄과 헤더는 복사하지 않고 요청 시작 기준 오프셋/길이로만 기록
+ * - 같은 요청의 데이터는 앞부분이 바뀌지 않은 채 뒤로만 늘어나는 연속된 영역이어야 함
+ */
+struct http_request
+{
+    int state;            // 요청 줄 / 헤더 / 완료
+    size_t scan_pos;      // 다음에 검사할 위치
+    size_t line_start;    // 해석 중인 줄의 시작
+    size_t request_start; // 요청 줄의 시작 (앞에 온 빈 줄은 요청에 포함하지 않음)
+    size_t header_len;    // 헤더 끝의 빈 줄 다음 위치 (완료된 경우)
+    size_t line_colon;    // 해석 중인 줄의 첫 ':' 위치 (줄이 나뉘어 도착해도 다시 찾지 않음)
+
+    struct http_slice method;
+    struct http_slice uri;
+    struct http_slice headers[HTTP_HEADER_COUNT]; // 없는 헤더는 length 0
+    int http_minor;                               // HTTP/1.x의 x
+
+    long long content_length; // Content-Length, 없으면 -1
+    int chunked;              // Transfer-Encoding이 있으면 본문 길이를 알 수 없음
+    int head_request;         // HEAD 요청에 대한 응답은 본문이 없음
+    int idempotent;           // 여러 번 보내도 결과가 같은 메서드 (GET, HEAD, PUT, DELETE, OPTIONS, TRACE)
+    int keep_alive;           // 응답 후에도 연결 유지 (HTTP/1.1 기본, HTTP/1.0은 keep-alive 명시)
+};
+
+void http_request_init(struct http_request *req);
+
+/**
+ * 지금까지 받은 요청 데이터를 이어서 해석
+ * - data: 요청의 시작부터 len 바이트 (이전 호출보다 길거나 같아야 함)
+ * - 반환값: HTTP_PARSE_DONE / HTTP_PARSE_AGAIN / HTTP_PARSE_ERROR
+ */
+int http_request_parse(struct http_request *req, const char *data, size_t len);
+
+// 헤더 값의 시작 위치 (앞뒤 공백 제외), 헤더가 없으면 NULL
+const char *http_request_header(const struct http_request *req, const char *data,
+                                enum http_header_id id, size_t *len);
+
+// request_start부터 헤더 + 본문 전체 길이, 본문 길이를 알 수 없으면(chunked 등) -1
+long long http_request_length(const struct http_request *req);
+
+#endif
@@ -1,3 +1,4 @@
+#define _GNU_SOURCE
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -12,10 +13,15 @@
 #include <time.h>
 #include <pthread.h>
 #include "health.h"
+#include "http.h"
 #include "../utils/logger.h"
 
 #define CHUNK_SIZE 1048576
 
+// 백엔드가 응답을 시작하기 전에 실패했을 때 클라이언트에 보내는 응답
+static const char BAD_GATEWAY_RESPONSE[] =
+    "HTTP/1.1 502 Bad Gateway\r\nContent-Length: 0\r\nConnection: close\r\n\r\n";
+
 static struct backend_pool pool;
 static pthread_mutex_t server_select_mutex = PTHREAD_MUTEX_INITIALIZER;
 static int current_server = 0;
@@ -80,8 +86,87 @@ int select_server()
     return selected;
 }
 
+// 버퍼의 데이터를 모두 전송 (blocking 소켓)
+static int send_all(int fd, const char *data, size_t len)
+{
+    size_t total_sent = 0;
+    while (total_sent < len)
+    {
+        ssize_t sent = send(fd, data + total_sent, len - total_sent, MSG_NOSIGNAL);
+        if (sent < 0)
+            return -1;
+        total_sent += sent;
+    }
+    return 0;
+}
+
+/**
+ * 백엔드 서버에 새로 연결
+ *
+ * 반환값:
+ * - 성공: 소켓 fd
+ * - 실패: -1
+ */
+static int connect_backend(struct backend_server *server)
+{
+    int target_socket = socket(AF_INET, SOCK_STREAM, 0);
+    if (target_socket < 0)
+    {
+        log_message(LOG_ERROR, "Failed to create socket for backend connection");
+        return -1;
+    }
+
+    // TCP_NODELAY 설정
+    int flag = 1;
+    setsockopt(target_socket, IPPROTO_TCP, TCP_NODELAY, (char *)&flag, sizeof(int));
+
+    // 소켓 버퍼 크기를 10MB로 설정
+    int socket_buffer_size = 10485760; // 10MB
+    setsockopt(target_socket, SOL_SOCKET, SO_SNDBUF, (char *)&socket_buffer_size, sizeof(int));
+
+    struct sockaddr_in target_addr;
+    memset(&target_addr, 0, sizeof(target_addr));
+    target_addr.sin_family = AF_INET;
+    target_addr.sin_port = htons(server->port);
+    target_addr.sin_addr.s_addr = inet_addr(server->address);
+
+    if (connect(target_socket, (struct sockaddr *)&target_addr, sizeof(target_addr)) < 0)
+    {
+        log_message(LOG_ERROR, "Failed to connect to backend %s:%d",
+                    server->address, server->port);
+        close(target_socket);
+        return -1;
+    }
+
+    upstream_pool_note_created(&server->idle_connections);
+    return target_socket;
+}
+
+/**
+ * 백엔드 서버와 연결된 소켓을 가져옴
+ * - 서버의 keep-alive 풀에 idle 연결이 있으면 재사용하고(*reused = true), 없으면 새로 연결
+ *
+ * 반환값:
+ * - 성공: 소켓 fd
+ * - 실패: -1
+ */
+static int open_backend(struct backend_server *server, bool *reused)
+{
+    int target_socket = upstream_pool_checkout(&server->idle_connections);
+    *reused = target_socket >= 0;
+    if (target_socket >= 0)
+    {
+        log_message(LOG_INFO, "Reusing keep-alive connection to backend %s:%d",
+                    server->address, server->port);
+        return target_socket;
+    }
+    return connect_backend(server);
+}
+
 /**
  * 클라이언트 요청을 처리하는 스레드 함수
+ * - 요청 헤더를 모두 받은 뒤 백엔드로 요청(본문 포함)을 전달하고 응답을 Content-Length까지 중계
+ * - 요청과 응답이 정확히 끝난 keep-alive 연결은 닫지 않고 백엔드 서버의 풀에 반납
  *
  * 매개변수:
  * - arg: connection_info 구조체 포인터 (클라이언트 연결 정보)
@@ -105,97 +190,157 @@ void *handle_client(void *arg)
     char *client_ip = inet_ntoa(client_addr.sin_addr);
     log_message(LOG_INFO, "Handling connection from %s in new thread", client_ip);
 
-    // 백엔드 서버 선택
-    int server_idx = select_server();
-    if (server_idx < 0)
+    // TCP_NODELAY 설정
+    int flag = 1;
+    setsockopt(client_socket, IPPROTO_TCP, TCP_NODELAY, (char *)&flag, sizeof(int));
+
+    // 소켓 버퍼 크기를 10MB로 설정
+    int socket_buffer_size = 10485760; // 10MB
+    setsockopt(client_socket, SOL_SOCKET, SO_RCVBUF, (char *)&socket_buffer_size, sizeof(int));
+
+    // 요청 헤더 수신 (요청 길이를 알아야 백엔드 연결을 재사용할 수 있음)
+    // 받은 부분까지 이어서 해석하므로 recv마다 처음부터 헤더 끝을 찾지 않음
+    struct http_request request;
+    http_request_init(&request);
+    int parsed = HTTP_PARSE_AGAIN;
+    size_t header_received = 0;
+    while (header_received < CHUNK_SIZE)
+    {
+        ssize_t n = recv(client_socket, buffer + header_received, CHUNK_SIZE - header_received, 0);
+        if (n <= 0)
+            break;
+        header_received += n;
+        parsed = http_request_parse(&request, buffer, header_received);
+        if (parsed != HTTP_PARSE_AGAIN)
+            break;
+    }
+
+    if (parsed != HTTP_PARSE_DONE)
     {
+        log_message(LOG_ERROR, "Failed to receive request headers from client");
+        free(buffer);
         close(client_socket);
         free(conn_info);
         return NULL;
     }
 
-    struct backend_server *server = &pool.servers[server_idx];
-    int target_socket = socket(AF_INET, SOCK_STREAM, 0);
-    if (target_socket < 0)
+    long long request_length = http_request_length(&request);
+
+    // 백엔드 서버 선택
+    int server_idx = select_server();
+    if (server_idx < 0)
     {
-        log_message(LOG_ERROR, "Failed to create socket for backend connection");
+        free(buffer);
         close(client_socket);
         free(conn_info);
         return NULL;
     }
 
-    // TCP_NODELAY 설정
-    int flag = 1;
-    setsockopt(client_socket, IPPROTO_TCP, TCP_NODELAY, (char *)&flag, sizeof(int));
-    setsockopt(target_socket, IPPROTO_TCP, TCP_NODELAY, (char *)&flag, sizeof(int));
-
-    // 소켓 버퍼 크기를 10MB로 설정
-    int socket_buffer_size = 10485760; // 10MB
-    setsockopt(client_socket, SOL_SOCKET, SO_RCVBUF, (char *)&socket_buffer_size, sizeof(int));
-    setsockopt(target_socket, SOL_SOCKET, SO_SNDBUF, (char *)&socket_buffer_size, sizeof(int));
+    struct backend_server *server = &pool.servers[server_idx];
 
     struct timespec start_time;
     clock_gettime(CLOCK_MONOTONIC, &start_time);
 
     track_request_start(&pool, server_idx);
 
-    struct sockaddr_in target_addr;
-    memset(&target_addr, 0, sizeof(target_addr));
-    target_addr.sin_family = AF_INET;
-    target_addr.sin_port = htons(server->port);
-    target_addr.sin_addr.s_addr = inet_addr(server->address);
-
     bool request_success = true;
-    if (connect(target_socket, (struct sockaddr *)&target_addr, sizeof(target_addr)) < 0)
+    bool response_started = false;
+    bool backend_reusable = false;
+    bool reused;
+    int target_socket = open_backend(server, &reused);
+
+    // 클라이언트 -> 백엔드 요청 전달 (본문 길이를 알면 본문 끝까지)
+    // 요청 앞의 빈 줄은 전달하지 않음
+    size_t to_send = header_received - request.request_start;
+    if (request_length >= 0 && (unsigned long long)request_length < to_send)
+        to_send = request_length; // 요청 뒤에 이어서 온 데이터는 전달하지 않음
+    // 요청 전체가 첫 버퍼에 있으면 다른 백엔드 연결로 다시 보낼 수 있음 (본문을 더 읽으면 버퍼를 덮어씀)
+    bool replayable = request_length < 0 || (unsigned long long)request_length == to_send;
+
+    while (target_socket >= 0)
     {
-        log_message(LOG_ERROR, "Failed to connect to backend %s:%d",
-                    server->address, server->port);
-        request_success = false;
-    }
-    else
-    {
-        // 클라이언트 -> 백엔드 요청 전달
-        int bytes_received;
-        while ((bytes_received = recv(client_socket, buffer, CHUNK_SIZE, 0)) > 0)
+        request_success = true;
+        unsigned long long forwarded = 0;
+
+        if (send_all(target_socket, buffer + request.request_start, to_send) < 0)
+        {
+            log_message(LOG_ERROR, "Failed to send data to backend");
+            request_success = false;
+        }
+        forwarded += to_send;
+
+        while (request_success && request_length >= 0 && forwarded < (unsigned long long)request_length)
         {
-            if (send(target_socket, buffer, bytes_received, 0) < 0)
+            size_t want = CHUNK_SIZE;
+            if ((unsigned long long)request_length - forwarded < want)
+                want = request_length - forwarded;
+            ssize_t bytes_received = recv(client_socket, buffer, want, 0);
+            if (bytes_received <= 0)
             {
-                log_message(LOG_ERROR, "Failed to send data to backend");
+                log_message(LOG_ERROR, "Failed to receive data from client");
                 request_success = false;
                 break;
             }
-
-            if (strstr(buffer, "\r\n\r\n") != NULL)
+            if (send_all(target_socket, buffer, bytes_received) < 0)
             {
+                log_message(LOG_ERROR, "Failed to send data to backend");
+                request_success = false;
                 break;
             }
+            forwarded += bytes_received;
         }
 
-        if (bytes_received < 0)
+        // 백엔드 -> 클라이언트 응답 전달 (응답 길이를 알면 다음 응답의 데이터를 읽지 않도록 남은 만큼만 수신)
+        struct http_response response;
+        http_response_init(&response, request.head_request);
+        while (request_success && !http_response_complete(&response))
         {
-            log_message(LOG_ERROR, "Failed to receive data from client");
-            request_success = false;
-        }
-
-        // 백엔드 -> 클라이언트 응답 전달
-        while (request_success && (bytes_received = recv(target_socket, buffer, CHUNK_SIZE, 0)) > 0)
-        {
-            int bytes_sent = 0;
-            while (bytes_sent < bytes_received)
+            size_t want = http_response_remaining(&response);
+            if (want > CHUNK_SIZE)
+                want = CHUNK_SIZE;
+            ssize_t bytes_received = recv(target_socket, buffer, want, 0);
+            if (bytes_received <= 0)
             {
-                int sent = send(client_socket, buffer + bytes_sent,
-                                bytes_received - bytes_sent, 0);
-                if (sent < 0)
+                // 응답을 시작한 뒤의 EOF는 길이 없는 응답의 끝, 첫 바이트 전의 EOF나 오류는 실패
+                if (bytes_received < 0 || !response_started)
                 {
-                    log_message(LOG_ERROR, "Failed to send response to client");
+                    log_message(LOG_ERROR, "Failed to receive response from backend");
                     request_success = false;
-                    break;
                 }
-                bytes_sent += sent;
+                break;
+            }
+            response_started = true;
+
+            size_t used = http_response_feed(&response, buffer, bytes_received);
+            if (send_all(client_socket, buffer, used) < 0)
+            {
+                log_message(LOG_ERROR, "Failed to send response to client");
+                request_success = false;
+                break;
             }
         }
+
+        backend_reusable = request_success && request_length >= 0 &&
+                           forwarded == (unsigned long long)request_length &&
+                           http_response_keep_alive(&response);
+
+        // 풀에서 꺼낸 연결을 백엔드가 그 사이에 닫았으면 새 연결로 한 번만 다시 시도
+        if (request_success || response_started || !reused || !replayable)
+            break;
+        log_message(LOG_INFO, "Retrying request on a new connection to backend %s:%d",
+                    server->address, server->port);
+        close(target_socket);
+        reused = false;
+        target_socket = connect_backend(server);
     }
 
+    if (target_socket < 0)
+        request_success = false;
+
+    // 응답을 보내기 전에 실패했으면 빈 응답 대신 502를 보냄
+    if (!request_success && !response_started)
+        send_all(client_socket, BAD_GATEWAY_RESPONSE, sizeof(BAD_GATEWAY_RESPONSE) - 1);
+
     struct timespec end_time;
     clock_gettime(CLOCK_MONOTONIC, &end_time);
     double response_time = (end_time.tv_sec - start_time.tv_sec) * 1000.0 +
@@ -213,9 +358,14 @@ void *handle_client(void *arg)
                        pool.total_failures,
                        pool.avg_response_time);
 
+    upstream_pool_log_stats(&server->idle_connections, server->address, server->port);
+
     free(buffer);
     close(client_socket);
-    close(target_socket);
+    if (backend_reusable)
+        upstream_pool_checkin(&server->idle_connections, target_socket);
+    else if (target_socket >= 0)
+        close(target_socket);
     free(conn_info);
     return NULL;
 }
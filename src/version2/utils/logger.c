@@ -1,39 +1,401 @@
+#define _GNU_SOURCE
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <time.h>
 #include <stdarg.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <signal.h>
+#include <sys/uio.h>
+#include <sys/eventfd.h>
 #include "logger.h"
 
 #define LOG_FILE "proxy_server.log"
 
-void log_message(LogLevel level, const char* format, ...) {
-   FILE* file = fopen(LOG_FILE, "ab");
-   if (!file) return;
+/**
+ * 비동기 로거
+ * - 로그를 남기는 스레드는 자기 링 버퍼의 빈 칸에 한 줄을 바로 써넣고 tail만 올림 (잠금 없음)
+ * - 전용 writer 스레드가 모든 링에서 쌓인 줄을 모아 writev 한 번으로 파일(계속 열어 둠)과 표준 출력에 씀
+ *   쌓인 줄이 없으면 eventfd에서 잠들고, 잠든 writer를 본 스레드만 eventfd에 써서 깨움
+ * - 링이 가득 차면 INFO는 버리고 수만 셈, ERROR는 버리지 않고 그 자리에서 직접 씀
+ *   (링을 얻지 못한 스레드, writer가 없거나 멈춘 뒤의 로그도 직접 씀)
+ * - 링은 스레드가 처음 로그를 남길 때 얻고, 스레드가 끝나면 다른 스레드가 이어서 쓸 수 있도록 돌려줌
+ */
+#define LOG_RECORD_SIZE 256      // 한 줄 최대 길이 (시각, 레벨 포함, 넘으면 잘림)
+#define LOG_RING_RECORDS 512     // 스레드마다 쌓아 둘 수 있는 줄 수 (2의 거듭제곱, 링 하나 128KB)
+#define LOG_MAX_RINGS 64         // 링 개수 상한 (넘는 스레드는 링 없이 직접 씀)
+#define LOG_WRITE_BATCH 256      // writev 한 번에 넘기는 줄 수 (IOV_MAX 이하)
+
+struct log_record
+{
+   unsigned short length;
+   char text[LOG_RECORD_SIZE - sizeof(unsigned short)];
+};
+
+// 스레드 하나가 쓰고 writer가 읽는 링 (head/tail을 서로 다른 캐시 라인에 둠)
+struct log_ring
+{
+   _Alignas(64) atomic_uint tail;  // 소유 스레드만 증가
+   unsigned int cached_head;       // 소유 스레드가 마지막으로 읽은 head (빈 칸이 있는 동안은 head를 다시 읽지 않음)
+   atomic_ulong dropped;           // 가득 차서 버린 줄 수
+   atomic_bool owned;              // 스레드가 사용 중
+   _Alignas(64) atomic_uint head;  // writer만 증가
+   struct log_record records[LOG_RING_RECORDS];
+};
+
+static struct
+{
+   pthread_once_t once;
+   pthread_key_t ring_key;
+   pthread_t writer;
+   int writer_started;
+   int fd;
+   int wake_fd;                  // writer를 깨우는 eventfd
+   atomic_bool writer_sleeping;  // writer가 wake_fd에서 기다리는 중 (깨운 스레드가 false로 바꿈)
+   atomic_bool stopping;         // 프로세스 종료 중, writer는 남은 줄을 쓰고 끝남
+
+   // writer가 끝난 뒤에는 링을 비우는 스레드가 여럿일 수 있으므로 잠금으로 하나씩
+   pthread_mutex_t stop_lock;
+   int writer_done;
+
+   struct log_ring *_Atomic rings[LOG_MAX_RINGS];
+   atomic_int ring_count;
+   unsigned long dropped_reported;
+} logger = {.once = PTHREAD_ONCE_INIT, .fd = -1, .wake_fd = -1, .stop_lock = PTHREAD_MUTEX_INITIALIZER};
+
+static __thread struct log_ring *thread_ring;
+static __thread int thread_ring_failed; // 링을 얻지 못함 (다시 시도하지 않고 직접 씀)
+static __thread time_t cached_second = -1;
+static __thread char cached_time[32];
+
+// 스레드가 끝나면 링을 돌려줌 (남은 줄은 writer가 계속 비움)
+static void release_ring(void *ring) {
+   atomic_store_explicit(&((struct log_ring *)ring)->owned, false, memory_order_release);
+}
+
+static struct log_ring *acquire_ring(void) {
+   // 끝난 스레드가 돌려준 링을 먼저 재사용
+   int count = atomic_load_explicit(&logger.ring_count, memory_order_acquire);
+   for (int i = 0; i < count && i < LOG_MAX_RINGS; i++)
+   {
+      struct log_ring *ring = atomic_load_explicit(&logger.rings[i], memory_order_acquire);
+      bool expected = false;
+      if (ring && atomic_compare_exchange_strong(&ring->owned, &expected, true))
+         return ring;
+   }
+
+   int index = atomic_fetch_add(&logger.ring_count, 1);
+   if (index >= LOG_MAX_RINGS)
+   {
+      atomic_fetch_sub(&logger.ring_count, 1);
+      return NULL;
+   }
+
+   struct log_ring *ring = aligned_alloc(_Alignof(struct log_ring), sizeof(struct log_ring));
+   if (!ring)
+   {
+      // 자리는 이미 차지했으므로 비워 둔 채로 둠 (writer는 NULL을 건너뜀)
+      return NULL;
+   }
+   atomic_init(&ring->tail, 0);
+   atomic_init(&ring->head, 0);
+   atomic_init(&ring->dropped, 0);
+   atomic_init(&ring->owned, true);
+   ring->cached_head = 0;
+   atomic_store_explicit(&logger.rings[index], ring, memory_order_release);
+   return ring;
+}
+
+// iov를 모두 쓸 때까지 writev 반복 (일부만 쓰인 경우 남은 부분부터 다시)
+static void write_all(int fd, struct iovec *iov, int count) {
+   while (count > 0)
+   {
+      ssize_t written = writev(fd, iov, count);
+      if (written < 0)
+      {
+         if (errno == EINTR)
+            continue;
+         return;
+      }
+      while (count > 0 && (size_t)written >= iov->iov_len)
+      {
+         written -= iov->iov_len;
+         iov++;
+         count--;
+      }
+      if (count > 0)
+      {
+         iov->iov_base = (char *)iov->iov_base + written;
+         iov->iov_len -= written;
+      }
+   }
+}
+
+static void write_batch(struct iovec *iov, int count) {
+   // writev가 iov를 바꾸므로 표준 출력용으로 복사해 둠
+   struct iovec copy[LOG_WRITE_BATCH + 1];
+   memcpy(copy, iov, count * sizeof(*iov));
+   if (logger.fd >= 0)
+      write_all(logger.fd, iov, count);
+   write_all(STDOUT_FILENO, copy, count);
+}
+
+// 새로 버려진 줄이 있으면 그 수를 한 줄로 기록
+static int append_drop_notice(struct iovec *iov, char *buffer, size_t size) {
+   unsigned long dropped = log_dropped_records();
+   if (dropped == logger.dropped_reported)
+      return 0;
+
+   int length = snprintf(buffer, size, "[LOGGER][ERROR] %lu INFO log records dropped (buffer full), %lu in total\n",
+                         dropped - logger.dropped_reported, dropped);
+   logger.dropped_reported = dropped;
+   iov->iov_base = buffer;
+   iov->iov_len = (size_t)length < size ? (size_t)length : size - 1;
+   return 1;
+}
+
+// 모든 링에 쌓인 줄을 한 번씩 비움, 쓴 줄 수를 반환 (한 번에 한 스레드만 호출)
+static int drain_rings(void) {
+   struct iovec iov[LOG_WRITE_BATCH + 1];
+   char notice[128];
+   int written = 0;
+
+   int count = atomic_load_explicit(&logger.ring_count, memory_order_acquire);
+   for (int i = 0; i < count && i < LOG_MAX_RINGS; i++)
+   {
+      struct log_ring *ring = atomic_load_explicit(&logger.rings[i], memory_order_acquire);
+      if (!ring)
+         continue;
+
+      unsigned int head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+      unsigned int tail = atomic_load_explicit(&ring->tail, memory_order_acquire);
+      while (head != tail)
+      {
+         int batch = 0;
+         unsigned int next = head;
+         while (next != tail && batch < LOG_WRITE_BATCH)
+         {
+            struct log_record *record = &ring->records[next & (LOG_RING_RECORDS - 1)];
+            iov[batch].iov_base = record->text;
+            iov[batch].iov_len = record->length;
+            batch++;
+            next++;
+         }
+         write_batch(iov, batch);
+         written += batch;
+
+         // 다 쓴 칸을 돌려줌 (이후에 스레드가 같은 칸에 새 줄을 씀)
+         head = next;
+         atomic_store_explicit(&ring->head, head, memory_order_release);
+      }
+   }
+
+   if (append_drop_notice(iov, notice, sizeof(notice)))
+      write_batch(iov, 1);
+   return written;
+}
+
+// 비우지 않은 줄이 남은 링이 있는지
+static int rings_pending(void) {
+   int count = atomic_load_explicit(&logger.ring_count, memory_order_acquire);
+   for (int i = 0; i < count && i < LOG_MAX_RINGS; i++)
+   {
+      struct log_ring *ring = atomic_load_explicit(&logger.rings[i], memory_order_acquire);
+      if (ring && atomic_load_explicit(&ring->head, memory_order_relaxed) !=
+                  atomic_load_explicit(&ring->tail, memory_order_acquire))
+         return 1;
+   }
+   return 0;
+}
+
+static void wake_writer(void) {
+   uint64_t one = 1;
+   while (write(logger.wake_fd, &one, sizeof(one)) < 0 && errno == EINTR)
+      ;
+}
+
+static void *writer_main(void *arg) {
+   (void)arg;
+   while (!atomic_load_explicit(&logger.stopping, memory_order_acquire))
+   {
+      if (drain_rings() > 0)
+         continue;
 
+      // 잠들기 전에 표시하고 링을 다시 확인 (log_message의 tail 저장 → 표시 확인과 짝을 이루는 fence)
+      atomic_store_explicit(&logger.writer_sleeping, true, memory_order_relaxed);
+      atomic_thread_fence(memory_order_seq_cst);
+      if (rings_pending() || atomic_load_explicit(&logger.stopping, memory_order_relaxed))
+      {
+         atomic_store_explicit(&logger.writer_sleeping, false, memory_order_relaxed);
+         continue;
+      }
+
+      uint64_t value;
+      while (read(logger.wake_fd, &value, sizeof(value)) < 0 && errno == EINTR)
+         ;
+      atomic_store_explicit(&logger.writer_sleeping, false, memory_order_relaxed);
+   }
+   return NULL;
+}
+
+/**
+ * 프로세스가 끝날 때 writer를 멈추고 남은 로그를 씀 (atexit)
+ * - 다른 스레드는 계속 로그를 남길 수 있으므로, 이후의 로그는 log_message가 stopping을 보고 직접 씀
+ * - 그 때문에 파일은 닫지 않음
+ */
+static void logger_shutdown(void) {
+   if (!logger.writer_started)
+      return;
+   atomic_store_explicit(&logger.stopping, true, memory_order_seq_cst);
+   wake_writer();
+   pthread_join(logger.writer, NULL);
+
+   pthread_mutex_lock(&logger.stop_lock);
+   logger.writer_done = 1;
+   drain_rings();
+   pthread_mutex_unlock(&logger.stop_lock);
+}
+
+static void logger_init(void) {
+   pthread_key_create(&logger.ring_key, release_ring);
+   logger.fd = open(LOG_FILE, O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+   logger.wake_fd = eventfd(0, EFD_CLOEXEC);
+   if (logger.wake_fd < 0)
+      return; // writer 없이 모든 로그를 직접 씀
+
+   // writer는 어떤 시그널도 받지 않도록 모두 막은 상태로 시작 (reactor의 epoll_wait EINTR 처리에 영향 없도록)
+   sigset_t all, previous;
+   sigfillset(&all);
+   pthread_sigmask(SIG_BLOCK, &all, &previous);
+   logger.writer_started = pthread_create(&logger.writer, NULL, writer_main, NULL) == 0;
+   pthread_sigmask(SIG_SETMASK, &previous, NULL);
+   if (logger.writer_started)
+      atexit(logger_shutdown);
+}
+
+// 한 줄을 record에 만듦 (시각, 레벨, 메시지, 줄바꿈, 길면 잘림)
+static void format_record(struct log_record *record, LogLevel level, const char *format, va_list args) {
+   // 시각 문자열은 초가 바뀔 때만 다시 만듦 (localtime은 시간대 잠금을 잡으므로)
    time_t now = time(NULL);
-   char time_buf[32];
-   strftime(time_buf, sizeof(time_buf), "%Y-%m-%d %H:%M:%S", localtime(&now));
-   
+   if (now != cached_second)
+   {
+      struct tm tm;
+      localtime_r(&now, &tm);
+      strftime(cached_time, sizeof(cached_time), "%Y-%m-%d %H:%M:%S", &tm);
+      cached_second = now;
+   }
+
    const char* level_str = (level == LOG_INFO) ? "INFO" : "ERROR";
-   
-   fprintf(file, "[%s][%s] ", time_buf, level_str);
-   printf("[%s][%s] ", time_buf, level_str);
-   
-   va_list args, args_copy;
+   size_t size = sizeof(record->text) - 1; // 줄바꿈 자리
+   int length = snprintf(record->text, size, "[%s][%s] ", cached_time, level_str);
+   if (length >= 0 && (size_t)length < size)
+      length += vsnprintf(record->text + length, size - length, format, args);
+
+   // 잘린 줄은 담긴 데까지만 기록
+   if (length < 0)
+      length = 0;
+   if ((size_t)length >= size)
+      length = (int)size - 1;
+   record->text[length++] = '\n';
+   record->length = (unsigned short)length;
+}
+
+// 링을 거치지 않고 바로 씀 (O_APPEND 파일에 대한 write 한 번이라 다른 줄과 섞이지 않음)
+static void write_record(const struct log_record *record) {
+   struct iovec iov = {.iov_base = (void *)record->text, .iov_len = record->length};
+   write_batch(&iov, 1);
+}
+
+// writer가 멈춘 뒤 링에 넣은 줄은 넣은 스레드가 직접 비움
+static void drain_after_stop(void) {
+   pthread_mutex_lock(&logger.stop_lock);
+   if (logger.writer_done)
+      drain_rings();
+   pthread_mutex_unlock(&logger.stop_lock);
+}
+
+void log_message(LogLevel level, const char* format, ...) {
+   pthread_once(&logger.once, logger_init);
+
+   va_list args;
    va_start(args, format);
-   va_copy(args_copy, args);
 
-   vfprintf(file, format, args);
-   fprintf(file, "\n");
-   
-   vprintf(format, args_copy);
-   printf("\n");
-   
+   struct log_ring *ring = thread_ring;
+   if (!ring && !thread_ring_failed && logger.writer_started)
+   {
+      ring = acquire_ring();
+      if (ring)
+      {
+         thread_ring = ring;
+         pthread_setspecific(logger.ring_key, ring);
+      }
+      else
+         thread_ring_failed = 1;
+   }
+
+   // 링이 없거나 writer가 멈췄으면 직접 씀
+   if (!ring || atomic_load_explicit(&logger.stopping, memory_order_acquire))
+   {
+      struct log_record record;
+      format_record(&record, level, format, args);
+      va_end(args);
+      if (ring)
+         drain_after_stop(); // 링에 남은 이 스레드의 앞선 줄을 먼저 씀
+      write_record(&record);
+      return;
+   }
+
+   // 빈 칸이 없으면 writer가 비웠는지 한 번만 다시 확인
+   unsigned int tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+   if (tail - ring->cached_head >= LOG_RING_RECORDS)
+   {
+      ring->cached_head = atomic_load_explicit(&ring->head, memory_order_acquire);
+      if (tail - ring->cached_head >= LOG_RING_RECORDS)
+      {
+         // INFO는 버리고, ERROR는 링에 앞서 쌓인 줄보다 먼저 나가더라도 직접 씀
+         if (level == LOG_ERROR)
+         {
+            struct log_record record;
+            format_record(&record, level, format, args);
+            write_record(&record);
+         }
+         else
+            atomic_fetch_add_explicit(&ring->dropped, 1, memory_order_relaxed);
+         va_end(args);
+         return;
+      }
+   }
+
+   format_record(&ring->records[tail & (LOG_RING_RECORDS - 1)], level, format, args);
    va_end(args);
-   va_end(args_copy);
-   
-   fclose(file);
+   atomic_store_explicit(&ring->tail, tail + 1, memory_order_release);
+
+   // tail 저장 이후에 writer 상태를 읽도록 fence (writer_main의 잠들기 전 확인과 짝)
+   // - writer가 잠들었으면 깨움 (깨우는 것은 한 스레드만)
+   // - 그 사이에 종료가 시작되었으면 방금 넣은 줄이 남지 않도록 직접 비움
+   atomic_thread_fence(memory_order_seq_cst);
+   if (atomic_load_explicit(&logger.writer_sleeping, memory_order_relaxed) &&
+       atomic_exchange_explicit(&logger.writer_sleeping, false, memory_order_relaxed))
+      wake_writer();
+   if (atomic_load_explicit(&logger.stopping, memory_order_relaxed))
+      drain_after_stop();
+}
+
+unsigned long log_dropped_records(void) {
+   unsigned long dropped = 0;
+   int count = atomic_load_explicit(&logger.ring_count, memory_order_acquire);
+   for (int i = 0; i < count && i < LOG_MAX_RINGS; i++)
+   {
+      struct log_ring *ring = atomic_load_explicit(&logger.rings[i], memory_order_acquire);
+      if (ring)
+         dropped += atomic_load_explicit(&ring->dropped, memory_order_relaxed);
+   }
+   return dropped;
 }
 
 void log_http_response(const char* client_ip, int status_code, const char* response_body) {
@@ -8,7 +8,10 @@ typedef enum {
     LOG_ERROR
 } LogLevel;
 
-void log_message(LogLevel level, const char* format, ...);
+// 호출한 스레드의 로그 버퍼에 한 줄을 넣고 바로 반환 (파일과 표준 출력에는 writer 스레드가 모아서 씀)
+void log_message(LogLevel level, const char* format, ...) __attribute__((format(printf, 2, 3)));
+// 로그 버퍼가 가득 차서 버린 INFO 줄 수 (ERROR는 버리지 않고 직접 씀)
+unsigned long log_dropped_records(void);
 void log_http_response(const char* client_ip, int status_code, const char* response_body);
 
 void log_server_metrics(const char* server_addr, int port, int current_requests, 
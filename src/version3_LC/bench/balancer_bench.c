@@ -0,0 +1,263 @@
+// 백엔드 선택 정책 마이크로벤치마크
+// - least-connection (LC 빌드 기본), smooth weighted round robin (RR 빌드 기본), P2C, Maglev
+// - 선택 비용: 선택 한 번에 걸리는 시간 (처리 중인 요청 수도 함께 갱신해서 LC/P2C가 실제처럼 부하를 보게 함)
+// - 분포: 서버별 선택 수가 평균에서 벗어난 최대 비율
+// - Maglev: 서버 하나를 뺀 테이블로 바꿨을 때 서버가 바뀌는 키의 비율 (나머지 연산 해싱과 비교)
+// - least-connection 확장성: 서버 수별 선택 비용 (이전 서버별 구조체 배열 vs structure of arrays)
+//
+// 빌드/실행: make bench && ./balancer_bench [선택 횟수]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdatomic.h>
+#include <limits.h>
+#include <time.h>
+#include "balancer.h"
+
+#define OUTSTANDING 64     // 동시에 처리 중인 요청 수 (가장 오래된 요청부터 끝남)
+#define NUM_KEYS (1 << 16) // 서로 다른 클라이언트 주소 수
+#define REMOVED_SERVER 2   // 테이블에서 빼 보는 서버
+
+#define SCALE_SELECTIONS 200000 // 확장성 측정에서 서버 수마다 선택하는 횟수
+
+static struct backend_pool pool;
+static struct maglev_table maglev;
+static uint64_t keys[NUM_KEYS];
+
+static double now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static void build_keys(void)
+{
+    // 10.0.0.0/8 대역의 임의 클라이언트 주소
+    srand(42);
+    for (int i = 0; i < NUM_KEYS; i++)
+    {
+        uint32_t addr = 0x0A000000u | ((uint32_t)rand() & 0x00FFFFFFu);
+        keys[i] = balancer_hash(&addr, sizeof(addr));
+    }
+}
+
+static int select_least_conn(int i)
+{
+    (void)i;
+    return balancer_select_least_conn(&pool, NULL);
+}
+
+static int select_swrr(int i)
+{
+    (void)i;
+    return balancer_select_swrr(&pool, NULL);
+}
+
+static int select_p2c(int i)
+{
+    (void)i;
+    return balancer_select_p2c(&pool, NULL);
+}
+
+static int select_maglev(int i)
+{
+    return balancer_select_maglev(&pool, &maglev, keys[i & (NUM_KEYS - 1)], NULL);
+}
+
+static void report(const char *name, int (*select)(int), int iterations)
+{
+    int counts[DEFAULT_BACKENDS] = {0};
+    int outstanding[OUTSTANDING];
+
+    double start = now_ns();
+    for (int i = 0; i < iterations; i++)
+    {
+        int idx = select(i);
+        counts[idx]++;
+
+        // 가장 오래된 요청을 끝내고 그 자리에 새 요청을 넣음
+        int slot = i % OUTSTANDING;
+        if (i >= OUTSTANDING)
+            atomic_fetch_sub(&pool.current_requests[outstanding[slot]], 1);
+        atomic_fetch_add(&pool.current_requests[idx], 1);
+        outstanding[slot] = idx;
+    }
+    double ns = (now_ns() - start) / iterations;
+
+    // 다음 정책을 위해 처리 중인 요청 수를 되돌림
+    for (int i = 0; i < pool.server_count; i++)
+        atomic_store(&pool.current_requests[i], 0);
+
+    double mean = (double)iterations / pool.server_count;
+    double worst = 0;
+    for (int i = 0; i < pool.server_count; i++)
+    {
+        double deviation = (counts[i] > mean ? counts[i] - mean : mean - counts[i]) / mean * 100;
+        if (deviation > worst)
+            worst = deviation;
+    }
+
+    printf("  %-12s %7.1f ns/select  max deviation %6.2f%%  [", name, ns, worst);
+    for (int i = 0; i < pool.server_count; i++)
+        printf("%s%d", i ? " " : "", counts[i]);
+    printf("]\n");
+}
+
+static void report_disruption(void)
+{
+    static struct maglev_table reduced;
+    maglev_build(&reduced, &pool, REMOVED_SERVER);
+
+    int owned = 0, moved = 0, moved_other = 0, modulo_moved = 0;
+    for (int i = 0; i < NUM_KEYS; i++)
+    {
+        int before = balancer_select_maglev(&pool, &maglev, keys[i], NULL);
+        int after = balancer_select_maglev(&pool, &reduced, keys[i], NULL);
+        owned += before == REMOVED_SERVER;
+        moved += before != after;
+        moved_other += before != after && before != REMOVED_SERVER;
+
+        // 비교: 서버 수로 나눈 나머지로 고르는 단순 해싱 (서버 목록에서 하나를 빼면 인덱스가 당겨짐)
+        int modulo_before = (int)(keys[i] % (uint64_t)pool.server_count);
+        int modulo_after = (int)(keys[i] % (uint64_t)(pool.server_count - 1));
+        if (modulo_after >= REMOVED_SERVER)
+            modulo_after++;
+        modulo_moved += modulo_before != modulo_after;
+    }
+
+    printf("removing server %d from %d (%d keys):\n", REMOVED_SERVER, pool.server_count, NUM_KEYS);
+    printf("  maglev       moved %6.2f%% (its own keys %.2f%%, other servers' keys %.2f%%)\n",
+           moved * 100.0 / NUM_KEYS, owned * 100.0 / NUM_KEYS, moved_other * 100.0 / NUM_KEYS);
+    printf("  modulo       moved %6.2f%%\n", modulo_moved * 100.0 / NUM_KEYS);
+}
+
+// 이전 레이아웃: 서버마다 주소, 카운터, 통계, keep-alive 풀이 한 구조체에 섞여 있던 backend_server
+struct fat_server
+{
+    char *address;
+    int port;
+    atomic_bool is_healthy;
+    atomic_int failed_responses;
+    atomic_int weight;
+    atomic_int current_requests;
+    atomic_int total_requests;
+    atomic_int total_failures;
+    double total_response_time;
+    double avg_response_time;
+    double failure_rate;
+    atomic_ullong latency_ewma_us;
+    atomic_llong latency_stamp_ns;
+    struct upstream_pool idle_connections;
+};
+
+static int fat_least_conn(struct fat_server *servers, int count)
+{
+    int selected = -1;
+    int min_connections = INT_MAX;
+    for (int i = 0; i < count; i++)
+    {
+        int current_requests = atomic_load(&servers[i].current_requests);
+        if (atomic_load(&servers[i].is_healthy) && current_requests < min_connections)
+        {
+            min_connections = current_requests;
+            selected = i;
+        }
+    }
+    return selected;
+}
+
+// 서버 수별 least-connection 선택 비용 (처리 중인 요청 수는 서버마다 임의의 값으로 고정)
+// 기본 경로는 LEAST_CONN_VECTOR_MIN개 이상이고 AVX2를 지원할 때 AVX2, 그 밖에는 반복문
+static void report_scaling(void)
+{
+    static const int sizes[] = {5, 64, 1024, 4096};
+    // 제외 목록에 없는 서버 하나만 넣으면 제외되는 서버 없이 서버마다 확인하는 경로를 탐
+    struct backend_set scalar = {1, {-1}};
+
+    printf("least-conn cost by server count (%zu-byte fat struct vs structure of arrays):\n",
+           sizeof(struct fat_server));
+    printf("  %8s %14s %14s %14s\n", "servers", "fat scalar", "soa scalar", "soa default");
+    for (size_t n = 0; n < sizeof(sizes) / sizeof(sizes[0]); n++)
+    {
+        int count = sizes[n];
+        struct backend_pool large;
+        struct fat_server *fat = calloc(count, sizeof(*fat));
+        if (!fat || init_empty_backend_pool(&large, count) < 0)
+        {
+            free(fat);
+            return;
+        }
+
+        srand(7);
+        for (int i = 0; i < count; i++)
+        {
+            char address[BACKEND_ADDRESS_LEN];
+            snprintf(address, sizeof(address), "10.1.%d.%d", i / 256, i % 256);
+            add_backend_server(&large, address, BASE_PORT, DEFAULT_BACKEND_WEIGHT, 0);
+            int load = 10 + rand() % 1000;
+            atomic_store(&large.current_requests[i], load);
+            atomic_store(&fat[i].current_requests, load);
+            atomic_store(&fat[i].is_healthy, true);
+        }
+
+        volatile int sink = 0;
+        double start = now_ns();
+        for (int i = 0; i < SCALE_SELECTIONS; i++)
+            sink += fat_least_conn(fat, count);
+        double fat_ns = (now_ns() - start) / SCALE_SELECTIONS;
+
+        start = now_ns();
+        for (int i = 0; i < SCALE_SELECTIONS; i++)
+            sink += balancer_select_least_conn(&large, &scalar);
+        double scalar_ns = (now_ns() - start) / SCALE_SELECTIONS;
+
+        start = now_ns();
+        for (int i = 0; i < SCALE_SELECTIONS; i++)
+            sink += balancer_select_least_conn(&large, NULL);
+        double default_ns = (now_ns() - start) / SCALE_SELECTIONS;
+
+        // 세 방식이 같은 서버를 고르는지 확인
+        if (fat_least_conn(fat, count) != balancer_select_least_conn(&large, NULL) ||
+            balancer_select_least_conn(&large, &scalar) != balancer_select_least_conn(&large, NULL))
+            printf("  selection mismatch at %d servers\n", count);
+
+        printf("  %8d %11.1f ns %11.1f ns %11.1f ns\n", count, fat_ns, scalar_ns, default_ns);
+        (void)sink;
+        cleanup_backend_pool(&large);
+        free(fat);
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    int iterations = argc > 1 ? atoi(argv[1]) : 2000000;
+
+    if (init_backend_pool(&pool) < 0)
+        return 1;
+    build_keys();
+
+    // P2C는 응답 시간이 모두 같은 것으로 두고 처리 중인 요청 수로만 비교
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    for (int i = 0; i < pool.server_count; i++)
+    {
+        atomic_store(&pool.servers[i].latency_ewma_us, 1000);
+        atomic_store(&pool.servers[i].latency_stamp_ns, (long long)ts.tv_sec * 1000000000LL + ts.tv_nsec);
+    }
+
+    double start = now_ns();
+    maglev_build(&maglev, &pool, -1);
+    printf("maglev table %d entries built in %.2f ms\n", MAGLEV_TABLE_SIZE, (now_ns() - start) / 1e6);
+
+    printf("%d servers, %d selections, %d requests outstanding:\n", pool.server_count, iterations, OUTSTANDING);
+    report("least-conn", select_least_conn, iterations);
+    report("swrr", select_swrr, iterations);
+    report("p2c", select_p2c, iterations);
+    report("maglev-ip", select_maglev, iterations);
+
+    report_disruption();
+    report_scaling();
+    return 0;
+}
@@ -2,58 +2,225 @@
 #include "../utils/logger.h"
 #include <string.h>
 #include <stdlib.h>
+#include <stdint.h>
+#include <limits.h>
+#include <stdatomic.h>
+#include <time.h>
 
-void init_backend_pool(struct backend_pool *pool)
+static long long monotonic_ns(void)
 {
-    pool->server_count = MAX_BACKENDS;
-    pool->total_requests = 0;
-    pool->total_failures = 0;
-    pool->total_response_time = 0;
-    pool->avg_response_time = 0;
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+// 지난 시간만큼 이전 EWMA 값에 곱하는 가중치
+// exp(-t/tau) 대신 tau/(tau+t)로 근사 (libm 없이 계산, t가 tau일 때 절반)
+static double decay_weight(long long elapsed_ns)
+{
+    const double tau_ns = LATENCY_EWMA_DECAY_MS * 1000000.0;
+    if (elapsed_ns <= 0)
+        return 1.0;
+    return tau_ns / (tau_ns + (double)elapsed_ns);
+}
+
+/**
+ * peak EWMA 갱신
+ * - 이전보다 느린 응답은 바로 반영하고 (peak), 빠른 응답은 시간 가중치에 따라 천천히 따라감
+ * - 여러 reactor 스레드가 동시에 갱신하므로 값은 CAS로 바꿈 (시각은 마지막으로 기록한 스레드 기준)
+ */
+static void record_latency(struct backend_server *server, double latency_ms)
+{
+    long long now = monotonic_ns();
+    long long last = atomic_exchange(&server->latency_stamp_ns, now);
+    double weight = decay_weight(now - last);
+    unsigned long long sample = latency_ms > 0 ? (unsigned long long)(latency_ms * 1000.0) : 0;
+
+    unsigned long long old = atomic_load(&server->latency_ewma_us);
+    unsigned long long next;
+    do
+    {
+        next = sample >= old ? sample : (unsigned long long)(old * weight + sample * (1.0 - weight));
+    } while (!atomic_compare_exchange_weak(&server->latency_ewma_us, &old, next));
+}
+
+double server_recent_latency_ms(struct backend_server *server)
+{
+    // 측정한 적이 없거나 한동안 요청이 없던 서버의 EWMA는 지금 응답 시간을 나타내지 못함
+    // (0을 향해 감쇠한 값을 그대로 쓰면 점수가 0에 가까워 요청이 몰림)
+    long long stamp = atomic_load(&server->latency_stamp_ns);
+    long long elapsed = monotonic_ns() - stamp;
+    if (stamp == 0 || elapsed > LATENCY_EWMA_DECAY_MS * 1000000LL)
+        return -1;
+
+    // 1µs 미만으로 기록된 서버도 처리 중인 요청 수가 점수에 반영되도록 1µs를 최소값으로 씀
+    double latency_ms = atomic_load(&server->latency_ewma_us) * decay_weight(elapsed) / 1000.0;
+    return latency_ms > 0.001 ? latency_ms : 0.001;
+}
+
+// 배열 하나를 캐시 라인 정렬로 할당하고 0으로 채움
+static void *alloc_array(size_t count, size_t size)
+{
+    void *array;
+    if (posix_memalign(&array, 64, count * size) != 0)
+        return NULL;
+    memset(array, 0, count * size);
+    return array;
+}
+
+int init_empty_backend_pool(struct backend_pool *pool, int capacity)
+{
+    // 벡터 연산이 마지막 서버 뒤까지 읽어도 되도록 배열 길이를 BACKEND_POOL_LANES의 배수로 올림
+    // (남는 칸은 비정상으로 두어 선택되지 않음)
+    int lanes = (capacity + BACKEND_POOL_LANES - 1) / BACKEND_POOL_LANES * BACKEND_POOL_LANES;
+    if (lanes == 0)
+        lanes = BACKEND_POOL_LANES;
+
+    pool->server_count = 0;
+    pool->capacity = capacity;
+    pool->current_requests = alloc_array(lanes, sizeof(atomic_int));
+    pool->weight = alloc_array(lanes, sizeof(atomic_int));
+    pool->max_connections = alloc_array(lanes, sizeof(int));
+    pool->healthy = alloc_array((lanes + 63) / 64, sizeof(atomic_ullong));
+    pool->servers = alloc_array(lanes, sizeof(struct backend_server));
+    atomic_init(&pool->total_requests, 0);
+    atomic_init(&pool->total_failures, 0);
+    histogram_init(&pool->latency);
+    atomic_init(&pool->refs, 0);
+    pool->maglev = NULL;
+
+    if (!pool->current_requests || !pool->weight || !pool->max_connections || !pool->healthy || !pool->servers)
+    {
+        cleanup_backend_pool(pool);
+        return -1;
+    }
+    return 0;
+}
+
+int add_backend_server(struct backend_pool *pool, const char *address, int port, int weight, int max_connections)
+{
+    if (pool->server_count >= pool->capacity || strlen(address) >= BACKEND_ADDRESS_LEN ||
+        port <= 0 || port > 65535 || weight < 0 || weight > MAX_BACKEND_WEIGHT || max_connections < 0)
+        return -1;
+
+    int idx = pool->server_count;
+    atomic_init(&pool->current_requests[idx], 0);
+    atomic_init(&pool->weight[idx], weight);
+    pool->max_connections[idx] = max_connections > 0 ? max_connections : INT_MAX;
+    set_server_available(pool, idx, true);
+
+    struct backend_server *server = &pool->servers[idx];
+    strcpy(server->address, address);
+    server->port = port;
+    atomic_init(&server->failed_responses, 0);
+    atomic_init(&server->total_requests, 0);
+    atomic_init(&server->total_failures, 0);
+    histogram_init(&server->latency);
+    atomic_init(&server->latency_ewma_us, 0);
+    atomic_init(&server->latency_stamp_ns, 0);
+    upstream_pool_init(&server->idle_connections);
+    return pool->server_count++;
+}
+
+int init_backend_pool(struct backend_pool *pool)
+{
+    if (init_empty_backend_pool(pool, DEFAULT_BACKENDS) < 0)
+        return -1;
+    for (int i = 0; i < DEFAULT_BACKENDS; i++)
+        add_backend_server(pool, BACKEND_ADDRESS, BASE_PORT + i, DEFAULT_BACKEND_WEIGHT, 0);
+    return 0;
+}
+
+static uint64_t server_key_hash(const struct backend_server *server)
+{
+    uint64_t h = 0xcbf29ce484222325ULL;
+    for (const char *p = server->address; *p; p++)
+        h = (h ^ (unsigned char)*p) * 0x100000001b3ULL;
+    return (h ^ (uint64_t)server->port) * 0x100000001b3ULL;
+}
+
+void inherit_backend_state(struct backend_pool *pool, struct backend_pool *old)
+{
+    // 서버가 수천 개여도 한 번씩만 비교하도록 이전 pool의 서버를 주소:포트 해시로 찾음 (open addressing)
+    size_t slots = 1;
+    while (slots < (size_t)old->server_count * 2)
+        slots <<= 1;
+    int *index = malloc(slots * sizeof(int));
+    if (!index)
+        return;
+    memset(index, -1, slots * sizeof(int));
+    for (int j = 0; j < old->server_count; j++)
+    {
+        size_t slot = server_key_hash(&old->servers[j]) & (slots - 1);
+        while (index[slot] >= 0)
+            slot = (slot + 1) & (slots - 1);
+        index[slot] = j;
+    }
 
     for (int i = 0; i < pool->server_count; i++)
     {
         struct backend_server *server = &pool->servers[i];
-        server->address = BACKEND_ADDRESS;
-        server->port = BASE_PORT + i;
-        server->is_healthy = true;
-        server->failed_responses = 0;
-        server->current_requests = 0;
-        server->total_requests = 0;
-        server->total_failures = 0;
-        server->total_response_time = 0;
-        server->avg_response_time = 0;
-        server->failure_rate = 0;
+        for (size_t slot = server_key_hash(server) & (slots - 1); index[slot] >= 0; slot = (slot + 1) & (slots - 1))
+        {
+            int j = index[slot];
+            struct backend_server *prev = &old->servers[j];
+            if (prev->port != server->port || strcmp(prev->address, server->address) != 0)
+                continue;
+            // 죽은 서버로 다시 요청이 가지 않도록 헬스 상태를, P2C가 처음부터 다시 배우지 않도록 EWMA를 유지
+            set_server_available(pool, i, is_server_available(old, j));
+            atomic_store(&server->failed_responses, atomic_load(&prev->failed_responses));
+            atomic_store(&server->latency_ewma_us, atomic_load(&prev->latency_ewma_us));
+            atomic_store(&server->latency_stamp_ns, atomic_load(&prev->latency_stamp_ns));
+            break;
+        }
     }
+    free(index);
+}
+
+void cleanup_backend_pool(struct backend_pool *pool)
+{
+    for (int i = 0; i < pool->server_count; i++)
+        upstream_pool_destroy(&pool->servers[i].idle_connections);
+    free(pool->current_requests);
+    free(pool->weight);
+    free(pool->max_connections);
+    free(pool->healthy);
+    free(pool->servers);
+    free(pool->maglev);
+    pool->current_requests = NULL;
+    pool->weight = NULL;
+    pool->max_connections = NULL;
+    pool->healthy = NULL;
+    pool->servers = NULL;
+    pool->maglev = NULL;
+    pool->server_count = 0;
+    pool->capacity = 0;
 }
 
 void track_request_start(struct backend_pool *pool, int server_idx)
 {
     struct backend_server *server = &pool->servers[server_idx];
-    server->current_requests++;
-    server->total_requests++;
-    pool->total_requests++;
+    atomic_fetch_add(&pool->current_requests[server_idx], 1);
+    atomic_fetch_add(&server->total_requests, 1);
+    atomic_fetch_add(&pool->total_requests, 1);
 }
 
 void track_request_end(struct backend_pool *pool, int server_idx, bool success, double response_time)
 {
     struct backend_server *server = &pool->servers[server_idx];
 
-    server->current_requests--;
+    atomic_fetch_sub(&pool->current_requests[server_idx], 1);
     if (!success)
     {
-        server->total_failures++;
+        atomic_fetch_add(&server->total_failures, 1);
+        atomic_fetch_add(&pool->total_failures, 1);
     }
-    server->total_response_time += response_time;
-    server->avg_response_time = server->total_response_time / server->total_requests;
-    server->failure_rate = ((double)server->total_failures / server->total_requests) * 100;
+    unsigned long long response_time_us = response_time > 0 ? (unsigned long long)(response_time * 1000) : 0;
+    histogram_record(&server->latency, response_time_us);
+    histogram_record(&pool->latency, response_time_us);
 
-    if (!success)
-    {
-        pool->total_failures++;
-    }
-    pool->total_response_time += response_time;
-    pool->avg_response_time = pool->total_response_time / pool->total_requests;
+    record_latency(server, success || response_time > LATENCY_FAILURE_PENALTY_MS ? response_time
+                                                                              : LATENCY_FAILURE_PENALTY_MS);
 
     update_server_status(pool, server_idx, success);
 }
@@ -64,20 +231,51 @@ void update_server_status(struct backend_pool *pool, int server_idx, bool reques
 
     if (!request_success)
     {
-        server->failed_responses++;
-        if (server->failed_responses >= MAX_FAILURES)
+        int failed = atomic_fetch_add(&server->failed_responses, 1) + 1;
+        if (failed >= MAX_FAILURES)
         {
-            server->is_healthy = false;
+            set_server_available(pool, server_idx, false);
         }
     }
     else
     {
-        server->failed_responses = 0;
-        server->is_healthy = true;
+        atomic_store(&server->failed_responses, 0);
+        set_server_available(pool, server_idx, true);
     }
 }
 
+int set_server_weight(struct backend_pool *pool, int server_idx, int weight)
+{
+    if (server_idx < 0 || server_idx >= pool->server_count || weight < 0 || weight > MAX_BACKEND_WEIGHT)
+        return -1;
+    // 선택하는 쪽은 매번 가중치를 새로 읽으므로 다음 선택부터 반영됨
+    atomic_store(&pool->weight[server_idx], weight);
+    return 0;
+}
+
 bool is_server_available(struct backend_pool *pool, int server_idx)
 {
-    return pool->servers[server_idx].is_healthy;
-}
\ No newline at end of file
+    return (atomic_load(&pool->healthy[server_idx / 64]) >> (server_idx % 64)) & 1;
+}
+
+void set_server_available(struct backend_pool *pool, int server_idx, bool healthy)
+{
+    // 한 워드를 서버 64개가 함께 쓰므로 상태가 바뀔 때만 쓰기 (성공한 요청마다 캐시 라인을 뺏지 않도록)
+    if (is_server_available(pool, server_idx) == healthy)
+        return;
+    unsigned long long bit = 1ULL << (server_idx % 64);
+    if (healthy)
+        atomic_fetch_or(&pool->healthy[server_idx / 64], bit);
+    else
+        atomic_fetch_and(&pool->healthy[server_idx / 64], ~bit);
+}
+
+void read_server_latency(struct backend_pool *pool, int server_idx, struct histogram_snapshot *snapshot)
+{
+    histogram_snapshot_add(snapshot, &pool->servers[server_idx].latency);
+}
+
+void read_pool_latency(struct backend_pool *pool, struct histogram_snapshot *snapshot)
+{
+    histogram_snapshot_add(snapshot, &pool->latency);
+}
@@ -0,0 +1,254 @@
+#include "metrics.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+
+#define METRICS_OUTPUT_INITIAL 16384
+
+// Prometheus 히스토그램의 le 경계 (us)
+// HDR 칸 경계와 맞지 않는 경계는 그 경계에 걸친 칸을 다음 경계로 넘기므로 칸 폭(3%) 이내로 적게 셈
+static const unsigned long long latency_bounds_us[] = {
+    500, 1000, 2500, 5000, 10000, 25000, 50000, 100000, 250000, 500000, 1000000, 2500000, 5000000, 10000000};
+
+void init_server_metrics(struct server_metrics *metrics)
+{
+    memset(metrics, 0, sizeof(*metrics));
+}
+
+void init_system_metrics(struct system_metrics *metrics)
+{
+    memset(metrics, 0, sizeof(*metrics));
+    metrics->load_balance_score = 1.0;
+}
+
+void collect_server_metrics(struct backend_pool *pool, int server_idx, struct server_metrics *metrics)
+{
+    struct backend_server *server = &pool->servers[server_idx];
+
+    metrics->current_requests = atomic_load_explicit(&pool->current_requests[server_idx], memory_order_relaxed);
+    metrics->total_requests = atomic_load_explicit(&server->total_requests, memory_order_relaxed);
+    metrics->failed_requests = atomic_load_explicit(&server->total_failures, memory_order_relaxed);
+    metrics->weight = atomic_load_explicit(&pool->weight[server_idx], memory_order_relaxed);
+    metrics->healthy = is_server_available(pool, server_idx);
+
+    // 평균은 칸을 모두 읽지 않고 히스토그램의 합계와 개수로 계산
+    unsigned long long count = atomic_load_explicit(&server->latency.total_count, memory_order_relaxed);
+    unsigned long long sum_us = atomic_load_explicit(&server->latency.sum_us, memory_order_relaxed);
+    metrics->avg_response_time = count > 0 ? (double)sum_us / count / 1000.0 : 0;
+    calculate_server_metrics(metrics);
+}
+
+void calculate_server_metrics(struct server_metrics *metrics)
+{
+    metrics->failure_rate = metrics->total_requests > 0
+                                ? (double)metrics->failed_requests / metrics->total_requests * 100
+                                : 0;
+}
+
+void calculate_system_metrics(struct system_metrics *metrics)
+{
+    metrics->error_rate = metrics->total_throughput > 0
+                              ? (double)metrics->total_errors / metrics->total_throughput * 100
+                              : 0;
+}
+
+double load_balance_score(const struct server_metrics *server_metrics, int server_count)
+{
+    double sum = 0, sum_squares = 0;
+    int n = 0;
+
+    for (int i = 0; i < server_count; i++)
+    {
+        const struct server_metrics *metrics = &server_metrics[i];
+        if (!metrics->healthy || metrics->weight <= 0)
+            continue;
+        double share = (double)metrics->total_requests / metrics->weight;
+        sum += share;
+        sum_squares += share * share;
+        n++;
+    }
+
+    if (n == 0 || sum_squares == 0)
+        return 1.0;
+    return sum * sum / (n * sum_squares);
+}
+
+void update_system_metrics(struct system_metrics *metrics, struct server_metrics *server_metrics, int server_count)
+{
+    init_system_metrics(metrics);
+    for (int i = 0; i < server_count; i++)
+    {
+        metrics->total_throughput += server_metrics[i].total_requests;
+        metrics->total_errors += server_metrics[i].failed_requests;
+        metrics->healthy_servers += server_metrics[i].healthy;
+    }
+    calculate_system_metrics(metrics);
+    metrics->load_balance_score = load_balance_score(server_metrics, server_count);
+}
+
+void metrics_output_init(struct metrics_output *out)
+{
+    memset(out, 0, sizeof(*out));
+}
+
+void metrics_output_reset(struct metrics_output *out)
+{
+    out->len = 0;
+    out->failed = 0;
+}
+
+void metrics_output_free(struct metrics_output *out)
+{
+    free(out->data);
+    metrics_output_init(out);
+}
+
+void metrics_printf(struct metrics_output *out, const char *format, ...)
+{
+    if (out->failed)
+        return;
+
+    for (;;)
+    {
+        size_t room = out->capacity - out->len;
+        va_list args;
+        va_start(args, format);
+        int written = vsnprintf(out->data ? out->data + out->len : NULL, room, format, args);
+        va_end(args);
+        if (written < 0)
+        {
+            out->failed = 1;
+            return;
+        }
+        if ((size_t)written < room)
+        {
+            out->len += written;
+            return;
+        }
+
+        // 모자라면 두 배로 늘려서 다시 씀
+        size_t capacity = out->capacity ? out->capacity : METRICS_OUTPUT_INITIAL;
+        while (capacity - out->len <= (size_t)written)
+            capacity *= 2;
+        char *data = realloc(out->data, capacity);
+        if (!data)
+        {
+            out->failed = 1;
+            return;
+        }
+        out->data = data;
+        out->capacity = capacity;
+    }
+}
+
+// labels: 앞에 붙일 레이블 ("backend=\"주소:포트\"," 형식, 없으면 "")
+static void render_histogram(struct metrics_output *out, const char *name, const char *labels,
+                             const struct histogram_snapshot *snapshot)
+{
+    unsigned long long cumulative = 0;
+    int bucket = 0;
+
+    for (size_t i = 0; i < sizeof(latency_bounds_us) / sizeof(latency_bounds_us[0]); i++)
+    {
+        while (bucket < HISTOGRAM_BUCKETS && histogram_bucket_upper(bucket) <= latency_bounds_us[i])
+            cumulative += snapshot->counts[bucket++];
+        metrics_printf(out, "%s_bucket{%sle=\"%g\"} %llu\n", name, labels, latency_bounds_us[i] / 1e6, cumulative);
+    }
+    metrics_printf(out, "%s_bucket{%sle=\"+Inf\"} %llu\n", name, labels, snapshot->total_count);
+
+    // _sum/_count에는 레이블 끝의 쉼표를 빼고 씀
+    int labels_len = (int)strlen(labels);
+    if (labels_len == 0)
+    {
+        metrics_printf(out, "%s_sum %.6f\n", name, snapshot->sum_us / 1e6);
+        metrics_printf(out, "%s_count %llu\n", name, snapshot->total_count);
+        return;
+    }
+    metrics_printf(out, "%s_sum{%.*s} %.6f\n", name, labels_len - 1, labels, snapshot->sum_us / 1e6);
+    metrics_printf(out, "%s_count{%.*s} %llu\n", name, labels_len - 1, labels, snapshot->total_count);
+}
+
+static void render_family(struct metrics_output *out, const char *name, const char *type, const char *help)
+{
+    metrics_printf(out, "# HELP %s %s\n# TYPE %s %s\n", name, help, name, type);
+}
+
+void metrics_render_backends(struct metrics_output *out, struct backend_pool *pool)
+{
+    int count = pool->server_count;
+    struct server_metrics *servers = malloc((count > 0 ? count : 1) * sizeof(*servers));
+    struct histogram_snapshot *snapshot = malloc(sizeof(*snapshot));
+    if (!servers || !snapshot)
+    {
+        free(servers);
+        free(snapshot);
+        out->failed = 1;
+        return;
+    }
+
+    for (int i = 0; i < count; i++)
+        collect_server_metrics(pool, i, &servers[i]);
+    struct system_metrics system;
+    update_system_metrics(&system, servers, count);
+
+    // Prometheus text format은 이름마다 샘플을 모아서 써야 하므로 항목마다 서버를 한 번씩 훑음
+    render_family(out, "nginxx_backend_in_flight_requests", "gauge", "Requests currently being served by the backend.");
+    for (int i = 0; i < count; i++)
+        metrics_printf(out, "nginxx_backend_in_flight_requests{backend=\"%s:%d\"} %d\n",
+                       pool->servers[i].address, pool->servers[i].port, servers[i].current_requests);
+
+    render_family(out, "nginxx_backend_requests_total", "counter", "Requests sent to the backend.");
+    for (int i = 0; i < count; i++)
+        metrics_printf(out, "nginxx_backend_requests_total{backend=\"%s:%d\"} %d\n",
+                       pool->servers[i].address, pool->servers[i].port, servers[i].total_requests);
+
+    render_family(out, "nginxx_backend_failures_total", "counter", "Requests to the backend that failed.");
+    for (int i = 0; i < count; i++)
+        metrics_printf(out, "nginxx_backend_failures_total{backend=\"%s:%d\"} %d\n",
+                       pool->servers[i].address, pool->servers[i].port, servers[i].failed_requests);
+
+    render_family(out, "nginxx_backend_healthy", "gauge", "Whether the backend is selectable (1) or marked down (0).");
+    for (int i = 0; i < count; i++)
+        metrics_printf(out, "nginxx_backend_healthy{backend=\"%s:%d\"} %d\n",
+                       pool->servers[i].address, pool->servers[i].port, servers[i].healthy);
+
+    render_family(out, "nginxx_backend_weight", "gauge", "Weight of the backend (0 drains it).");
+    for (int i = 0; i < count; i++)
+        metrics_printf(out, "nginxx_backend_weight{backend=\"%s:%d\"} %d\n",
+                       pool->servers[i].address, pool->servers[i].port, servers[i].weight);
+
+    // 서버가 수천 개일 수 있으므로 요청을 받은 적 없는 서버의 히스토그램은 생략
+    render_family(out, "nginxx_backend_response_seconds", "histogram",
+                  "Time from backend selection to the last byte of the response.");
+    for (int i = 0; i < count; i++)
+    {
+        if (servers[i].total_requests == 0)
+            continue;
+        char labels[BACKEND_ADDRESS_LEN + 32];
+        snprintf(labels, sizeof(labels), "backend=\"%s:%d\",", pool->servers[i].address, pool->servers[i].port);
+        histogram_snapshot_init(snapshot);
+        read_server_latency(pool, i, snapshot);
+        render_histogram(out, "nginxx_backend_response_seconds", labels, snapshot);
+    }
+
+    render_family(out, "nginxx_requests_total", "counter", "Requests sent to any backend.");
+    metrics_printf(out, "nginxx_requests_total %d\n", atomic_load_explicit(&pool->total_requests, memory_order_relaxed));
+    render_family(out, "nginxx_failures_total", "counter", "Requests to any backend that failed.");
+    metrics_printf(out, "nginxx_failures_total %d\n", atomic_load_explicit(&pool->total_failures, memory_order_relaxed));
+    render_family(out, "nginxx_backends", "gauge", "Configured backends.");
+    metrics_printf(out, "nginxx_backends %d\n", count);
+    render_family(out, "nginxx_healthy_backends", "gauge", "Backends currently marked healthy.");
+    metrics_printf(out, "nginxx_healthy_backends %d\n", system.healthy_servers);
+    render_family(out, "nginxx_load_balance_score", "gauge",
+                  "Jain's fairness index of requests per unit weight over healthy backends (1 is perfectly even).");
+    metrics_printf(out, "nginxx_load_balance_score %.6f\n", system.load_balance_score);
+
+    render_family(out, "nginxx_response_seconds", "histogram", "Response time over all backends.");
+    histogram_snapshot_init(snapshot);
+    read_pool_latency(pool, snapshot);
+    render_histogram(out, "nginxx_response_seconds", "", snapshot);
+
+    free(snapshot);
+    free(servers);
+}
@@ -0,0 +1,325 @@
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <stdint.h>
+#include <sys/socket.h>
+#include <sys/epoll.h>
+#include <sys/uio.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include "admin.h"
+#include "metrics.h"
+#include "../utils/logger.h"
+
+#define ADMIN_EVENT_LISTEN UINT64_MAX // 관리 epoll의 리스닝 소켓 (그 외에는 클라이언트 슬롯 번호)
+#define ADMIN_MAX_EVENTS 16
+
+struct admin_client
+{
+    int fd; // 비어 있는 슬롯이면 -1
+    unsigned long accepted; // 몇 번째로 받은 연결인지 (슬롯이 모자랄 때 가장 오래된 연결을 고름)
+    size_t request_len;
+    char request[ADMIN_REQUEST_MAX];
+
+    // 응답 (헤더 + 본문), 다 보내지 못하면 EPOLLOUT을 기다렸다가 이어서 보냄
+    char header[256];
+    size_t header_len;
+    struct metrics_output body;
+    size_t sent;
+};
+
+struct admin_server
+{
+    int listen_fd;
+    int epoll_fd;
+    admin_render_fn render;
+    unsigned long accepted;
+    struct admin_client clients[ADMIN_MAX_CLIENTS];
+};
+
+static void admin_close_client(struct admin_client *client)
+{
+    // close()된 fd는 커널이 epoll 관심 목록에서 제거
+    close(client->fd);
+    client->fd = -1;
+    metrics_output_reset(&client->body);
+}
+
+// 요청 줄을 보고 응답을 만듦 (GET /metrics 외에는 404)
+static void admin_prepare_response(struct admin_server *admin, struct admin_client *client)
+{
+    const char *status = "200 OK";
+    const char *path = "/metrics";
+    size_t path_len = strlen(path);
+
+    int is_metrics = client->request_len > 4 + path_len && memcmp(client->request, "GET ", 4) == 0 &&
+                     memcmp(client->request + 4, path, path_len) == 0 &&
+                     (client->request[4 + path_len] == ' ' || client->request[4 + path_len] == '?');
+    if (is_metrics)
+    {
+        admin->render(&client->body);
+        if (client->body.failed)
+        {
+            status = "500 Internal Server Error";
+            metrics_output_reset(&client->body);
+            metrics_printf(&client->body, "out of memory\n");
+        }
+    }
+    else
+    {
+        status = "404 Not Found";
+        metrics_printf(&client->body, "not found\n");
+    }
+
+    int len = snprintf(client->header, sizeof(client->header),
+                       "HTTP/1.1 %s\r\n"
+                       "Content-Type: text/plain; version=0.0.4; charset=utf-8\r\n"
+                       "Content-Length: %zu\r\n"
+                       "Connection: close\r\n\r\n",
+                       status, client->body.failed ? 0 : client->body.len);
+    client->header_len = (size_t)len;
+    client->sent = 0;
+}
+
+// 남은 응답을 보냄, 다 보냈거나 오류면 연결을 닫음
+static void admin_send_response(struct admin_server *admin, struct admin_client *client)
+{
+    size_t total = client->header_len + client->body.len;
+    while (client->sent < total)
+    {
+        struct iovec iov[2];
+        int count = 0;
+        if (client->sent < client->header_len)
+        {
+            iov[count].iov_base = client->header + client->sent;
+            iov[count++].iov_len = client->header_len - client->sent;
+            iov[count].iov_base = client->body.data;
+            iov[count++].iov_len = client->body.len;
+        }
+        else
+        {
+            iov[count].iov_base = client->body.data + (client->sent - client->header_len);
+            iov[count++].iov_len = total - client->sent;
+        }
+
+        ssize_t n = writev(client->fd, iov, count);
+        if (n < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            if (errno == EAGAIN || errno == EWOULDBLOCK)
+            {
+                struct epoll_event ev;
+                ev.events = EPOLLOUT;
+                ev.data.u64 = (uint64_t)(client - admin->clients);
+                if (epoll_ctl(admin->epoll_fd, EPOLL_CTL_MOD, client->fd, &ev) == 0)
+                    return;
+            }
+            break;
+        }
+        client->sent += (size_t)n;
+    }
+    admin_close_client(client);
+}
+
+static void admin_handle_read(struct admin_server *admin, struct admin_client *client)
+{
+    for (;;)
+    {
+        size_t room = sizeof(client->request) - 1 - client->request_len;
+        if (room == 0)
+        {
+            admin_close_client(client); // 헤더가 너무 김
+            return;
+        }
+
+        ssize_t n = recv(client->fd, client->request + client->request_len, room, 0);
+        if (n == 0 || (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR))
+        {
+            admin_close_client(client);
+            return;
+        }
+        if (n < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            return; // 헤더의 나머지를 기다림
+        }
+
+        client->request_len += (size_t)n;
+        client->request[client->request_len] = '\0';
+        if (strstr(client->request, "\r\n\r\n"))
+        {
+            admin_prepare_response(admin, client);
+            admin_send_response(admin, client);
+            return;
+        }
+    }
+}
+
+static struct admin_client *admin_free_slot(struct admin_server *admin)
+{
+    struct admin_client *oldest = &admin->clients[0];
+    for (int i = 0; i < ADMIN_MAX_CLIENTS; i++)
+    {
+        struct admin_client *client = &admin->clients[i];
+        if (client->fd < 0)
+            return client;
+        if (client->accepted < oldest->accepted)
+            oldest = client;
+    }
+
+    // 요청을 보내지 않고 버티는 연결이 관리 포트를 막지 않도록 가장 오래된 연결을 닫고 자리를 씀
+    admin_close_client(oldest);
+    return oldest;
+}
+
+static void admin_handle_accept(struct admin_server *admin)
+{
+    for (;;)
+    {
+        int fd = accept4(admin->listen_fd, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            return;
+        }
+
+        struct admin_client *client = admin_free_slot(admin);
+        client->fd = fd;
+        client->accepted = ++admin->accepted;
+        client->request_len = 0;
+
+        struct epoll_event ev;
+        ev.events = EPOLLIN;
+        ev.data.u64 = (uint64_t)(client - admin->clients);
+        if (epoll_ctl(admin->epoll_fd, EPOLL_CTL_ADD, fd, &ev) < 0)
+            admin_close_client(client);
+    }
+}
+
+void admin_server_poll(struct admin_server *admin)
+{
+    struct epoll_event events[ADMIN_MAX_EVENTS];
+    int nfds = epoll_wait(admin->epoll_fd, events, ADMIN_MAX_EVENTS, 0);
+
+    for (int n = 0; n < nfds; n++)
+    {
+        if (events[n].data.u64 == ADMIN_EVENT_LISTEN)
+        {
+            admin_handle_accept(admin);
+            continue;
+        }
+
+        // 같은 배치에서 이미 닫힌 슬롯의 이벤트는 무시
+        struct admin_client *client = &admin->clients[events[n].data.u64];
+        if (client->fd < 0)
+            continue;
+        if (events[n].events & (EPOLLERR | EPOLLHUP))
+            admin_close_client(client);
+        else if (events[n].events & EPOLLOUT)
+            admin_send_response(admin, client);
+        else
+            admin_handle_read(admin, client);
+    }
+}
+
+int admin_server_fd(const struct admin_server *admin)
+{
+    return admin->epoll_fd;
+}
+
+int admin_parse_listen(const char *spec, char *address, int *port)
+{
+    const char *colon = strrchr(spec, ':');
+    const char *port_text = colon ? colon + 1 : spec;
+    size_t address_len = colon ? (size_t)(colon - spec) : strlen(ADMIN_DEFAULT_ADDRESS);
+    if (address_len >= ADMIN_ADDRESS_LEN)
+        return -1;
+
+    char *end;
+    long value = strtol(port_text, &end, 10);
+    if (end == port_text || *end != '\0' || value < 0 || value > 65535)
+        return -1;
+
+    char parsed[ADMIN_ADDRESS_LEN];
+    memcpy(parsed, colon ? spec : ADMIN_DEFAULT_ADDRESS, address_len);
+    parsed[address_len] = '\0';
+    struct in_addr addr;
+    if (inet_pton(AF_INET, parsed, &addr) != 1)
+        return -1;
+
+    memcpy(address, parsed, address_len + 1);
+    *port = (int)value;
+    return 0;
+}
+
+struct admin_server *admin_server_create(const char *address, int port, admin_render_fn render)
+{
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    if (inet_pton(AF_INET, address, &addr.sin_addr) != 1)
+    {
+        log_message(LOG_ERROR, "Invalid admin address %s", address);
+        return NULL;
+    }
+
+    struct admin_server *admin = calloc(1, sizeof(struct admin_server));
+    if (!admin)
+        return NULL;
+    admin->render = render;
+    admin->epoll_fd = -1;
+    for (int i = 0; i < ADMIN_MAX_CLIENTS; i++)
+    {
+        admin->clients[i].fd = -1;
+        metrics_output_init(&admin->clients[i].body);
+    }
+
+    admin->listen_fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (admin->listen_fd < 0)
+    {
+        free(admin);
+        return NULL;
+    }
+
+    int reuse = 1;
+    setsockopt(admin->listen_fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
+    struct epoll_event ev;
+    ev.events = EPOLLIN;
+    ev.data.u64 = ADMIN_EVENT_LISTEN;
+    if (bind(admin->listen_fd, (struct sockaddr *)&addr, sizeof(addr)) < 0 ||
+        listen(admin->listen_fd, ADMIN_MAX_CLIENTS) < 0 ||
+        (admin->epoll_fd = epoll_create1(EPOLL_CLOEXEC)) < 0 ||
+        epoll_ctl(admin->epoll_fd, EPOLL_CTL_ADD, admin->listen_fd, &ev) < 0)
+    {
+        log_message(LOG_ERROR, "Failed to open admin port %s:%d: %s", address, port, strerror(errno));
+        admin_server_destroy(admin);
+        return NULL;
+    }
+
+    log_message(LOG_INFO, "Admin port %s:%d serving /metrics", address, port);
+    return admin;
+}
+
+void admin_server_destroy(struct admin_server *admin)
+{
+    if (!admin)
+        return;
+    for (int i = 0; i < ADMIN_MAX_CLIENTS; i++)
+    {
+        if (admin->clients[i].fd >= 0)
+            close(admin->clients[i].fd);
+        metrics_output_free(&admin->clients[i].body);
+    }
+    if (admin->epoll_fd >= 0)
+        close(admin->epoll_fd);
+    close(admin->listen_fd);
+    free(admin);
+}
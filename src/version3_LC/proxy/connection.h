@@ -0,0 +1,159 @@
+#ifndef CONNECTION_H
+#define CONNECTION_H
+
+// 프록시 내부 전용 헤더
+// epoll/io_uring 이벤트 루프가 함께 사용하는 reactor, connection 정의와 공통 처리 함수
+
+#include <stddef.h>
+#include <stdint.h>
+#include <pthread.h>
+#include <time.h>
+#include <stdatomic.h>
+#include <netinet/in.h>
+#include "ring_buffer.h"
+#include "timer_wheel.h"
+#include "http.h"
+#include "proxy.h"
+#include "balancer.h"
+
+#define CHUNK_SIZE (1024 * 1024)
+#define REQUEST_RING_SIZE CHUNK_SIZE  // 요청 헤더 최대 크기이자 백엔드로 보내지 못한 요청 본문의 상한
+#define RESPONSE_RING_SIZE CHUNK_SIZE // 클라이언트로 보내지 못한 응답의 상한
+#define REQUEST_RING_INITIAL 4096     // 대부분의 요청 헤더가 들어가는 크기에서 시작
+#define RESPONSE_RING_INITIAL 65536
+#define BUFFER_POOL_STATS_INTERVAL 1000 // 완료된 요청 수 기준 버퍼 풀 통계 로그 주기
+#define PIPE_POOL_SIZE 64 // reactor마다 재사용을 위해 보관하는 splice 파이프 수
+
+struct uring;
+struct admin_server;
+
+// 코어마다 하나씩 실행되는 이벤트 루프
+// 리스닝 소켓과 epoll 인스턴스(또는 io_uring), 그리고 그 위에 등록된 connection들은 reactor 전용
+struct reactor
+{
+    int id;
+    int listen_port;
+    int listen_fd;
+    int epoll_fd;
+    int edge_triggered; // EPOLLET 모드 여부
+    int io_backend;     // IO_BACKEND_EPOLL / IO_BACKEND_URING
+    struct uring *uring; // io_uring 백엔드 사용 시 링 상태, epoll 사용 시 NULL
+    int splice_relay;    // 응답 헤더 이후 본문을 splice()로 중계할지 여부
+    int max_retries;     // 백엔드 연결 실패 시 요청당 재시도 횟수
+    pthread_t thread;
+
+    // 비어 있는 splice 파이프 풀 (connection마다 pipe2/close를 반복하지 않도록)
+    int pipe_pool[PIPE_POOL_SIZE][2];
+    int pipe_pool_count;
+
+    // epoll_ctl 호출 수 통계 (요청당 호출 수 확인용)
+    unsigned long epoll_ctl_calls;
+    unsigned long completed_requests;
+
+    // connection 링 버퍼가 사용하는 버퍼 풀 (reactor 스레드 전용)
+    struct buffer_pool buffer_pool;
+
+    // 정리된 connection 목록, 같은 epoll_wait 배치가 끝난 뒤 client_fd를 닫아서 슬롯을 돌려줌
+    struct connection *closed_connections;
+
+    // connection별 timeout (connect, 요청 헤더, keep-alive idle, 응답 첫 바이트)
+    struct timer_wheel timers;
+    int timeout_ms[PROXY_TIMEOUT_KINDS];
+    unsigned long timeouts_expired[PROXY_TIMEOUT_KINDS]; // 종류별 만료 횟수
+
+    // /metrics가 다른 스레드에서 읽는 gauge (이 reactor만 갱신)
+    atomic_long open_connections;      // 열려 있는 클라이언트 연결 수
+    atomic_size_t uring_buffer_bytes;  // io_uring provided buffer 메모리
+    struct admin_server *admin;        // 관리 포트를 처리하는 reactor이면 설정, 그 외에는 NULL
+};
+
+// 클라이언트와 HTTP 서버 간의 연결 상태를 추적하기 위한 구조체
+// 각 연결마다 하나의 인스턴스 사용 (epoll 경로는 client_fd로 인덱싱되는 connection 테이블의 슬롯)
+// 이벤트마다 접근하는 필드를 첫 캐시 라인 하나에, 링 버퍼를 그 다음 라인부터, 드물게 쓰는 필드를 마지막에 배치
+// (배치는 아래 _Static_assert로 확인)
+struct connection
+{
+    // hot: 이벤트 처리마다 접근 (64바이트 안에 들어가도록 상태 플래그는 1바이트)
+    int client_fd;
+    int backend_fd;
+    uint32_t generation;          // 슬롯을 재사용할 때마다 증가, epoll_event.data에 함께 기록해서 오래된 이벤트 구분
+    uint32_t backend_generation;  // 요청마다 backend_fd가 바뀔 때 증가, 이전 백엔드 소켓의 이벤트 구분
+    uint32_t client_events;       // LT 모드에서 현재 등록된 client_fd 이벤트
+    uint32_t backend_events;      // LT 모드에서 현재 등록된 backend_fd 이벤트
+    int server_idx;
+    unsigned int epoll_ctl_calls; // 이 요청을 처리하는 동안 호출한 epoll_ctl 수
+    long long request_length;     // 요청 헤더 + 본문 길이, 알 수 없으면 -1
+    unsigned long long request_forwarded; // 백엔드로 보낸 요청 바이트 수
+    uint8_t is_backend_connected;
+    uint8_t already_cleaned;
+    uint8_t client_read_paused;   // request 링이 가득 차면(백엔드가 받지 못하면) 클라이언트 읽기를 멈춤
+    uint8_t backend_reused;       // keep-alive 풀에서 꺼낸 백엔드 연결
+    uint8_t request_keep_alive;   // 클라이언트가 응답 후에도 연결 유지를 원함
+    uint8_t splice_active;        // 응답 헤더 이후 본문을 splice()로 중계 중
+    uint8_t request_held;         // 재시도에 대비해 보낸 요청을 응답의 첫 바이트까지 request 링에 남겨 둠
+    uint8_t response_started;     // 현재 백엔드에서 응답을 한 바이트라도 받음
+    uint8_t backend_eof;
+    uint8_t response_timed_out;   // 응답 첫 바이트 timeout이 지남 (정리할 때 서버 실패로 기록)
+    uint8_t client_eof;           // 클라이언트가 보내기를 끝냄 (half-close), 받아 둔 요청의 응답을 보낸 뒤 닫음
+
+    // 클라이언트 → 백엔드 (헤더 수신 중에는 요청 헤더가 처음부터 연속으로 들어 있음)
+    // 두 링 모두 데이터가 있는 동안에만 reactor의 버퍼 풀에서 버퍼를 빌려 씀
+    struct ring_buffer request __attribute__((aligned(64)));
+    // 백엔드 → 클라이언트, 가득 차면 클라이언트가 비울 때까지 백엔드 읽기를 멈춤
+    struct ring_buffer response;
+
+    // 요청 헤더 해석 상태 (recv마다 이어서 해석, 헤더는 request 링 안의 오프셋으로 기록)
+    struct http_request request_state;
+    // 응답의 끝(Content-Length)과 keep-alive 여부 판단
+    struct http_response response_state;
+
+    // cold: 연결 생성/정리 때나 가끔 접근
+    struct sockaddr_in client_addr;
+    int pipe_fds[2];
+    size_t pipe_bytes;              // 파이프에 들어 있고 아직 클라이언트로 보내지 못한 바이트 수 (splice 중계에서만 사용)
+    struct connection *next_closed; // reactor의 정리 대기 목록
+    struct timer timer;             // reactor 타이머 휠에 등록된 현재 timeout
+    int timeout_kind;               // 등록된 timeout 종류 (enum proxy_timeout), 없으면 -1
+    struct timespec request_started; // 백엔드를 선택한 시각
+    double response_time_ms;         // 응답의 마지막 바이트를 받기까지 걸린 시간, 아직이면 -1
+    struct backend_set tried_servers; // 이 요청을 보내 본 서버
+    int retries;                     // 이 요청을 다른 서버로 다시 보낸 횟수
+    uint64_t balance_key;            // Maglev 정책에서 서버를 정하는 키 해시 (재시도에도 같은 키 사용)
+    struct backend_pool *pool;       // 현재 요청이 참조하는 backend_pool (server_idx는 이 pool의 인덱스)
+} __attribute__((aligned(64)));
+
+_Static_assert(offsetof(struct connection, backend_eof) < 64, "hot connection fields must fit in the first cache line");
+_Static_assert(offsetof(struct connection, request) == 64, "rings must start on the second cache line");
+_Static_assert(sizeof(struct connection) % 64 == 0, "connection table slots must not share cache lines");
+
+
+// connection 공통 처리 (proxy.c)
+int connection_init(struct connection *conn, struct buffer_pool *pool, int client_fd, struct sockaddr_in client_addr);
+void connection_release(struct connection *conn);
+void connection_trim_buffers(struct connection *conn);
+int connection_reserve(struct connection *conn, size_t len);
+int connection_request_ready(struct connection *conn);
+int connection_open_backend(const struct reactor *reactor, struct connection *conn, struct sockaddr_in *backend_addr);
+int connection_backend_failed(const struct reactor *reactor, struct connection *conn);
+int connection_retry_backend(struct connection *conn, struct sockaddr_in *backend_addr);
+const char *connection_request_unsent(const struct connection *conn, size_t *len);
+int connection_backend_reusable(const struct connection *conn);
+void connection_checkin_backend(struct connection *conn);
+void connection_response_done(struct connection *conn);
+int connection_keep_alive(const struct connection *conn);
+int connection_finish_request(struct connection *conn);
+void connection_set_timeout(struct reactor *reactor, struct connection *conn, int kind);
+void connection_clear_timeout(struct reactor *reactor, struct connection *conn);
+void connection_request_data(struct reactor *reactor, struct connection *conn);
+void connection_request_sent(struct reactor *reactor, struct connection *conn);
+void connection_response_data(struct reactor *reactor, struct connection *conn);
+struct connection *connection_pop_timed_out(struct reactor *reactor, int *kind);
+int connection_timeout_wait_ms(const struct reactor *reactor);
+void set_socket_buffer_size(int fd);
+void log_upstream_pool_stats(void);
+
+// io_uring 백엔드 (uring.c)
+int uring_reactor_init(struct reactor *reactor);
+void uring_reactor_run(struct reactor *reactor);
+
+#endif
@@ -0,0 +1,33 @@
+#ifndef HTTP_SCAN_H
+#define HTTP_SCAN_H
+
+#include <stddef.h>
+
+/**
+ * HTTP 헤더 줄 검사 커널
+ * - 한 번 훑으면서 줄 끝('\n'), 첫 ':' 위치, 헤더에 올 수 없는 제어 문자를 함께 찾음
+ * - x86-64에서는 AVX2(32바이트) / SSE2(16바이트) 단위로 비교, 그 외에는 바이트 단위
+ * - 사용할 구현은 프로그램 시작 시 CPU 기능을 확인해서 선택 (runtime dispatch)
+ */
+struct http_scan
+{
+    size_t colon; // 첫 ':'의 위치, 없으면 HTTP_SCAN_NONE
+    int invalid;  // 허용되지 않는 제어 문자가 있음 (HTAB, CR 제외한 0x00-0x1f, 0x7f)
+};
+
+#define HTTP_SCAN_NONE ((size_t)-1)
+
+/**
+ * data[0..len) 에서 첫 '\n'을 찾음
+ * - 반환값: '\n'의 위치, 없으면 len
+ * - scan: '\n' 앞까지(없으면 len까지)에서 찾은 ':' 위치(data 기준)와 제어 문자 여부
+ */
+size_t http_scan_line(const char *data, size_t len, struct http_scan *scan);
+
+// 현재 선택된 구현 이름 ("avx2", "sse2", "scalar")
+const char *http_scan_impl(void);
+
+// 구현을 직접 지정 (벤치마크용), 지원하지 않는 이름이면 -1
+int http_scan_select(const char *name);
+
+#endif
@@ -0,0 +1,78 @@
+#include <stdlib.h>
+#include <stdatomic.h>
+#include <time.h>
+#include "pool_rcu.h"
+#include "../utils/logger.h"
+
+#define GRACE_POLL_NS 1000000 // grace period를 기다리는 동안 reader 상태를 확인하는 간격 (1ms)
+
+static _Atomic(struct backend_pool *) current_pool;
+
+// reader마다 마지막으로 확인한 grace 세대 (0이면 offline, pool 포인터를 들고 있지 않음)
+static atomic_ullong reader_seen[POOL_RCU_MAX_READERS];
+static int reader_count;
+static atomic_ullong grace_generation = 1;
+
+void pool_rcu_init(int readers)
+{
+    reader_count = readers < POOL_RCU_MAX_READERS ? readers : POOL_RCU_MAX_READERS;
+    for (int i = 0; i < reader_count; i++)
+        atomic_store(&reader_seen[i], 0);
+}
+
+void pool_rcu_online(int reader)
+{
+    // 이 시점 이후에 읽는 pool 포인터는 이 세대까지 게시된 pool
+    atomic_store(&reader_seen[reader], atomic_load(&grace_generation));
+}
+
+void pool_rcu_offline(int reader)
+{
+    atomic_store(&reader_seen[reader], 0);
+}
+
+struct backend_pool *pool_rcu_current(void)
+{
+    return atomic_load(&current_pool);
+}
+
+struct backend_pool *pool_rcu_acquire(void)
+{
+    // online reader가 읽은 pool은 grace period가 끝날 때까지 게시 참조가 남아 있으므로 참조 수가 0일 수 없음
+    struct backend_pool *pool = atomic_load(&current_pool);
+    atomic_fetch_add(&pool->refs, 1);
+    return pool;
+}
+
+void pool_rcu_release(struct backend_pool *pool)
+{
+    if (atomic_fetch_sub(&pool->refs, 1) == 1)
+    {
+        log_message(LOG_INFO, "Retired backend pool with %d servers released", pool->server_count);
+        cleanup_backend_pool(pool);
+        free(pool);
+    }
+}
+
+// 게시 이전에 pool 포인터를 읽었을 수 있는 reader가 모두 online을 다시 지나거나 offline이 될 때까지 대기
+static void synchronize(void)
+{
+    unsigned long long target = atomic_fetch_add(&grace_generation, 1) + 1;
+    struct timespec poll = {0, GRACE_POLL_NS};
+
+    for (int i = 0; i < reader_count; i++)
+    {
+        unsigned long long seen;
+        while ((seen = atomic_load(&reader_seen[i])) != 0 && seen < target)
+            nanosleep(&poll, NULL);
+    }
+}
+
+struct backend_pool *pool_rcu_publish(struct backend_pool *pool)
+{
+    atomic_store(&pool->refs, 1);
+    struct backend_pool *old = atomic_exchange(&current_pool, pool);
+    if (old)
+        synchronize();
+    return old;
+}
@@ -0,0 +1,37 @@
+#ifndef POOL_RCU_H
+#define POOL_RCU_H
+
+#include "health.h"
+
+/**
+ * 현재 backend_pool의 게시와 회수 (RCU 방식)
+ * - 설정을 다시 읽으면 새 pool을 따로 만든 뒤 포인터 하나를 atomic하게 바꿔서 게시
+ * - reactor는 잠금 없이 현재 pool을 읽고, 요청을 시작할 때 참조를 얻어 요청이 끝날 때까지 같은 pool을 사용
+ * - 이전 pool은 모든 reactor가 이벤트 루프를 한 바퀴 돈 뒤(grace period) 게시 참조를 놓고,
+ *   마지막 요청이 참조를 놓을 때 해제됨
+ * - reactor는 이벤트를 기다리기 직전 offline, 깨어난 직후 online을 호출 (쉬고 있는 reactor는 기다리지 않음)
+ */
+#define POOL_RCU_MAX_READERS 256
+
+// reader 수 설정 (reactor 시작 전), 모든 reader는 offline 상태로 시작
+void pool_rcu_init(int readers);
+void pool_rcu_online(int reader);
+void pool_rcu_offline(int reader);
+
+// online 상태의 reader가 이번 이벤트 처리 동안만 사용하는 현재 pool (참조를 얻지 않음)
+struct backend_pool *pool_rcu_current(void);
+
+// 요청 하나 동안 사용할 현재 pool의 참조 (online 상태에서 호출)
+struct backend_pool *pool_rcu_acquire(void);
+// 참조를 놓고, 게시가 끝난 pool의 마지막 참조였으면 해제
+void pool_rcu_release(struct backend_pool *pool);
+
+/**
+ * 새 pool 게시 (malloc으로 만든 pool, 게시 참조를 가져감)
+ * - grace period가 지날 때까지 기다린 뒤 이전 pool을 반환 (처음 게시하면 NULL)
+ * - 반환된 pool은 호출하는 쪽에서 다른 스레드(헬스 체크)의 사용을 멈춘 뒤 pool_rcu_release로 게시 참조를 놓음
+ * - 게시는 한 스레드에서만 호출
+ */
+struct backend_pool *pool_rcu_publish(struct backend_pool *pool);
+
+#endif
@@ -1,3 +1,4 @@
+#define _GNU_SOURCE
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -11,71 +12,259 @@
 #include <errno.h>
 #include <limits.h>
 #include <netinet/tcp.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <stdatomic.h>
+#include <signal.h>
+#include <time.h>
+#include "proxy.h"
+#include "connection.h"
 #include "health.h"
+#include "backend_config.h"
+#include "balancer.h"
+#include "pool_rcu.h"
+#include "admin.h"
+#include "metrics.h"
 #include "../utils/logger.h"
 
 #define MAX_EVENTS 100
-#define CHUNK_SIZE (1024 * 1024)
-static int current_server = 0;
-
-// 클라이언트와 HTTP 서버 간의 연결 상태를 추적하기 위한 구조체
-// 각 연결마다 하나의 인스턴스 사용
-struct connection
-{
-    int client_fd;
-    int backend_fd;
-    char *buffer;
-    size_t buffer_size;
-    size_t bytes_received;
-    size_t bytes_sent;
-    int server_idx;
-    int is_backend_connected;
-    struct sockaddr_in client_addr;
-    int already_cleaned;
-
-    char *write_buffer;       // pending된 쓰기 데이터 버퍼
-    size_t write_buffer_size; // 버퍼의 전체 크기
-    size_t write_buffer_sent; // 이미 전송된 크기
-};
+#define MAX_REACTORS 256
+#define MAX_CONNECTION_TABLE (1 << 20) // RLIMIT_NOFILE이 더 커도 connection 테이블은 이 크기까지만
+
+// epoll_event.data.u64 구성: [generation 32비트][client_fd 31비트][백엔드 소켓 표시 1비트]
+// 같은 슬롯이 재사용되면 generation이 달라지므로, 이미 정리된 connection의 이벤트는 비교 한 번으로 걸러짐
+// backend_fd는 keep-alive 연결에서 요청마다 바뀌므로 backend_generation을 기록
+#define EVENT_TAG_BACKEND 1ULL
+#define EVENT_LISTEN UINT64_MAX // 리스닝 소켓 (유효한 connection 값과 겹치지 않음)
+#define EVENT_ADMIN (UINT64_MAX - 1) // 관리 포트의 epoll 인스턴스 (client_fd가 connection 테이블 크기보다 작으므로 겹치지 않음)
+#define EVENT_DATA(conn, is_backend) (((uint64_t)((is_backend) ? (conn)->backend_generation   \
+                                                               : (conn)->generation) << 32) | \
+                                      ((uint64_t)(uint32_t)(conn)->client_fd << 1) |          \
+                                      ((is_backend) ? EVENT_TAG_BACKEND : 0))
+#define EVENT_SLOT(data) ((size_t)(((data) & 0xFFFFFFFFULL) >> 1))
+#define EVENT_GENERATION(data) ((uint32_t)((data) >> 32))
+
+// EPOLLET 모드에서 fd마다 한 번만 등록하는 고정 이벤트 마스크
+#define ET_EVENTS (EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET)
+
+static int balancer = BALANCER_DEFAULT; // run_proxy에서 reactor 시작 전에 한 번만 설정
+
+// SIGHUP을 받으면 설정 파일을 다시 읽어 새 backend_pool을 게시하는 스레드
+static struct
+{
+    pthread_t thread;
+    atomic_bool stopping;
+    const char *config_path;
+    struct health_check_options health_check;
+} reloader;
+
+// /metrics에서 gauge를 읽을 reactor 목록 (run_proxy에서 reactor 시작 전에 한 번만 설정)
+static struct
+{
+    struct reactor *reactors;
+    int count;
+} metrics_reactors;
 
-static struct backend_pool pool;
+// client_fd로 인덱싱되는 connection 테이블 (epoll 경로)
+// - 모든 reactor가 공유하지만 fd는 프로세스 전체에서 유일하므로 슬롯마다 소유 reactor는 하나
+// - 미리 예약만 하고 실제 메모리는 슬롯을 처음 사용할 때 커널이 할당 (accept마다 malloc/free 없음)
+static struct connection *connection_table;
+static size_t connection_table_size;
 
-// connection 초기화
-static struct connection *create_connection(int client_fd, struct sockaddr_in client_addr)
+static int connection_table_init(void)
 {
-    struct connection *conn = (struct connection *)malloc(sizeof(struct connection));
-    if (!conn)
-        return NULL;
-
-    // 초기 버퍼 할당
-    conn->buffer = (char *)malloc(CHUNK_SIZE);
-    if (!conn->buffer)
+    struct rlimit limit;
+    size_t size = MAX_CONNECTION_TABLE;
+    if (getrlimit(RLIMIT_NOFILE, &limit) == 0 && limit.rlim_cur != RLIM_INFINITY && limit.rlim_cur < size)
+        size = limit.rlim_cur;
+
+    void *table = mmap(NULL, size * sizeof(struct connection), PROT_READ | PROT_WRITE,
+                       MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if (table == MAP_FAILED)
     {
-        free(conn);
-        return NULL;
+        log_message(LOG_ERROR, "Failed to reserve connection table: %s", strerror(errno));
+        return -1;
     }
 
+    connection_table = table;
+    connection_table_size = size;
+    log_message(LOG_INFO, "Connection table reserved for %zu fds (%zu bytes per connection)",
+                size, sizeof(struct connection));
+    return 0;
+}
+
+// connection 초기화 (epoll/io_uring 공통)
+// 링 버퍼는 처음 데이터를 읽을 때 풀에서 가져오므로 여기서는 메모리를 할당하지 않음
+int connection_init(struct connection *conn, struct buffer_pool *pool, int client_fd, struct sockaddr_in client_addr)
+{
+    ring_buffer_init(&conn->request, pool, REQUEST_RING_INITIAL, REQUEST_RING_SIZE);
+    ring_buffer_init(&conn->response, pool, RESPONSE_RING_INITIAL, RESPONSE_RING_SIZE);
+
     conn->client_fd = client_fd;
     conn->backend_fd = -1;
-    conn->buffer_size = CHUNK_SIZE;
-    conn->bytes_received = 0;
-    conn->bytes_sent = 0;
     conn->server_idx = -1;
+    conn->pool = NULL;
     conn->is_backend_connected = 0;
     conn->client_addr = client_addr;
     conn->already_cleaned = 0;
+    conn->next_closed = NULL;
+
+    conn->epoll_ctl_calls = 0;
+    conn->client_events = 0;
+    conn->backend_events = 0;
+    conn->client_read_paused = 0;
+
+    conn->backend_reused = 0;
+    conn->request_keep_alive = 0;
+    timer_init(&conn->timer);
+    conn->timeout_kind = -1;
+    conn->response_time_ms = -1;
+    conn->request_length = -1;
+    conn->request_forwarded = 0;
+    conn->request_held = 0;
+    conn->response_started = 0;
+    conn->response_timed_out = 0;
+    conn->client_eof = 0;
+    backend_set_clear(&conn->tried_servers);
+    conn->retries = 0;
+    http_request_init(&conn->request_state);
+    http_response_init(&conn->response_state, 0);
+    conn->splice_active = 0;
+    conn->pipe_fds[0] = -1;
+    conn->pipe_fds[1] = -1;
+    conn->pipe_bytes = 0;
+    conn->backend_eof = 0;
 
-    conn->write_buffer = NULL;
-    conn->write_buffer_size = 0;
-    conn->write_buffer_sent = 0;
+    return 0;
+}
 
-    memset(conn->buffer, 0, CHUNK_SIZE);
+// client_fd의 테이블 슬롯을 초기화해서 사용 (이전 사용과 구분되도록 generation 증가)
+static struct connection *create_connection(struct reactor *reactor, int client_fd, struct sockaddr_in client_addr)
+{
+    if ((size_t)client_fd >= connection_table_size)
+    {
+        log_message(LOG_ERROR, "fd %d exceeds connection table size %zu", client_fd, connection_table_size);
+        return NULL;
+    }
 
+    struct connection *conn = &connection_table[client_fd];
+    if (connection_init(conn, &reactor->buffer_pool, client_fd, client_addr) < 0)
+        return NULL;
+    conn->generation++;
+    conn->backend_generation++;
     return conn;
 }
 
+static double elapsed_ms(const struct timespec *start)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (now.tv_sec - start->tv_sec) * 1000.0 + (now.tv_nsec - start->tv_nsec) / 1000000.0;
+}
+
+// 진행 중인 요청을 서버 통계에 반영 (응답을 끝까지 받지 못했으면 지금까지 걸린 시간)
+static void end_request(struct connection *conn, bool success)
+{
+    if (conn->server_idx < 0)
+        return;
+
+    double response_time = conn->response_time_ms >= 0 ? conn->response_time_ms : elapsed_ms(&conn->request_started);
+    track_request_end(conn->pool, conn->server_idx, success, response_time);
+    conn->server_idx = -1;
+    conn->response_time_ms = -1;
+}
+
+// 요청을 시작할 때 얻은 backend_pool 참조를 놓음 (설정을 다시 읽어 교체된 pool이면 여기서 해제될 수 있음)
+static void release_request_pool(struct connection *conn)
+{
+    if (!conn->pool)
+        return;
+    pool_rcu_release(conn->pool);
+    conn->pool = NULL;
+}
+
+// 서버 상태 업데이트 및 버퍼 해제 (소켓은 호출하는 쪽에서 닫음)
+void connection_release(struct connection *conn)
+{
+    end_request(conn, !conn->response_timed_out);
+    release_request_pool(conn);
+
+    ring_buffer_free(&conn->request);
+    ring_buffer_free(&conn->response);
+}
+
+// 비어 있는 링 버퍼를 풀에 반납 (이벤트 처리 후 대기 상태로 돌아갈 때 호출)
+void connection_trim_buffers(struct connection *conn)
+{
+    ring_buffer_trim(&conn->request);
+    ring_buffer_trim(&conn->response);
+}
+
+// 요청 헤더 수신 중 len 바이트를 더 담을 수 있도록 request 링을 확보 (필요하면 다음 등급으로 키움)
+// 요청 헤더의 최대 크기는 REQUEST_RING_SIZE로 제한됨
+int connection_reserve(struct connection *conn, size_t len)
+{
+    if (ring_buffer_reserve(&conn->request, len) < 0 || ring_buffer_space(&conn->request) < len)
+    {
+        log_message(LOG_ERROR, "Request header too large (%zu bytes without terminator)",
+                    ring_buffer_used(&conn->request));
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * HTTP 요청 헤더가 완전히 수신되었는지 확인
+ * - 지난번에 해석한 위치부터 새로 받은 데이터만 이어서 해석
+ * - 반환값: HTTP_PARSE_DONE(1) 헤더 완료, HTTP_PARSE_AGAIN(0) 더 받아야 함, HTTP_PARSE_ERROR(-1) 잘못된 요청
+ */
+int connection_request_ready(struct connection *conn)
+{
+    // 헤더 수신 중에는 request 링이 한 번도 돌지 않았으므로 처음부터 연속된 영역
+    size_t len;
+    const char *data = ring_buffer_read_ptr(&conn->request, &len);
+    if (len == 0)
+        return HTTP_PARSE_AGAIN;
+
+    int rc = http_request_parse(&conn->request_state, data, len);
+    if (rc == HTTP_PARSE_ERROR)
+        log_message(LOG_ERROR, "Malformed request from client fd %d", conn->client_fd);
+    return rc;
+}
+
+// 백엔드 서버별 keep-alive 연결 풀 통계
+void log_upstream_pool_stats(void)
+{
+    struct backend_pool *pool = pool_rcu_current();
+    struct histogram_snapshot snapshot;
+    struct latency_percentiles percentiles;
+
+    for (int i = 0; i < pool->server_count; i++)
+    {
+        struct backend_server *server = &pool->servers[i];
+        if (atomic_load(&server->total_requests) == 0)
+            continue; // 서버가 수천 개일 때 요청을 보낸 적 없는 서버는 생략
+        upstream_pool_log_stats(&server->idle_connections, server->address, server->port);
+
+        histogram_snapshot_init(&snapshot);
+        read_server_latency(pool, i, &snapshot);
+        histogram_percentiles(&snapshot, &percentiles);
+        log_message(LOG_INFO, "[METRIC][LATENCY %s:%d] p50 %.3fms p90 %.3fms p99 %.3fms p999 %.3fms (%llu requests)",
+                    server->address, server->port, percentiles.p50, percentiles.p90, percentiles.p99,
+                    percentiles.p999, snapshot.total_count);
+    }
+
+    histogram_snapshot_init(&snapshot);
+    read_pool_latency(pool, &snapshot);
+    histogram_percentiles(&snapshot, &percentiles);
+    log_message(LOG_INFO, "[METRIC][LATENCY SYSTEM] p50 %.3fms p90 %.3fms p99 %.3fms p999 %.3fms (%llu requests)",
+                percentiles.p50, percentiles.p90, percentiles.p99, percentiles.p999, snapshot.total_count);
+}
+
 // 소켓 버퍼 크기 설정
-static void set_socket_buffer_size(int fd)
+void set_socket_buffer_size(int fd)
 {
     int buffer_size = 10485760; // 10MB
     setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &buffer_size, sizeof(buffer_size));
@@ -99,6 +288,23 @@ static int set_nonblocking(int fd)
     return fcntl(fd, F_SETFL, flags | O_NONBLOCK);
 }
 
+/**
+ * connection 소켓의 epoll 등록/변경
+ * - 모든 connection 관련 epoll_ctl은 이 함수를 거치며 호출 수를 집계
+ * - is_backend: backend_fd에 대한 등록인지 여부 (이벤트 디스패치에 사용)
+ */
+static int connection_epoll_ctl(struct reactor *reactor, struct connection *conn,
+                                int op, int fd, int is_backend, uint32_t events)
+{
+    struct epoll_event ev;
+    ev.events = events;
+    ev.data.u64 = EVENT_DATA(conn, is_backend);
+
+    conn->epoll_ctl_calls++;
+    reactor->epoll_ctl_calls++;
+    return epoll_ctl(reactor->epoll_fd, op, fd, &ev);
+}
+
 /**
  * HTTP 서버 선택 함수 (Least-Connection 방식)
  *
@@ -106,385 +312,974 @@ static int set_nonblocking(int fd)
  * - 성공: 선택된 서버의 인덱스
  * - 실패: -1
  */
-int select_server()
+int select_server(struct backend_pool *pool, const struct backend_set *excluded)
 {
-    int selected = -1;
-    int min_connections = INT_MAX;
+    // 이미 실패한 서버와 헬스 체크에서 비정상인 서버는 건너뜀 (벤치마크와 같은 구현을 쓰도록 balancer.c에 둠)
+    return balancer_select_least_conn(pool, excluded);
+}
 
-    // 모든 서버를 순회하며 가장 적은 요청 수를 가진 서버를 찾음
-    for (int i = 0; i < pool.server_count; i++)
-    {
-        struct backend_server *server = &pool.servers[i];
+static void release_pipe(struct reactor *reactor, struct connection *conn);
 
-        // 서버가 유효하고 헬스 상태가 "정상"일 때만 고려
-        if (server->is_healthy && server->current_requests < min_connections)
-        {
-            min_connections = server->current_requests;
-            selected = i;
-        }
-    }
-    if (selected == -1)
+// 응답을 끝까지 받은 keep-alive 연결은 닫지 않고 백엔드 서버의 풀에 반납, 그 외에는 닫음
+// fd가 열린 채로 다른 reactor에서 다시 쓰이므로 이 reactor의 epoll에서는 먼저 제거
+// (close()된 fd는 epoll 관심 목록에서 커널이 자동으로 제거하므로 EPOLL_CTL_DEL은 생략)
+static void release_backend(struct reactor *reactor, struct connection *conn)
+{
+    if (conn->backend_fd < 0)
+        return;
+
+    if (connection_backend_reusable(conn) &&
+        connection_epoll_ctl(reactor, conn, EPOLL_CTL_DEL, conn->backend_fd, 1, 0) == 0)
     {
-        log_message(LOG_ERROR, "No healthy backend servers available");
+        connection_checkin_backend(conn);
+        return;
     }
-    else
+
+    close(conn->backend_fd);
+    conn->backend_fd = -1;
+}
+
+// 요청 하나가 끝날 때마다 reactor 통계 갱신 (로그는 BUFFER_POOL_STATS_INTERVAL 요청마다 한 번)
+static void count_completed_request(struct reactor *reactor, struct connection *conn)
+{
+    reactor->completed_requests++;
+    conn->epoll_ctl_calls = 0;
+
+    if (reactor->completed_requests % BUFFER_POOL_STATS_INTERVAL == 0)
     {
-        struct backend_server *selected_server = &pool.servers[selected];
+        log_message(LOG_INFO, "epoll_ctl calls per request (reactor %d average over %lu requests): %.2f",
+                    reactor->id, reactor->completed_requests,
+                    (double)reactor->epoll_ctl_calls / reactor->completed_requests);
+        buffer_pool_log_stats(&reactor->buffer_pool, reactor->id);
+        log_upstream_pool_stats();
     }
-
-    return selected;
 }
 
-static void cleanup_connection(int epoll_fd, struct connection *conn)
+static void cleanup_connection(struct reactor *reactor, struct connection *conn)
 {
-    log_message(LOG_INFO, "Starting cleanup for connection");
     if (!conn || conn->already_cleaned)
-    {
-        log_message(LOG_INFO, "Connection is null or already cleaned");
         return;
-    }
 
-    log_message(LOG_INFO, "Cleaning connection - backend_fd: %d, client_fd: %d", conn->backend_fd, conn->client_fd);
     conn->already_cleaned = 1;
+    conn->generation++; // 이 배치에 남은 이벤트는 generation이 달라서 무시됨
+    conn->backend_generation++;
+
+    connection_clear_timeout(reactor, conn);
+    release_backend(reactor, conn);
+    release_pipe(reactor, conn);
+
+    // 서버 상태 업데이트 및 메모리 해제 (요청 처리 중이 아니었던 idle connection은 통계에서 제외)
+    int request_in_progress = conn->server_idx >= 0;
+    connection_release(conn);
+    if (request_in_progress)
+        count_completed_request(reactor, conn);
+
+    // client_fd를 닫으면 다른 reactor가 같은 fd(= 같은 슬롯)를 accept할 수 있으므로
+    // 이 배치의 처리가 모두 끝난 뒤에 닫음
+    conn->next_closed = reactor->closed_connections;
+    reactor->closed_connections = conn;
+}
 
-    if (conn->backend_fd >= 0)
-    {
-        log_message(LOG_INFO, "Closing backend_fd: %d", conn->backend_fd);
-        epoll_ctl(epoll_fd, EPOLL_CTL_DEL, conn->backend_fd, NULL);
-        close(conn->backend_fd);
-        conn->backend_fd = -1;
-    }
+// request 링 중 현재 요청에 속해 백엔드로 보낼 바이트 수 (그 뒤는 파이프라이닝된 다음 요청)
+static size_t request_pending(const struct connection *conn)
+{
+    size_t used = ring_buffer_used(&conn->request);
+    if (conn->request_length < 0)
+        return used;
 
-    if (conn->client_fd >= 0)
-    {
-        log_message(LOG_INFO, "Closing client_fd: %d", conn->client_fd);
-        epoll_ctl(epoll_fd, EPOLL_CTL_DEL, conn->client_fd, NULL);
-        close(conn->client_fd);
-        conn->client_fd = -1;
-    }
+    unsigned long long remaining = (unsigned long long)conn->request_length - conn->request_forwarded;
+    return used < remaining ? used : (size_t)remaining;
+}
 
-    // 서버 상태 업데이트
-    if (conn->server_idx >= 0)
-    {
-        track_request_end(&pool, conn->server_idx, 1, 0);
-        conn->server_idx = -1;
-    }
+// LT 모드에서 connection 상태에 맞는 client_fd 이벤트
+static uint32_t client_interest(const struct connection *conn)
+{
+    uint32_t events = 0;
+    if (!conn->client_read_paused && !conn->client_eof)
+        events |= EPOLLIN;
+    // 클라이언트로 보내지 못한 응답이 남아 있으면 EPOLLOUT 대기
+    if (ring_buffer_used(&conn->response) > 0 || conn->pipe_bytes > 0)
+        events |= EPOLLOUT;
+    return events;
+}
 
-    // NULL 체크 후 메모리 해제
-    if (conn->buffer)
+// LT 모드에서 connection 상태에 맞는 backend_fd 이벤트
+static uint32_t backend_interest(const struct connection *conn)
+{
+    if (!conn->is_backend_connected)
+        return EPOLLOUT; // 연결 완료 대기
+
+    uint32_t events = 0;
+    if (request_pending(conn) > 0)
+        events |= EPOLLOUT;
+    // response 링이 가득 찼거나 파이프를 비우지 못한 동안에는 백엔드 읽기를 멈춤
+    // (EOF 이후에는 남은 응답을 보내는 동안 계속 읽기 가능으로 보고되므로 제외)
+    if (!ring_buffer_full(&conn->response) && conn->pipe_bytes == 0 && !conn->backend_eof)
+        events |= EPOLLIN;
+    return events;
+}
+
+/**
+ * 이벤트 처리 후 관심 목록을 connection 상태에 맞춤 (LT 모드)
+ * - 등록된 이벤트와 달라진 fd만 EPOLL_CTL_MOD 하므로 상태 변화가 없으면 epoll_ctl 호출 없음
+ * - ET 모드는 두 fd 모두 고정 마스크로 한 번만 등록하므로 변경 없음
+ */
+static int update_interest(struct reactor *reactor, struct connection *conn)
+{
+    if (reactor->edge_triggered)
+        return 0;
+
+    uint32_t events = client_interest(conn);
+    if (events != conn->client_events)
     {
-        free(conn->buffer);
-        conn->buffer = NULL;
+        if (connection_epoll_ctl(reactor, conn, EPOLL_CTL_MOD, conn->client_fd, 0, events) < 0)
+            return -1;
+        conn->client_events = events;
     }
 
-    if (conn->write_buffer)
+    if (conn->backend_fd >= 0)
     {
-        free(conn->write_buffer);
-        conn->write_buffer = NULL;
+        events = backend_interest(conn);
+        if (events != conn->backend_events)
+        {
+            if (connection_epoll_ctl(reactor, conn, EPOLL_CTL_MOD, conn->backend_fd, 1, events) < 0)
+                return -1;
+            conn->backend_events = events;
+        }
     }
-
-    free(conn);
+    return 0;
 }
 
-static void handle_pending_write(int epoll_fd, struct connection *conn)
+/**
+ * response 링에 쌓인 데이터를 클라이언트로 전송
+ *
+ * 반환값:
+ * - 1: 모두 전송 완료
+ * - 0: 소켓 버퍼가 가득 차 일부만 전송 (EAGAIN)
+ * - -1: 전송 실패
+ */
+static int flush_response_to_client(struct connection *conn)
 {
-    while (conn->write_buffer_sent < conn->write_buffer_size)
+    while (ring_buffer_used(&conn->response) > 0)
     {
-        ssize_t sent = send(conn->client_fd,
-                            conn->write_buffer + conn->write_buffer_sent,
-                            conn->write_buffer_size - conn->write_buffer_sent,
-                            MSG_NOSIGNAL);
+        size_t len;
+        const char *data = ring_buffer_read_ptr(&conn->response, &len);
+        ssize_t sent = send(conn->client_fd, data, len, MSG_NOSIGNAL);
 
         if (sent < 0)
         {
             if (errno == EAGAIN || errno == EWOULDBLOCK)
             {
-                return;
+                return 0;
             }
-            cleanup_connection(epoll_fd, conn);
-            return;
+            return -1;
         }
-        conn->write_buffer_sent += sent;
+        ring_buffer_consume(&conn->response, sent);
     }
+    return 1;
+}
 
-    // 모든 데이터를 전송했다면 버퍼 정리
-    free(conn->write_buffer);
-    conn->write_buffer = NULL;
-    conn->write_buffer_size = 0;
-    conn->write_buffer_sent = 0;
+static int flush_request_to_backend(struct reactor *reactor, struct connection *conn);
+static void start_request(struct reactor *reactor, struct connection *conn);
 
-    // EPOLLOUT 이벤트 제거
-    struct epoll_event ev;
-    ev.events = EPOLLIN;
-    ev.data.ptr = conn;
-    if (epoll_ctl(epoll_fd, EPOLL_CTL_MOD, conn->client_fd, &ev) < 0)
+static int choose_server(const struct connection *conn)
+{
+    struct backend_pool *pool = conn->pool;
+    if (balancer == BALANCER_P2C)
+        return balancer_select_p2c(pool, &conn->tried_servers);
+    if (balancer == BALANCER_SWRR)
+        return balancer_select_swrr(pool, &conn->tried_servers);
+    if (balancer == BALANCER_MAGLEV_CLIENT || balancer == BALANCER_MAGLEV_URI)
+        return balancer_select_maglev(pool, pool->maglev, conn->balance_key, &conn->tried_servers);
+    return select_server(pool, &conn->tried_servers);
+}
+
+// Maglev 정책에서 요청을 보낼 서버를 정하는 키 (data는 요청 헤더의 시작)
+static uint64_t request_balance_key(const struct connection *conn, const char *data)
+{
+    if (balancer == BALANCER_MAGLEV_CLIENT)
+        return balancer_hash(&conn->client_addr.sin_addr, sizeof(conn->client_addr.sin_addr));
+    if (balancer == BALANCER_MAGLEV_URI)
+        return balancer_hash(data + conn->request_state.uri.offset, conn->request_state.uri.length);
+    return 0;
+}
+
+// 아직 시도하지 않은 서버를 골라 그 서버의 keep-alive 연결을 꺼내거나 새 소켓을 준비
+static int open_backend(struct connection *conn, struct sockaddr_in *backend_addr)
+{
+    // 백엔드 서버 선택
+    conn->server_idx = choose_server(conn);
+    if (conn->server_idx < 0)
     {
-        cleanup_connection(epoll_fd, conn);
-        return;
+        log_message(LOG_ERROR, "Failed to select backend server");
+        return -1;
     }
+    backend_set_add(&conn->tried_servers, conn->server_idx);
+
+    struct backend_server *server = &conn->pool->servers[conn->server_idx];
+    track_request_start(conn->pool, conn->server_idx);
+    clock_gettime(CLOCK_MONOTONIC, &conn->request_started);
+    conn->response_time_ms = -1;
+    conn->response_timed_out = 0;
+
+    conn->backend_fd = upstream_pool_checkout(&server->idle_connections);
+    if (conn->backend_fd >= 0)
+    {
+        conn->backend_reused = 1;
+        return 1;
+    }
+
+
+    // 백엔드 연결 설정
+    conn->backend_fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK, 0);
+    if (conn->backend_fd < 0)
+    {
+        log_message(LOG_ERROR, "Failed to create backend socket: %s", strerror(errno));
+        return -1;
+    }
+    upstream_pool_note_created(&server->idle_connections);
+
+    set_socket_buffer_size(conn->backend_fd);
+
+    memset(backend_addr, 0, sizeof(*backend_addr));
+    backend_addr->sin_family = AF_INET;
+    backend_addr->sin_port = htons(server->port);
+    backend_addr->sin_addr.s_addr = inet_addr(server->address);
+    return 0;
+}
+
+/**
+ * 요청 헤더가 완성된 뒤 백엔드 서버를 선택하고 연결을 준비
+ * - 선택한 서버의 keep-alive 풀에 idle 연결이 있으면 그대로 사용
+ * - 없으면 non-blocking 소켓을 새로 생성 (connect는 호출하는 쪽에서 수행)
+ * - 멱등 메서드이고 요청 전체가 이미 링에 있으면 재시도할 수 있도록 응답이 올 때까지 요청을 남겨 둠
+ *
+ * 반환값:
+ * - 새 소켓: 0 (conn->backend_fd, conn->server_idx, backend_addr 설정됨)
+ * - 풀의 연결 재사용: 1 (이미 연결되어 있으므로 바로 요청 전송)
+ * - 실패: -1
+ */
+int connection_open_backend(const struct reactor *reactor, struct connection *conn, struct sockaddr_in *backend_addr)
+{
+    // 응답의 끝을 판단하고 연결을 반납할 수 있는지 확인하기 위해 요청 길이를 기록
+    const struct http_request *req = &conn->request_state;
+    size_t len;
+    conn->balance_key = request_balance_key(conn, ring_buffer_read_ptr(&conn->request, &len));
+    ring_buffer_consume(&conn->request, req->request_start); // 요청 앞의 빈 줄은 백엔드로 보내지 않음
+    conn->request_length = http_request_length(req);
+    conn->request_keep_alive = req->keep_alive;
+    http_response_init(&conn->response_state, req->head_request);
+
+    backend_set_clear(&conn->tried_servers);
+    conn->retries = 0;
+    conn->response_started = 0;
+    // 설정을 다시 읽어도 이 요청은 재시도까지 같은 pool의 서버 인덱스를 사용
+    release_request_pool(conn);
+    conn->pool = pool_rcu_acquire();
+    conn->request_held = reactor->max_retries > 0 && req->idempotent && conn->request_length >= 0 &&
+                         ring_buffer_used(&conn->request) >= (unsigned long long)conn->request_length;
+
+    return open_backend(conn, backend_addr);
 }
 
-// 클라이언트의 데이터를 읽기
-static void handle_client_read(int epoll_fd, struct connection *conn)
+// 재시도를 위해 남겨 둔 요청을 링에서 제거 (응답이 시작되면 더 이상 다시 보낼 수 없음)
+static void release_held_request(struct connection *conn)
 {
-    // 버퍼가 가득 찬 경우
-    if (conn->bytes_received + CHUNK_SIZE > conn->buffer_size)
+    if (!conn->request_held)
+        return;
+    ring_buffer_consume(&conn->request, conn->request_forwarded);
+    conn->request_held = 0;
+}
+
+/**
+ * 백엔드가 응답하기 전에 실패함 (connect 실패/timeout, 응답 전에 연결이 끊김)
+ * - 실패한 시도를 해당 서버의 실패로 기록
+ * - 요청을 링에 남겨 두었고 재시도 횟수가 남아 있으면 다시 보낼 수 있도록 요청 전송 상태를 되돌림
+ *   (백엔드 소켓은 호출하는 쪽에서 닫은 뒤 connection_retry_backend로 다른 서버에 연결)
+ *
+ * 반환값: 1 재시도 가능, 0 재시도 불가 (connection 정리 필요)
+ */
+int connection_backend_failed(const struct reactor *reactor, struct connection *conn)
+{
+    int retry = conn->request_held && conn->retries < reactor->max_retries;
+    if (conn->server_idx >= 0)
     {
-        size_t new_size = conn->buffer_size * 2;
-        char *new_buffer = realloc(conn->buffer, new_size);
-        if (!new_buffer)
-        {
-            cleanup_connection(epoll_fd, conn);
-            return;
-        }
-        conn->buffer = new_buffer;
-        conn->buffer_size = new_size;
+        struct backend_server *server = &conn->pool->servers[conn->server_idx];
+        log_message(LOG_ERROR, "Backend %s:%d failed before responding to client fd %d%s",
+                    server->address, server->port, conn->client_fd,
+                    retry ? ", retrying on another backend" : "");
     }
+    end_request(conn, false);
+    if (!retry)
+        return 0;
 
-    ssize_t bytes_read = recv(conn->client_fd,
-                              conn->buffer + conn->bytes_received,
-                              conn->buffer_size - conn->bytes_received - 1,
-                              0);
+    conn->retries++;
+    conn->request_forwarded = 0;
+    conn->response_started = 0;
+    conn->is_backend_connected = 0;
+    conn->backend_reused = 0;
+    conn->backend_eof = 0;
+    http_response_init(&conn->response_state, conn->request_state.head_request);
+    return 1;
+}
 
-    if (bytes_read <= 0)
-    {
-        if (bytes_read < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
-        {
-            return;
-        }
-        log_message(LOG_INFO, "Connection closed during read: %s", strerror(errno));
-        cleanup_connection(epoll_fd, conn);
+// connection_backend_failed 이후 아직 시도하지 않은 서버로 연결 준비 (반환값은 connection_open_backend와 같음)
+int connection_retry_backend(struct connection *conn, struct sockaddr_in *backend_addr)
+{
+    return open_backend(conn, backend_addr);
+}
+
+// 현재 요청 중 아직 백엔드로 보내지 않은 데이터의 연속된 영역 (요청을 남겨 두는 중이면 보낸 부분 다음부터)
+const char *connection_request_unsent(const struct connection *conn, size_t *len)
+{
+    if (conn->request_held)
+        return ring_buffer_peek(&conn->request, conn->request_forwarded, len);
+    return ring_buffer_read_ptr(&conn->request, len);
+}
+
+/**
+ * 백엔드 연결을 풀에 반납할 수 있는지 확인
+ * - 요청을 길이만큼 정확히 보냈고 (본문 길이를 모르는 요청이나 뒤따른 데이터가 없음)
+ * - 응답을 Content-Length까지 모두 받았으며 백엔드가 연결 유지를 허용한 경우
+ */
+int connection_backend_reusable(const struct connection *conn)
+{
+    return conn->backend_fd >= 0 && conn->is_backend_connected &&
+           conn->request_length >= 0 &&
+           conn->request_forwarded == (unsigned long long)conn->request_length &&
+           http_response_keep_alive(&conn->response_state);
+}
+
+// 백엔드 연결을 선택했던 서버의 풀에 반납 (이벤트 등록은 호출하는 쪽에서 해제)
+void connection_checkin_backend(struct connection *conn)
+{
+    upstream_pool_checkin(&conn->pool->servers[conn->server_idx].idle_connections, conn->backend_fd);
+    conn->backend_fd = -1;
+}
+
+/**
+ * 백엔드 응답의 끝에 도달함 (길이/chunked로 판단한 마지막 바이트 또는 백엔드 EOF)
+ * - 클라이언트로 전달을 마칠 때까지 기다리지 않고 이 시점까지를 백엔드 응답 시간으로 기록
+ */
+void connection_response_done(struct connection *conn)
+{
+    if (conn->server_idx >= 0 && conn->response_time_ms < 0)
+        conn->response_time_ms = elapsed_ms(&conn->request_started);
+}
+
+/**
+ * 응답을 모두 보낸 뒤 클라이언트 연결을 유지할 수 있는지 확인
+ * - 클라이언트가 연결 유지를 원하고, 백엔드 응답의 끝을 길이로 알 수 있었으며 연결 유지를 허용한 경우
+ * - 요청을 정확히 보냈어야 request 링에 남은 데이터가 다음 요청의 시작이 됨
+ */
+int connection_keep_alive(const struct connection *conn)
+{
+    return conn->request_keep_alive && conn->request_length >= 0 &&
+           conn->request_forwarded == (unsigned long long)conn->request_length &&
+           http_response_keep_alive(&conn->response_state);
+}
+
+/**
+ * 요청 하나를 끝내고 같은 클라이언트 연결에서 다음 요청을 기다리는 상태로 되돌림
+ * - backend_fd는 호출하는 쪽에서 풀에 반납하거나 닫은 뒤 호출
+ * - request 링에 남은 데이터(파이프라이닝된 다음 요청)는 처음부터 연속되도록 옮김
+ *
+ * 반환값: 0 성공, -1 메모리 부족
+ */
+int connection_finish_request(struct connection *conn)
+{
+    end_request(conn, true);
+    release_request_pool(conn);
+    release_held_request(conn);
+    conn->response_started = 0;
+
+    conn->backend_fd = -1;
+    conn->is_backend_connected = 0;
+    conn->backend_reused = 0;
+    conn->backend_eof = 0;
+    conn->request_keep_alive = 0;
+    conn->request_length = -1;
+    conn->request_forwarded = 0;
+    http_request_init(&conn->request_state);
+    http_response_init(&conn->response_state, 0);
+    return ring_buffer_linearize(&conn->request);
+}
 
+static long long monotonic_ms(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+/**
+ * connection의 timeout을 kind로 바꿈 (이전에 걸려 있던 timeout은 해제)
+ * - 설정에서 0으로 끈 종류면 timeout 없이 대기
+ */
+void connection_set_timeout(struct reactor *reactor, struct connection *conn, int kind)
+{
+    int timeout_ms = reactor->timeout_ms[kind];
+    if (timeout_ms <= 0)
+    {
+        connection_clear_timeout(reactor, conn);
         return;
     }
+    conn->timeout_kind = kind;
+    timer_wheel_add(&reactor->timers, &conn->timer, monotonic_ms() + timeout_ms);
+}
+
+void connection_clear_timeout(struct reactor *reactor, struct connection *conn)
+{
+    timer_wheel_del(&reactor->timers, &conn->timer);
+    conn->timeout_kind = -1;
+}
+
+// keep-alive 연결에 다음 요청의 첫 데이터가 도착하면 그때부터 요청 헤더 timeout 적용
+void connection_request_data(struct reactor *reactor, struct connection *conn)
+{
+    if (conn->timeout_kind == PROXY_TIMEOUT_IDLE)
+        connection_set_timeout(reactor, conn, PROXY_TIMEOUT_HEADER);
+}
+
+// 요청을 백엔드로 보내는 동안에는 마지막으로 보낸 시점부터 응답 첫 바이트를 기다림 (긴 업로드 허용)
+void connection_request_sent(struct reactor *reactor, struct connection *conn)
+{
+    if (conn->timeout_kind == PROXY_TIMEOUT_FIRST_BYTE)
+        connection_set_timeout(reactor, conn, PROXY_TIMEOUT_FIRST_BYTE);
+}
+
+// 응답이 시작되면 응답 본문 중계에는 timeout을 두지 않고, 재시도에 대비해 남겨 둔 요청도 제거
+void connection_response_data(struct reactor *reactor, struct connection *conn)
+{
+    if (conn->timeout_kind == PROXY_TIMEOUT_FIRST_BYTE)
+        connection_clear_timeout(reactor, conn);
+    release_held_request(conn);
+    conn->response_started = 1;
+}
+
+/**
+ * timeout이 지난 connection을 하나 꺼냄 (없으면 NULL, 정리는 호출하는 쪽에서)
+ * - kind: 만료된 timeout 종류
+ * - 응답 첫 바이트 timeout은 표시만 해 두고, 호출하는 쪽에서 정리할 때 해당 서버의 실패와 완료된 요청으로 함께 기록
+ *   (connect timeout은 다른 서버로 재시도할 수 있으므로 호출하는 쪽에서 connection_backend_failed로 처리)
+ */
+struct connection *connection_pop_timed_out(struct reactor *reactor, int *kind_out)
+{
+    struct timer *timer = timer_wheel_expire(&reactor->timers, monotonic_ms());
+    if (!timer)
+        return NULL;
+
+    struct connection *conn = (struct connection *)((char *)timer - offsetof(struct connection, timer));
+    int kind = conn->timeout_kind;
+    conn->timeout_kind = -1;
 
-    conn->bytes_received += bytes_read;
-    conn->buffer[conn->bytes_received] = '\0';
+    reactor->timeouts_expired[kind]++;
+    log_message(LOG_INFO, "Client fd %d: %s timeout (%d ms) expired (reactor %d %s timeouts: %lu)",
+                conn->client_fd, proxy_timeout_name(kind), reactor->timeout_ms[kind], reactor->id,
+                proxy_timeout_name(kind), reactor->timeouts_expired[kind]);
 
-    // HTTP 요청이 완전히 수신되었는지 확인
-    if (!conn->is_backend_connected && strstr(conn->buffer, "\r\n\r\n"))
+    if (kind == PROXY_TIMEOUT_FIRST_BYTE)
+        conn->response_timed_out = 1;
+    *kind_out = kind;
+    return conn;
+}
+
+// 가장 먼저 만료될 timeout까지 남은 시간 (걸린 timeout이 없으면 -1), 이벤트 대기 시간으로 사용
+int connection_timeout_wait_ms(const struct reactor *reactor)
+{
+    long long next = timer_wheel_next_ms(&reactor->timers);
+    if (next < 0)
+        return -1;
+
+    long long remaining = next - monotonic_ms();
+    if (remaining <= 0)
+        return 0;
+    return remaining > INT_MAX ? INT_MAX : (int)remaining;
+}
+
+/**
+ * 클라이언트의 데이터를 읽기
+ * - 헤더 수신 중: 요청 헤더가 완성될 때까지 request 링에 누적 (최대 REQUEST_RING_SIZE)
+ * - 헤더 수신 이후: 본문을 도착하는 대로 백엔드로 전달
+ *   백엔드가 받지 못해 request 링이 가득 차면 client_read_paused로 읽기를 멈추고
+ *   backend_fd의 EPOLLOUT에서 전송이 진행되면 다시 읽음
+ */
+static void handle_client_read(struct reactor *reactor, struct connection *conn)
+{
+    // 입력 EOF 이후에는 읽을 데이터가 없음 (ET 모드에서는 EPOLLOUT 이벤트에 EPOLLIN이 함께 표시됨)
+    if (conn->client_eof)
+        return;
+    conn->client_read_paused = 0;
+
+    // ET 모드에서는 EAGAIN이 나올 때까지 모두 읽어야 다음 이벤트를 받을 수 있음
+    do
     {
-        // 백엔드 서버 선택
-        conn->server_idx = select_server();
-        if (conn->server_idx < 0)
+        // 처음 읽을 때 풀에서 버퍼를 가져오고, 가득 찼으면 다음 등급으로 키움
+        if (ring_buffer_reserve(&conn->request, 1) < 0)
         {
-            log_message(LOG_ERROR, "Failed to select backend server");
-            cleanup_connection(epoll_fd, conn);
+            cleanup_connection(reactor, conn);
             return;
         }
 
-        struct backend_server *server = &pool.servers[conn->server_idx];
-        track_request_start(&pool, conn->server_idx);
-        log_message(LOG_INFO, "Attempting to connect to backend %s:%d", server->address, server->port);
+        size_t space;
+        char *dst = ring_buffer_write_ptr(&conn->request, &space);
 
-        // 백엔드 연결 설정
-        conn->backend_fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK, 0);
-        if (conn->backend_fd < 0)
+        // 링이 가득 찬 경우
+        if (space == 0)
         {
-            log_message(LOG_ERROR, "Failed to create backend socket: %s", strerror(errno));
-            cleanup_connection(epoll_fd, conn);
-            return;
+            // 헤더가 끝나지 않았는데 링이 가득 참
+            if (conn->backend_fd == -1 && connection_request_ready(conn) != HTTP_PARSE_DONE)
+            {
+                log_message(LOG_ERROR, "Request header too large (%zu bytes without terminator)",
+                            ring_buffer_used(&conn->request));
+                cleanup_connection(reactor, conn);
+                return;
+            }
+            // 백엔드가 링의 데이터를 가져갈 때까지 클라이언트 읽기를 멈춤 (backpressure)
+            conn->client_read_paused = 1;
+            break;
         }
-        log_message(LOG_INFO, "Created backend socket with fd: %d", conn->backend_fd);
-
-        // linger 옵션 설정 추가
-        struct linger sl;
-        sl.l_onoff = 1;  // linger 활성화
-        sl.l_linger = 0; // 즉시 종료
 
-        set_socket_buffer_size(conn->backend_fd);
+        ssize_t bytes_read = recv(conn->client_fd, dst, space, 0);
 
-        struct sockaddr_in backend_addr;
-        memset(&backend_addr, 0, sizeof(backend_addr));
-        backend_addr.sin_family = AF_INET;
-        backend_addr.sin_port = htons(server->port);
-        backend_addr.sin_addr.s_addr = inet_addr(server->address);
-
-        if (connect(conn->backend_fd, (struct sockaddr *)&backend_addr, sizeof(backend_addr)) < 0)
+        if (bytes_read <= 0)
         {
-            if (errno != EINPROGRESS)
+            if (bytes_read < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+            {
+                break;
+            }
+            if (bytes_read < 0)
             {
-                log_message(LOG_ERROR, "Backend connect failed immediately: %s", strerror(errno));
-                cleanup_connection(epoll_fd, conn);
+                log_message(LOG_INFO, "Connection closed during read: %s", strerror(errno));
+                cleanup_connection(reactor, conn);
                 return;
             }
-            log_message(LOG_INFO, "Backend connection in progress for fd: %d", conn->backend_fd);
+
+            // 클라이언트가 보내기만 끝냄 (half-close): 이미 받은 요청은 처리하고 응답을 보낸 뒤 닫음
+            conn->client_eof = 1;
+            break;
+        }
+
+        ring_buffer_produce(&conn->request, bytes_read);
+        connection_request_data(reactor, conn);
+
+        // 백엔드 연결 이후에 도착한 데이터는 바로 전달
+        if (conn->is_backend_connected)
+        {
+            flush_request_to_backend(reactor, conn);
+            if (conn->already_cleaned)
+                return;
         }
+    } while (reactor->edge_triggered);
+
+    // HTTP 요청이 완전히 수신되었는지 확인 (EOF 전에 요청 헤더를 다 받지 못했으면 정리)
+    if (conn->backend_fd == -1)
+    {
+        int ready = connection_request_ready(conn);
+        if (ready == HTTP_PARSE_DONE)
+            start_request(reactor, conn);
+        else if (ready == HTTP_PARSE_ERROR || conn->client_eof)
+            cleanup_connection(reactor, conn);
+    }
+}
+
+static void connect_backend(struct reactor *reactor, struct connection *conn,
+                            int opened, struct sockaddr_in *backend_addr);
+
+// 요청 헤더가 완성되면 백엔드 연결을 준비하고 요청 전달 시작
+static void start_request(struct reactor *reactor, struct connection *conn)
+{
+    struct sockaddr_in backend_addr;
+    int opened = connection_open_backend(reactor, conn, &backend_addr);
+    connect_backend(reactor, conn, opened, &backend_addr);
+}
+
+/**
+ * 백엔드가 응답하기 전에 실패한 경우 (connect 실패/timeout, 응답 전에 연결이 끊김)
+ * - 재시도할 수 있으면 실패한 백엔드 소켓을 닫고 다른 서버로 요청을 처음부터 다시 보냄
+ * - 그 외에는 connection 정리 (클라이언트 연결이 끊김)
+ */
+static void handle_backend_failure(struct reactor *reactor, struct connection *conn)
+{
+    if (!connection_backend_failed(reactor, conn))
+    {
+        cleanup_connection(reactor, conn);
+        return;
+    }
+
+    release_backend(reactor, conn);
+    conn->backend_events = 0;
 
-        struct epoll_event ev;
-        ev.events = EPOLLOUT | EPOLLIN; // 읽기와 쓰기 모두 모니터링
-        ev.data.ptr = conn;
-        if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, conn->backend_fd, &ev) < 0)
+    struct sockaddr_in backend_addr;
+    int opened = connection_retry_backend(conn, &backend_addr);
+    connect_backend(reactor, conn, opened, &backend_addr);
+}
+
+// connection_open_backend / connection_retry_backend로 준비한 백엔드 소켓에 연결하고 요청 전달 시작
+static void connect_backend(struct reactor *reactor, struct connection *conn,
+                            int opened, struct sockaddr_in *backend_addr)
+{
+    if (opened < 0)
+    {
+        cleanup_connection(reactor, conn);
+        return;
+    }
+    conn->backend_generation++; // 이전 backend_fd에서 남은 이벤트와 구분
+    connection_set_timeout(reactor, conn, opened == 1 ? PROXY_TIMEOUT_FIRST_BYTE : PROXY_TIMEOUT_CONNECT);
+
+    if (opened == 1)
+    {
+        // 풀에서 꺼낸 연결은 이미 연결되어 있으므로 바로 요청을 보내고, 남은 만큼만 이벤트 대기
+        conn->is_backend_connected = 1;
+        if (flush_request_to_backend(reactor, conn) < 0)
+            return;
+    }
+    else if (connect(conn->backend_fd, (struct sockaddr *)backend_addr, sizeof(*backend_addr)) < 0)
+    {
+        if (errno != EINPROGRESS)
         {
-            cleanup_connection(epoll_fd, conn);
+            log_message(LOG_ERROR, "Backend connect failed immediately: %s", strerror(errno));
+            handle_backend_failure(reactor, conn);
             return;
         }
     }
+
+    // 연결 완료(EPOLLOUT) 또는 응답 대기 (ET 모드에서는 이 등록이 backend_fd의 유일한 epoll_ctl)
+    uint32_t events = reactor->edge_triggered ? ET_EVENTS : backend_interest(conn);
+    if (connection_epoll_ctl(reactor, conn, EPOLL_CTL_ADD, conn->backend_fd, 1, events) < 0)
+    {
+        cleanup_connection(reactor, conn);
+        return;
+    }
+    conn->backend_events = events;
 }
 
-static void handle_backend_connect(int epoll_fd, struct connection *conn)
+/**
+ * 응답을 클라이언트로 모두 보낸 뒤 호출
+ * - 클라이언트가 연결 유지를 원하고 응답의 끝이 명확하면 백엔드 연결만 정리하고 다음 요청 대기
+ * - 이미 받아 둔 파이프라이닝 요청이 있으면 바로 이어서 처리
+ * - 그 외에는 connection 정리
+ */
+static void finish_request(struct reactor *reactor, struct connection *conn)
+{
+    if (!connection_keep_alive(conn))
+    {
+        cleanup_connection(reactor, conn);
+        return;
+    }
+
+    release_backend(reactor, conn);
+    release_pipe(reactor, conn);
+    conn->splice_active = 0;
+    conn->backend_events = 0;
+    if (connection_finish_request(conn) < 0)
+    {
+        cleanup_connection(reactor, conn);
+        return;
+    }
+    count_completed_request(reactor, conn);
+
+    // 파이프라이닝된 요청의 일부를 이미 받았으면 idle이 아니라 요청 헤더를 기다리는 중
+    connection_set_timeout(reactor, conn, ring_buffer_used(&conn->request) > 0 ? PROXY_TIMEOUT_HEADER : PROXY_TIMEOUT_IDLE);
+    int ready = connection_request_ready(conn);
+    if (ready == HTTP_PARSE_DONE)
+        start_request(reactor, conn);
+    else if (ready == HTTP_PARSE_ERROR || conn->client_eof)
+        cleanup_connection(reactor, conn); // half-close한 클라이언트는 받아 둔 요청을 모두 처리하면 닫음
+}
+
+// 클라이언트로부터 받은 데이터 중 아직 보내지 못한 부분을 백엔드로 전송
+// 소켓 버퍼가 가득 차면(EAGAIN) 남은 데이터는 backend_fd의 EPOLLOUT에서 이어서 전송
+// 요청 길이를 알면 현재 요청까지만 보내고, 뒤따라 온 다음 요청은 응답이 끝날 때까지 링에 남김
+// 백엔드로 보내지 못해서 다른 서버로 재시도했거나 connection을 정리했으면 -1 (호출하는 쪽은 이전 backend_fd 처리를 멈춤)
+static int flush_request_to_backend(struct reactor *reactor, struct connection *conn)
+{
+    size_t pending;
+    while ((pending = request_pending(conn)) > 0)
+    {
+        size_t len;
+        const char *data = connection_request_unsent(conn, &len);
+        if (len > pending)
+            len = pending;
+        ssize_t sent = send(conn->backend_fd, data, len, MSG_NOSIGNAL);
+        if (sent < 0)
+        {
+            if (errno == EAGAIN || errno == EWOULDBLOCK)
+            {
+                return 0;
+            }
+            log_message(LOG_ERROR, "Failed to send data to backend: %s", strerror(errno));
+            // send()가 소켓 오류를 이미 가져갔으므로 ET 모드에서는 EPOLLERR가 다시 오지 않을 수 있음
+            // 오류 이벤트를 기다리지 않고 바로 재시도하거나 정리
+            handle_backend_failure(reactor, conn);
+            return -1;
+        }
+        if (!conn->request_held)
+            ring_buffer_consume(&conn->request, sent);
+        conn->request_forwarded += sent;
+        connection_request_sent(reactor, conn);
+    }
+    return 0;
+}
+
+static void handle_backend_connect(struct reactor *reactor, struct connection *conn)
 {
-    log_message(LOG_INFO, "Checking backend connection status for fd: %d", conn->backend_fd);
     int error;
     socklen_t len = sizeof(error);
 
     // 연결 상태 확인
-    if (getsockopt(conn->backend_fd, SOL_SOCKET, SO_ERROR, &error, &len) < 0 || error != 0)
+    if (getsockopt(conn->backend_fd, SOL_SOCKET, SO_ERROR, &error, &len) < 0)
     {
         log_message(LOG_ERROR, "Failed to get socket error status: %s", strerror(errno));
-        cleanup_connection(epoll_fd, conn);
+        cleanup_connection(reactor, conn);
         return;
     }
 
     if (error != 0)
     {
         log_message(LOG_ERROR, "Backend connection failed with error: %s", strerror(error));
-        cleanup_connection(epoll_fd, conn);
+        handle_backend_failure(reactor, conn);
         return;
     }
 
-    log_message(LOG_INFO, "Backend connection established successfully for fd: %d", conn->backend_fd);
     conn->is_backend_connected = 1;
+    connection_set_timeout(reactor, conn, PROXY_TIMEOUT_FIRST_BYTE);
+
+    flush_request_to_backend(reactor, conn);
+}
 
-    // 클라이언트로부터 받은 데이터를 백엔드로 전송
-    size_t total_sent = 0;
-    while (total_sent < conn->bytes_received)
+// reactor의 파이프 풀에서 파이프 한 쌍을 가져옴 (없으면 새로 생성)
+static int acquire_pipe(struct reactor *reactor, struct connection *conn)
+{
+    if (reactor->pipe_pool_count > 0)
     {
-        ssize_t sent = send(conn->backend_fd,
-                            conn->buffer + total_sent,
-                            conn->bytes_received - total_sent,
-                            0);
-        if (sent < 0)
+        reactor->pipe_pool_count--;
+        conn->pipe_fds[0] = reactor->pipe_pool[reactor->pipe_pool_count][0];
+        conn->pipe_fds[1] = reactor->pipe_pool[reactor->pipe_pool_count][1];
+        return 0;
+    }
+
+    if (pipe2(conn->pipe_fds, O_NONBLOCK | O_CLOEXEC) < 0)
+    {
+        log_message(LOG_ERROR, "Failed to create splice pipe: %s", strerror(errno));
+        conn->pipe_fds[0] = conn->pipe_fds[1] = -1;
+        return -1;
+    }
+
+    // 파이프 용량을 청크 크기까지 늘려서 splice 호출 수를 줄임 (실패하면 기본 용량 사용)
+    fcntl(conn->pipe_fds[1], F_SETPIPE_SZ, CHUNK_SIZE);
+    return 0;
+}
+
+// 비어 있는 파이프는 풀로 돌려주고, 데이터가 남은 파이프는 닫음
+static void release_pipe(struct reactor *reactor, struct connection *conn)
+{
+    if (conn->pipe_fds[0] < 0)
+        return;
+
+    if (conn->pipe_bytes == 0 && reactor->pipe_pool_count < PIPE_POOL_SIZE)
+    {
+        reactor->pipe_pool[reactor->pipe_pool_count][0] = conn->pipe_fds[0];
+        reactor->pipe_pool[reactor->pipe_pool_count][1] = conn->pipe_fds[1];
+        reactor->pipe_pool_count++;
+    }
+    else
+    {
+        close(conn->pipe_fds[0]);
+        close(conn->pipe_fds[1]);
+    }
+    conn->pipe_fds[0] = conn->pipe_fds[1] = -1;
+    conn->pipe_bytes = 0;
+}
+
+/**
+ * splice()를 이용한 백엔드 → 클라이언트 응답 본문 중계
+ * - socket → pipe → socket 으로 옮기므로 데이터가 사용자 공간으로 복사되지 않음
+ * - 파이프를 먼저 비운 뒤에만 백엔드에서 읽으므로, 클라이언트가 느리면 백엔드 읽기도 멈춤
+ */
+static void handle_backend_splice(struct reactor *reactor, struct connection *conn)
+{
+    // ET 모드에서는 EAGAIN까지 계속 진행, LT 모드에서는 다른 connection을 위해 반복 횟수 제한
+    int max_iterations = reactor->edge_triggered ? INT_MAX : 50;
+    int iterations = 0;
+
+    while (iterations++ < max_iterations)
+    {
+        // 파이프에 남은 데이터를 먼저 클라이언트로 전달
+        while (conn->pipe_bytes > 0)
         {
-            if (errno == EAGAIN || errno == EWOULDBLOCK)
+            ssize_t moved = splice(conn->pipe_fds[0], NULL, conn->client_fd, NULL, conn->pipe_bytes,
+                                   SPLICE_F_MOVE | SPLICE_F_NONBLOCK);
+            if (moved < 0)
             {
-                // 아직 다 못보냈으니 EPOLLOUT | EPOLLIN 유지
-                conn->bytes_sent = total_sent;
+                if (errno == EAGAIN || errno == EWOULDBLOCK)
+                {
+                    // 클라이언트 EPOLLOUT에서 재개 (LT 모드는 그동안 백엔드 EPOLLIN을 뺌)
+                    return;
+                }
+                log_message(LOG_ERROR, "splice to client failed: %s", strerror(errno));
+                cleanup_connection(reactor, conn);
                 return;
             }
-            log_message(LOG_ERROR, "Failed to send data to backend: %s", strerror(errno));
-            cleanup_connection(epoll_fd, conn);
+            conn->pipe_bytes -= moved;
+        }
+
+        if (conn->backend_eof)
+        {
+            // 응답 끝 - 파이프의 데이터까지 모두 전달됨
+            finish_request(reactor, conn);
             return;
         }
-        total_sent += sent;
-    }
-    conn->bytes_sent = total_sent;
 
-    // 데이터를 모두 전송한 후에 EPOLLIN으로 변경
-    struct epoll_event ev;
-    ev.events = EPOLLIN;
-    ev.data.ptr = conn;
-    if (epoll_ctl(epoll_fd, EPOLL_CTL_MOD, conn->backend_fd, &ev) < 0)
-    {
-        log_message(LOG_ERROR, "Failed to modify backend socket events: %s", strerror(errno));
-        cleanup_connection(epoll_fd, conn);
-        return;
+        // 응답 길이를 알면 다음 응답의 데이터를 가져오지 않도록 남은 본문만큼만 옮김
+        size_t want = http_response_remaining(&conn->response_state);
+        if (want > CHUNK_SIZE)
+            want = CHUNK_SIZE;
+
+        // 파이프가 비어 있으므로 EAGAIN은 백엔드 소켓에 읽을 데이터가 없다는 의미
+        ssize_t moved = splice(conn->backend_fd, NULL, conn->pipe_fds[1], NULL, want,
+                               SPLICE_F_MOVE | SPLICE_F_NONBLOCK);
+        if (moved == 0)
+        {
+            connection_response_done(conn);
+            conn->backend_eof = 1;
+            continue;
+        }
+        if (moved < 0)
+        {
+            if (errno == EAGAIN || errno == EWOULDBLOCK)
+                return;
+            log_message(LOG_ERROR, "splice from backend failed: %s", strerror(errno));
+            cleanup_connection(reactor, conn);
+            return;
+        }
+        conn->pipe_bytes += moved;
+
+        http_response_feed(&conn->response_state, NULL, moved);
+        if (http_response_complete(&conn->response_state))
+        {
+            connection_response_done(conn);
+            conn->backend_eof = 1; // 응답 끝, 백엔드 연결은 정리할 때 풀에 반납
+        }
     }
 }
 
-static void handle_backend_read(int epoll_fd, struct connection *conn)
+// 응답 헤더가 모두 전달되었으면 splice 중계로 전환
+// chunked 본문은 청크 크기 줄을 읽어야 응답의 끝을 알 수 있으므로 복사 방식으로 계속 중계
+static int try_start_splice(struct reactor *reactor, struct connection *conn)
 {
-    char buffer[CHUNK_SIZE];
+    if (!reactor->splice_relay || !http_response_length_known(&conn->response_state) ||
+        ring_buffer_used(&conn->response) > 0)
+        return 0;
+    if (acquire_pipe(reactor, conn) < 0)
+        return 0; // 파이프를 만들 수 없으면 복사 방식으로 계속 진행
+
+    conn->splice_active = 1;
+    return 1;
+}
+
+/**
+ * 백엔드 → 클라이언트 응답 중계 (복사 방식)
+ * - 백엔드에서 response 링으로 읽고, 링에서 클라이언트로 전송
+ * - 클라이언트가 느려서 링이 가득 차면 백엔드 읽기를 멈추고, 클라이언트 EPOLLOUT에서 링을 비운 뒤 재개
+ * - 응답 헤더가 모두 전달되면 나머지 본문은 splice로 중계
+ */
+static void handle_backend_read(struct reactor *reactor, struct connection *conn)
+{
+    if (conn->splice_active)
+    {
+        handle_backend_splice(reactor, conn);
+        return;
+    }
 
-    int max_iterations = 50;
+    // ET 모드에서는 EAGAIN까지 모두 읽어야 하므로 반복 횟수 제한 없음
+    int max_iterations = reactor->edge_triggered ? INT_MAX : 50;
     int iterations = 0;
 
     while (iterations++ < max_iterations)
     {
-        ssize_t bytes_read = recv(conn->backend_fd, buffer, CHUNK_SIZE, 0);
+        // 링에 남은 응답을 먼저 클라이언트로 전송
+        int result = flush_response_to_client(conn);
+        if (result < 0)
+        {
+            cleanup_connection(reactor, conn);
+            return;
+        }
 
-        if (bytes_read == 0)
+        if (conn->backend_eof)
         {
-            // 정상적인 연결 종료 - 남은 데이터를 모두 전송
-            if (conn->write_buffer && conn->write_buffer_size > conn->write_buffer_sent)
-            {
-                handle_pending_write(epoll_fd, conn);
-            }
-            cleanup_connection(epoll_fd, conn);
+            // 응답 끝 - 링의 데이터까지 모두 전달한 뒤 다음 요청 대기 또는 정리
+            if (result == 1)
+                finish_request(reactor, conn);
             return;
         }
 
-        if (bytes_read < 0)
+        // 헤더까지 모두 전달되었으면 나머지 본문은 splice로 중계
+        if (result == 1 && try_start_splice(reactor, conn))
         {
-            if (errno == EAGAIN || errno == EWOULDBLOCK)
-            {
-                return;
-            }
-            // 에러 발생 시에도 남은 데이터 처리 시도
-            if (conn->write_buffer && conn->write_buffer_size > conn->write_buffer_sent)
-            {
-                handle_pending_write(epoll_fd, conn);
-            }
-            cleanup_connection(epoll_fd, conn);
+            handle_backend_splice(reactor, conn);
+            return;
+        }
+
+        if (ring_buffer_reserve(&conn->response, 1) < 0)
+        {
+            cleanup_connection(reactor, conn);
             return;
         }
 
-        // 클라이언트에게 전송
-        size_t total_sent = 0;
-        while (total_sent < bytes_read)
+        size_t space;
+        char *dst = ring_buffer_write_ptr(&conn->response, &space);
+        if (space == 0)
+        {
+            // 클라이언트가 링을 비울 때까지 백엔드 읽기를 멈춤
+            return;
+        }
+
+        ssize_t bytes_read = recv(conn->backend_fd, dst, space, 0);
+
+        // 응답을 하나도 보내지 않고 연결이 끊김 (닫힌 keep-alive 연결, 요청을 받다가 종료된 서버 등)
+        if (bytes_read == 0 && !conn->response_started)
+        {
+            handle_backend_failure(reactor, conn);
+            return;
+        }
+
+        if (bytes_read == 0)
+        {
+            connection_response_done(conn);
+            conn->backend_eof = 1;
+            continue;
+        }
+
+        if (bytes_read < 0)
         {
-            ssize_t sent = send(conn->client_fd,
-                                buffer + total_sent,
-                                bytes_read - total_sent,
-                                MSG_NOSIGNAL);
-
-            if (sent < 0)
+            if (errno == EAGAIN || errno == EWOULDBLOCK)
             {
-                if (errno == EAGAIN || errno == EWOULDBLOCK)
-                {
-                    // 보내지 못한 데이터를 저장
-                    size_t remaining = bytes_read - total_sent;
-                    char *pending_data = malloc(remaining);
-                    if (!pending_data)
-                    {
-                        cleanup_connection(epoll_fd, conn);
-                        return;
-                    }
-                    memcpy(pending_data, buffer + total_sent, remaining);
-
-                    if (conn->write_buffer)
-                    {
-                        free(conn->write_buffer);
-                    }
-                    conn->write_buffer = pending_data;
-                    conn->write_buffer_size = remaining;
-                    conn->write_buffer_sent = 0;
-
-                    struct epoll_event ev;
-                    ev.events = EPOLLIN | EPOLLOUT;
-                    ev.data.ptr = conn;
-                    if (epoll_ctl(epoll_fd, EPOLL_CTL_MOD, conn->client_fd, &ev) < 0)
-                    {
-                        cleanup_connection(epoll_fd, conn);
-                    }
-                    return;
-                }
-                cleanup_connection(epoll_fd, conn);
                 return;
             }
-            total_sent += sent;
+            log_message(LOG_ERROR, "Failed to read from backend: %s", strerror(errno));
+            handle_backend_failure(reactor, conn);
+            return;
         }
-    }
+        connection_response_data(reactor, conn);
 
-    if (iterations >= max_iterations)
-    {
-        struct epoll_event ev;
-        ev.events = EPOLLIN;
-        ev.data.ptr = conn;
-        if (epoll_ctl(epoll_fd, EPOLL_CTL_MOD, conn->backend_fd, &ev) < 0)
+        // 응답이 끝난 뒤에 온 데이터는 버림 (이 경우 연결은 재사용하지 않음)
+        size_t used = http_response_feed(&conn->response_state, dst, bytes_read);
+        ring_buffer_produce(&conn->response, used);
+        if (http_response_complete(&conn->response_state))
         {
-            cleanup_connection(epoll_fd, conn);
-            return;
+            connection_response_done(conn);
+            conn->backend_eof = 1; // 응답 끝, 백엔드 연결은 정리할 때 풀에 반납
         }
     }
 }
 
-static void handle_new_connection(int epoll_fd, int listen_fd)
+static void handle_new_connection(struct reactor *reactor)
 {
     struct sockaddr_in client_addr;
     socklen_t client_len = sizeof(client_addr);
 
-    int client_fd = accept(listen_fd, (struct sockaddr *)&client_addr, &client_len);
+    int client_fd = accept(reactor->listen_fd, (struct sockaddr *)&client_addr, &client_len);
     if (client_fd < 0)
     {
         return;
@@ -500,43 +1295,160 @@ static void handle_new_connection(int epoll_fd, int listen_fd)
     // 클라이언트 소켓 버퍼 크기 설정
     set_socket_buffer_size(client_fd);
 
-    struct connection *conn = create_connection(client_fd, client_addr);
+    struct connection *conn = create_connection(reactor, client_fd, client_addr);
     if (!conn)
     {
         log_message(LOG_ERROR, "Failed to create connection");
         close(client_fd);
         return;
     }
-    log_message(LOG_INFO, "Connection created successfully for fd: %d", client_fd);
+    uint32_t events = reactor->edge_triggered ? ET_EVENTS : client_interest(conn);
+    if (connection_epoll_ctl(reactor, conn, EPOLL_CTL_ADD, client_fd, 0, events) < 0)
+    {
+        connection_release(conn);
+        conn->generation++;
+        close(client_fd);
+        return;
+    }
+    conn->client_events = events;
+    connection_set_timeout(reactor, conn, PROXY_TIMEOUT_HEADER);
+    atomic_fetch_add_explicit(&reactor->open_connections, 1, memory_order_relaxed);
+}
 
-    struct epoll_event ev;
-    ev.events = EPOLLIN;
-    ev.data.ptr = conn;
+/**
+ * connection 소켓 이벤트 처리
+ * - is_backend: 이벤트가 발생한 소켓이 backend_fd인지 client_fd인지
+ * - LT/ET 모드 모두 같은 경로를 사용하며, 각 핸들러가 모드에 맞게 읽기/쓰기 범위를 결정
+ */
+static void dispatch_connection_event(struct reactor *reactor, struct connection *conn,
+                                      int is_backend, uint32_t events)
+{
+    if (events & EPOLLERR)
+    {
+        if (is_backend)
+            handle_backend_failure(reactor, conn);
+        else
+            cleanup_connection(reactor, conn);
+        return;
+    }
 
-    if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, client_fd, &ev) < 0)
+    if (!is_backend)
     {
-        free(conn->buffer);
-        free(conn);
-        close(client_fd);
+        // 양방향 모두 끊김 (EPOLLRDHUP만 있으면 half-close이므로 남은 요청을 읽고 응답은 계속 보냄)
+        if (events & EPOLLHUP)
+        {
+            cleanup_connection(reactor, conn);
+            return;
+        }
+
+        if (events & (EPOLLIN | EPOLLRDHUP))
+        {
+            handle_client_read(reactor, conn);
+        }
+
+        if (!conn->already_cleaned && (events & EPOLLOUT))
+        {
+            if (ring_buffer_used(&conn->response) > 0 || conn->pipe_bytes > 0)
+            {
+                // 링(또는 파이프)에 남은 응답을 보내고 백엔드 읽기 재개
+                handle_backend_read(reactor, conn);
+            }
+        }
+        return;
+    }
+
+    if (!conn->is_backend_connected)
+    {
+        if (events & (EPOLLOUT | EPOLLHUP))
+            handle_backend_connect(reactor, conn);
         return;
     }
 
-    log_message(LOG_INFO, "New connection from %s", inet_ntoa(client_addr.sin_addr));
+    if ((events & EPOLLOUT) && request_pending(conn) > 0)
+    {
+        if (flush_request_to_backend(reactor, conn) < 0)
+            return;
+    }
+
+    // 백엔드가 연결을 닫은 경우(EPOLLRDHUP/EPOLLHUP)에도 남은 응답을 끝까지 읽은 뒤 정리
+    if (!conn->already_cleaned && (events & (EPOLLIN | EPOLLRDHUP | EPOLLHUP)))
+    {
+        handle_backend_read(reactor, conn);
+    }
 }
 
-int run_proxy(int listen_port)
+static void handle_connection_event(struct reactor *reactor, struct connection *conn,
+                                    int is_backend, uint32_t events)
 {
-    // 백엔드 서버 초기화
-    init_backend_pool(&pool);
-    log_message(LOG_INFO, "Backend server pool initialized with %d servers", MAX_BACKENDS);
+    dispatch_connection_event(reactor, conn, is_backend, events);
+
+    // 백엔드로 요청이 전송되어 버퍼에 여유가 생겼으면 멈춰 두었던 클라이언트 읽기 재개
+    if (!conn->already_cleaned && conn->client_read_paused && !ring_buffer_full(&conn->request))
+    {
+        handle_client_read(reactor, conn);
+    }
+
+    if (!conn->already_cleaned && update_interest(reactor, conn) < 0)
+    {
+        cleanup_connection(reactor, conn);
+    }
+
+    // 다음 이벤트까지 비어 있는 버퍼는 풀에 반납
+    if (!conn->already_cleaned)
+    {
+        connection_trim_buffers(conn);
+    }
+}
+
+/**
+ * /metrics 응답 본문 (관리 포트를 처리하는 reactor 0에서 호출)
+ * - reactor는 이벤트 처리 중 online 상태이므로 현재 pool을 참조 없이 읽을 수 있음
+ * - 다른 reactor의 gauge는 각 reactor가 갱신하는 atomic 값을 읽기만 함
+ */
+static void render_metrics(struct metrics_output *out)
+{
+    metrics_render_backends(out, pool_rcu_current());
+
+    metrics_printf(out, "# HELP nginxx_open_connections Client connections open on the reactor.\n"
+                        "# TYPE nginxx_open_connections gauge\n");
+    for (int i = 0; i < metrics_reactors.count; i++)
+        metrics_printf(out, "nginxx_open_connections{reactor=\"%d\"} %ld\n", i,
+                       atomic_load_explicit(&metrics_reactors.reactors[i].open_connections, memory_order_relaxed));
+
+    metrics_printf(out, "# HELP nginxx_buffer_bytes Buffer memory held by the reactor "
+                        "(pool: connection ring buffers in use or cached, uring: io_uring provided buffers).\n"
+                        "# TYPE nginxx_buffer_bytes gauge\n");
+    for (int i = 0; i < metrics_reactors.count; i++)
+    {
+        struct reactor *reactor = &metrics_reactors.reactors[i];
+        metrics_printf(out, "nginxx_buffer_bytes{reactor=\"%d\",kind=\"pool\"} %zu\n", i,
+                       buffer_pool_allocated(&reactor->buffer_pool));
+        metrics_printf(out, "nginxx_buffer_bytes{reactor=\"%d\",kind=\"uring\"} %zu\n", i,
+                       atomic_load_explicit(&reactor->uring_buffer_bytes, memory_order_relaxed));
+    }
 
+    metrics_printf(out, "# HELP nginxx_log_dropped_records_total INFO log lines dropped because a thread's log buffer was full.\n"
+                        "# TYPE nginxx_log_dropped_records_total counter\n"
+                        "nginxx_log_dropped_records_total %lu\n",
+                   log_dropped_records());
+}
+
+// SO_REUSEPORT 리스닝 소켓 생성 (reactor마다 하나씩 생성하여 커널이 accept를 분산)
+static int create_listen_socket(int listen_port)
+{
     int listen_fd = socket(AF_INET, SOCK_STREAM, 0);
     if (listen_fd < 0)
-        return 1;
+        return -1;
 
     // 포트 번호 재사용 설정
     int reuse = 1;
     setsockopt(listen_fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+    if (setsockopt(listen_fd, SOL_SOCKET, SO_REUSEPORT, &reuse, sizeof(reuse)) < 0)
+    {
+        log_message(LOG_ERROR, "Failed to set SO_REUSEPORT: %s", strerror(errno));
+        close(listen_fd);
+        return -1;
+    }
 
     // listen_fd 비동기로 설정
     set_nonblocking(listen_fd);
@@ -550,36 +1462,78 @@ int run_proxy(int listen_port)
     if (bind(listen_fd, (struct sockaddr *)&listen_addr, sizeof(listen_addr)) < 0)
     {
         close(listen_fd);
-        return 1;
+        return -1;
     }
 
     if (listen(listen_fd, SOMAXCONN) < 0)
     {
         close(listen_fd);
-        return 1;
+        return -1;
+    }
+
+    return listen_fd;
+}
+
+// reactor 스레드를 코어에 고정 (코어 수보다 reactor가 많으면 순환 배치)
+static void pin_reactor_to_core(struct reactor *reactor)
+{
+    long ncpu = sysconf(_SC_NPROCESSORS_ONLN);
+    if (ncpu <= 0)
+        return;
+
+    cpu_set_t cpuset;
+    CPU_ZERO(&cpuset);
+    CPU_SET(reactor->id % ncpu, &cpuset);
+    if (pthread_setaffinity_np(pthread_self(), sizeof(cpuset), &cpuset) != 0)
+    {
+        log_message(LOG_ERROR, "Reactor %d: failed to pin to core %ld", reactor->id, reactor->id % ncpu);
     }
+}
+
+/**
+ * reactor 스레드 본체
+ * - 자신만의 리스닝 소켓, epoll 인스턴스, connection 집합을 소유
+ * - reactor 간에 공유되는 상태는 backend_pool의 카운터뿐
+ */
+static void *reactor_main(void *arg)
+{
+    struct reactor *reactor = (struct reactor *)arg;
 
-    // epoll 생성
-    int epoll_fd = epoll_create1(0);
-    if (epoll_fd < 0)
+    pin_reactor_to_core(reactor);
+
+    if (reactor->io_backend == IO_BACKEND_URING)
     {
-        close(listen_fd);
-        return 1;
+        if (uring_reactor_init(reactor) == 0)
+        {
+            uring_reactor_run(reactor);
+            buffer_pool_log_stats(&reactor->buffer_pool, reactor->id);
+            buffer_pool_destroy(&reactor->buffer_pool);
+            return NULL;
+        }
+        log_message(LOG_ERROR, "Reactor %d: io_uring unavailable, falling back to epoll", reactor->id);
     }
 
     // listen_fd를 epoll event에 추가 및 epoll event 설정
     struct epoll_event ev;
     ev.events = EPOLLIN; // Level Trigger 모드 사용
-    ev.data.fd = listen_fd;
+    ev.data.u64 = EVENT_LISTEN;
 
     // epoll 설정
-    if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, listen_fd, &ev) < 0)
+    if (epoll_ctl(reactor->epoll_fd, EPOLL_CTL_ADD, reactor->listen_fd, &ev) < 0)
     {
-        close(epoll_fd);
-        close(listen_fd);
-        return 1;
+        log_message(LOG_ERROR, "Reactor %d: failed to register listen socket: %s", reactor->id, strerror(errno));
+        return NULL;
     }
 
+    // 관리 포트는 이 reactor의 이벤트 루프에서 함께 처리
+    ev.events = EPOLLIN;
+    ev.data.u64 = EVENT_ADMIN;
+    if (reactor->admin && epoll_ctl(reactor->epoll_fd, EPOLL_CTL_ADD, admin_server_fd(reactor->admin), &ev) < 0)
+        log_message(LOG_ERROR, "Reactor %d: failed to register admin port: %s", reactor->id, strerror(errno));
+
+    log_message(LOG_INFO, "Reactor %d listening on port %d (%s)", reactor->id, reactor->listen_port,
+                reactor->edge_triggered ? "edge-triggered" : "level-triggered");
+
     struct epoll_event events[MAX_EVENTS];
     int running = 1;
 
@@ -592,7 +1546,11 @@ int run_proxy(int listen_port)
          */
 
         // 이벤트가 발생하기를 대기, 이벤트가 발생하면 events 배열에 저장하고 nfds에 이벤트 개수 저장
-        int nfds = epoll_wait(epoll_fd, events, MAX_EVENTS, -1);
+        // timeout이 걸린 connection이 있으면 가장 먼저 만료될 시각까지만 대기
+        // 기다리는 동안에는 backend_pool을 사용하지 않으므로 설정을 다시 읽는 쪽이 이 reactor를 기다리지 않음
+        pool_rcu_offline(reactor->id);
+        int nfds = epoll_wait(reactor->epoll_fd, events, MAX_EVENTS, connection_timeout_wait_ms(reactor));
+        pool_rcu_online(reactor->id);
         if (nfds < 0)
         {
             if (errno == EINTR)
@@ -605,56 +1563,404 @@ int run_proxy(int listen_port)
 
         for (int n = 0; n < nfds; n++)
         {
-            if (events[n].data.fd == listen_fd)
+            if (events[n].data.u64 == EVENT_LISTEN)
             {
                 // 새로운 연결 요청인 경우
-                handle_new_connection(epoll_fd, listen_fd);
+                handle_new_connection(reactor);
                 continue;
             }
-
-            // 기존에 연결되어있던 클라이언트의 경우 정보 가져오기
-            struct connection *conn = (struct connection *)events[n].data.ptr;
-            if (!conn || conn->already_cleaned)
+            if (events[n].data.u64 == EVENT_ADMIN)
             {
-                log_message(LOG_INFO, "Connection check - conn is null or already cleaned");
+                admin_server_poll(reactor->admin);
                 continue;
             }
 
-            if (events[n].events & (EPOLLERR | EPOLLHUP | EPOLLRDHUP))
-            {
-                cleanup_connection(epoll_fd, conn);
+            // 기존에 연결되어있던 클라이언트의 경우 정보 가져오기
+            uint64_t data = events[n].data.u64;
+            struct connection *conn = &connection_table[EVENT_SLOT(data)];
+            int is_backend = (data & EVENT_TAG_BACKEND) != 0;
+            uint32_t generation = is_backend ? conn->backend_generation : conn->generation;
+            if (generation != EVENT_GENERATION(data) || conn->already_cleaned)
                 continue;
-            }
 
-            if (events[n].events & EPOLLIN)
-            {
-                if (conn->backend_fd == -1)
-                {
-                    handle_client_read(epoll_fd, conn);
-                }
-                else if (!conn->already_cleaned)
-                {
-                    handle_backend_read(epoll_fd, conn);
-                }
-            }
+            handle_connection_event(reactor, conn, is_backend, events[n].events);
+        }
 
-            if (!conn->already_cleaned && (events[n].events & EPOLLOUT))
-            {
-                log_message(LOG_INFO, "Got EPOLLOUT event for fd: %d", events[n].events);
-                if (!conn->is_backend_connected)
-                {
-                    log_message(LOG_INFO, "Attempting to complete backend connection for fd: %d", conn->backend_fd);
-                    handle_backend_connect(epoll_fd, conn);
-                }
-                else if (conn->write_buffer && conn->write_buffer_size > conn->write_buffer_sent)
-                {
-                    handle_pending_write(epoll_fd, conn);
-                }
-            }
+        // timeout이 지난 connection 정리
+        struct connection *expired;
+        int kind;
+        while ((expired = connection_pop_timed_out(reactor, &kind)) != NULL)
+        {
+            if (kind == PROXY_TIMEOUT_CONNECT)
+                handle_backend_failure(reactor, expired);
+            else
+                cleanup_connection(reactor, expired);
+        }
+
+        // 이번 배치에서 정리된 connection의 client_fd를 닫아서 슬롯을 돌려줌
+        while (reactor->closed_connections)
+        {
+            struct connection *conn = reactor->closed_connections;
+            reactor->closed_connections = conn->next_closed;
+            close(conn->client_fd);
+            conn->client_fd = -1;
+            atomic_fetch_sub_explicit(&reactor->open_connections, 1, memory_order_relaxed);
+        }
+    }
+
+    for (int i = 0; i < reactor->pipe_pool_count; i++)
+    {
+        close(reactor->pipe_pool[i][0]);
+        close(reactor->pipe_pool[i][1]);
+    }
+    reactor->pipe_pool_count = 0;
+    pool_rcu_offline(reactor->id);
+
+    buffer_pool_log_stats(&reactor->buffer_pool, reactor->id);
+    buffer_pool_destroy(&reactor->buffer_pool);
+
+    log_message(LOG_INFO, "Reactor %d stopped", reactor->id);
+    return NULL;
+}
+
+void proxy_options_init(struct proxy_options *options)
+{
+    long ncpu = sysconf(_SC_NPROCESSORS_ONLN);
+
+    options->listen_port = DEFAULT_LISTEN_PORT;
+    options->num_reactors = ncpu > 0 ? (int)ncpu : 1;
+    options->edge_triggered = 0;
+    options->io_backend = IO_BACKEND_EPOLL;
+    options->splice_relay = 1;
+    options->timeout_ms[PROXY_TIMEOUT_CONNECT] = DEFAULT_CONNECT_TIMEOUT_MS;
+    options->timeout_ms[PROXY_TIMEOUT_HEADER] = DEFAULT_HEADER_TIMEOUT_MS;
+    options->timeout_ms[PROXY_TIMEOUT_IDLE] = DEFAULT_IDLE_TIMEOUT_MS;
+    options->timeout_ms[PROXY_TIMEOUT_FIRST_BYTE] = DEFAULT_FIRST_BYTE_TIMEOUT_MS;
+    options->max_retries = DEFAULT_MAX_RETRIES;
+    options->balancer = BALANCER_DEFAULT;
+    options->admin_port = 0;
+    strcpy(options->admin_address, ADMIN_DEFAULT_ADDRESS);
+    for (int i = 0; i < DEFAULT_BACKENDS; i++)
+        options->weights[i] = DEFAULT_BACKEND_WEIGHT;
+    options->config_path = NULL;
+    health_check_options_init(&options->health_check);
+}
+
+static const char *const timeout_names[PROXY_TIMEOUT_KINDS] = {
+    [PROXY_TIMEOUT_CONNECT] = "connect",
+    [PROXY_TIMEOUT_HEADER] = "header",
+    [PROXY_TIMEOUT_IDLE] = "idle",
+    [PROXY_TIMEOUT_FIRST_BYTE] = "first_byte",
+};
+
+const char *proxy_timeout_name(int kind)
+{
+    return kind >= 0 && kind < PROXY_TIMEOUT_KINDS ? timeout_names[kind] : "unknown";
+}
+
+int proxy_options_set_timeout(struct proxy_options *options, const char *spec)
+{
+    const char *eq = strchr(spec, '=');
+    if (!eq)
+        return -1;
+
+    char *end;
+    long value = strtol(eq + 1, &end, 10);
+    if (end == eq + 1 || *end != '\0' || value < 0 || value > INT_MAX)
+        return -1;
+
+    for (int kind = 0; kind < PROXY_TIMEOUT_KINDS; kind++)
+    {
+        size_t name_len = strlen(timeout_names[kind]);
+        if ((size_t)(eq - spec) == name_len && strncmp(spec, timeout_names[kind], name_len) == 0)
+        {
+            options->timeout_ms[kind] = (int)value;
+            return 0;
+        }
+    }
+    return -1;
+}
+
+int proxy_options_set_balancer(struct proxy_options *options, const char *name)
+{
+    if (strcmp(name, "default") == 0)
+        options->balancer = BALANCER_DEFAULT;
+    else if (strcmp(name, "p2c") == 0)
+        options->balancer = BALANCER_P2C;
+    else if (strcmp(name, "swrr") == 0)
+        options->balancer = BALANCER_SWRR;
+    else if (strcmp(name, "maglev-ip") == 0)
+        options->balancer = BALANCER_MAGLEV_CLIENT;
+    else if (strcmp(name, "maglev-uri") == 0)
+        options->balancer = BALANCER_MAGLEV_URI;
+    else
+        return -1;
+    return 0;
+}
+
+int proxy_options_set_weight(struct proxy_options *options, const char *spec)
+{
+    char *end;
+    long idx = strtol(spec, &end, 10);
+    if (end == spec || *end != '=' || idx < 0 || idx >= DEFAULT_BACKENDS)
+        return -1;
+
+    const char *value = end + 1;
+    long weight = strtol(value, &end, 10);
+    if (end == value || *end != '\0' || weight < 0 || weight > MAX_BACKEND_WEIGHT)
+        return -1;
+
+    options->weights[idx] = (int)weight;
+    return 0;
+}
+
+int proxy_options_set_admin(struct proxy_options *options, const char *spec)
+{
+    return admin_parse_listen(spec, options->admin_address, &options->admin_port);
+}
+
+// 설정 파일(없으면 기본 서버 구성)로 새 backend_pool을 만들고 선택 정책에 필요한 조회 테이블을 준비
+static struct backend_pool *create_backend_pool(const char *config_path, const int *weights)
+{
+    struct backend_pool *pool = malloc(sizeof(*pool));
+    if (!pool)
+        return NULL;
+
+    if (config_path)
+    {
+        if (load_backend_config(pool, config_path) < 0)
+        {
+            free(pool);
+            return NULL;
+        }
+    }
+    else
+    {
+        if (init_backend_pool(pool) < 0)
+        {
+            free(pool);
+            return NULL;
+        }
+        for (int i = 0; i < pool->server_count; i++)
+            set_server_weight(pool, i, weights[i]);
+    }
+
+    if (balancer == BALANCER_MAGLEV_CLIENT || balancer == BALANCER_MAGLEV_URI)
+    {
+        pool->maglev = malloc(sizeof(*pool->maglev));
+        if (!pool->maglev || maglev_build(pool->maglev, pool, -1) < 0)
+        {
+            cleanup_backend_pool(pool);
+            free(pool);
+            return NULL;
+        }
+    }
+    return pool;
+}
+
+/**
+ * 설정 파일을 다시 읽어 새 backend_pool로 교체
+ * - 새 pool을 따로 만들고 같은 서버의 헬스 상태를 이어받은 뒤 게시
+ * - 진행 중인 요청은 끝날 때까지 이전 pool의 서버를 사용하고, 마지막 요청이 끝나면 이전 pool이 해제됨
+ * - 파일에 문제가 있으면 지금의 pool을 그대로 사용
+ */
+static void reload_backend_pool(void)
+{
+    struct backend_pool *current = pool_rcu_current();
+    struct backend_pool *pool = create_backend_pool(reloader.config_path, NULL);
+    if (!pool)
+    {
+        log_message(LOG_ERROR, "Backend reload from %s failed, keeping %d servers",
+                    reloader.config_path, current->server_count);
+        return;
+    }
+    inherit_backend_state(pool, current);
+
+    struct backend_pool *old = pool_rcu_publish(pool);
+
+    // 헬스 체크 스레드가 이전 pool을 더 이상 보지 않도록 새 pool로 다시 시작한 뒤 게시 참조를 놓음
+    health_check_stop();
+    health_check_start(pool, &reloader.health_check);
+
+    log_message(LOG_INFO, "Backend config %s reloaded: %d servers (previous pool still serving %d requests)",
+                reloader.config_path, pool->server_count, atomic_load(&old->refs) - 1);
+    pool_rcu_release(old);
+}
+
+// SIGHUP은 다른 모든 스레드에서 막아 두고 이 스레드만 sigwait로 받음
+static void *reloader_main(void *arg)
+{
+    (void)arg;
+    sigset_t signals;
+    sigemptyset(&signals);
+    sigaddset(&signals, SIGHUP);
+
+    while (1)
+    {
+        int sig;
+        if (sigwait(&signals, &sig) != 0)
+            continue;
+        if (atomic_load(&reloader.stopping))
+            break;
+        log_message(LOG_INFO, "SIGHUP received, reloading backend config");
+        reload_backend_pool();
+    }
+    return NULL;
+}
+
+static int reloader_start(const struct proxy_options *options)
+{
+    reloader.config_path = options->config_path;
+    reloader.health_check = options->health_check;
+    atomic_store(&reloader.stopping, false);
+    if (pthread_create(&reloader.thread, NULL, reloader_main, NULL) != 0)
+    {
+        log_message(LOG_ERROR, "Failed to start backend config reload thread");
+        return -1;
+    }
+    return 0;
+}
+
+static void reloader_stop(void)
+{
+    atomic_store(&reloader.stopping, true);
+    pthread_kill(reloader.thread, SIGHUP);
+    pthread_join(reloader.thread, NULL);
+}
+
+int run_proxy(const struct proxy_options *options)
+{
+    // 설정 파일을 쓰면 SIGHUP을 reload 스레드에서만 받도록 이후에 만드는 모든 스레드에서 막음
+    // (막지 않으면 epoll_wait가 EINTR로 깨어난 reactor가 종료됨)
+    if (options->config_path)
+    {
+        sigset_t signals;
+        sigemptyset(&signals);
+        sigaddset(&signals, SIGHUP);
+        pthread_sigmask(SIG_BLOCK, &signals, NULL);
+    }
+
+    // 백엔드 서버 초기화
+    balancer = options->balancer;
+    struct backend_pool *pool = create_backend_pool(options->config_path, options->weights);
+    if (!pool)
+        return 1;
+    pool_rcu_publish(pool);
+    log_message(LOG_INFO, "Backend server pool initialized with %d servers%s%s", pool->server_count,
+                options->config_path ? " from " : "", options->config_path ? options->config_path : "");
+
+    if (balancer == BALANCER_P2C)
+        log_message(LOG_INFO, "Using power-of-two-choices balancer with peak EWMA latency");
+    else if (balancer == BALANCER_SWRR)
+        log_message(LOG_INFO, "Using smooth weighted round-robin balancer");
+    else if (balancer == BALANCER_MAGLEV_CLIENT || balancer == BALANCER_MAGLEV_URI)
+        log_message(LOG_INFO, "Using Maglev consistent hashing by %s (%d entries)",
+                    balancer == BALANCER_MAGLEV_CLIENT ? "client address" : "request URI", MAGLEV_TABLE_SIZE);
+
+    // 실제 요청이 실패하기 전에 죽은 서버를 찾도록 능동 헬스 체크 시작
+    if (health_check_start(pool, &options->health_check) < 0)
+        return 1;
+
+    if (connection_table_init() < 0)
+        return 1;
+
+    int num_reactors = options->num_reactors;
+    if (num_reactors < 1)
+        num_reactors = 1;
+    if (num_reactors > MAX_REACTORS)
+        num_reactors = MAX_REACTORS;
+    pool_rcu_init(num_reactors);
+
+    // 요청마다 보내 본 서버를 BACKEND_SET_MAX개까지만 기록하므로 재시도 횟수도 그 안으로 제한
+    int max_retries = options->max_retries;
+    if (max_retries > BACKEND_SET_MAX - 1)
+    {
+        log_message(LOG_INFO, "Retries limited to %d per request", BACKEND_SET_MAX - 1);
+        max_retries = BACKEND_SET_MAX - 1;
+    }
+
+    struct reactor *reactors = calloc(num_reactors, sizeof(struct reactor));
+    if (!reactors)
+        return 1;
+
+    // 관리 포트 (/metrics)는 reactor 0이 처리
+    struct admin_server *admin = NULL;
+    if (options->admin_port > 0)
+    {
+        metrics_reactors.reactors = reactors;
+        metrics_reactors.count = num_reactors;
+        admin = admin_server_create(options->admin_address, options->admin_port, render_metrics);
+        if (!admin)
+        {
+            health_check_stop();
+            free(reactors);
+            return 1;
+        }
+        reactors[0].admin = admin;
+    }
+
+    // 모든 reactor의 소켓을 먼저 준비한 뒤 스레드 시작
+    int started = 0;
+    for (int i = 0; i < num_reactors; i++)
+    {
+        struct reactor *reactor = &reactors[i];
+        reactor->id = i;
+        reactor->listen_port = options->listen_port;
+        reactor->edge_triggered = options->edge_triggered;
+        reactor->io_backend = options->io_backend;
+        reactor->splice_relay = options->splice_relay;
+        memcpy(reactor->timeout_ms, options->timeout_ms, sizeof(reactor->timeout_ms));
+        reactor->max_retries = max_retries;
+        timer_wheel_init(&reactor->timers, monotonic_ms());
+        buffer_pool_init(&reactor->buffer_pool);
+
+        reactor->listen_fd = create_listen_socket(options->listen_port);
+        if (reactor->listen_fd < 0)
+        {
+            log_message(LOG_ERROR, "Reactor %d: failed to create listen socket: %s", i, strerror(errno));
+            break;
+        }
+
+        // epoll 생성
+        reactor->epoll_fd = epoll_create1(0);
+        if (reactor->epoll_fd < 0)
+        {
+            close(reactor->listen_fd);
+            break;
+        }
+
+        if (pthread_create(&reactor->thread, NULL, reactor_main, reactor) != 0)
+        {
+            close(reactor->epoll_fd);
+            close(reactor->listen_fd);
+            break;
         }
+        started++;
+    }
+
+    if (started == 0)
+    {
+        health_check_stop();
+        admin_server_destroy(admin);
+        free(reactors);
+        return 1;
+    }
+    log_message(LOG_INFO, "Started %d reactor threads", started);
+
+    int reloading = options->config_path && reloader_start(options) == 0;
+
+    for (int i = 0; i < started; i++)
+    {
+        pthread_join(reactors[i].thread, NULL);
+        close(reactors[i].epoll_fd);
+        close(reactors[i].listen_fd);
     }
+    if (reloading)
+        reloader_stop();
+    health_check_stop();
+    pool_rcu_release(pool_rcu_current());
 
-    close(epoll_fd);
-    close(listen_fd);
+    admin_server_destroy(admin);
+    free(reactors);
     return 0;
-}
\ No newline at end of file
+}
@@ -0,0 +1,149 @@
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <time.h>
+#include <sys/socket.h>
+#include "upstream_pool.h"
+#include "../utils/logger.h"
+
+static long long now_ms(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+// 잠금을 잡은 상태에서 만료된 연결을 배열에서 빼고 닫을 fd 목록에 추가
+static int take_expired(struct upstream_pool *pool, long long now, int *expired)
+{
+    int n = 0;
+    while (n < pool->count && now - pool->idle[n].idle_since_ms > UPSTREAM_IDLE_TIMEOUT_MS)
+    {
+        expired[n] = pool->idle[n].fd;
+        n++;
+    }
+    if (n > 0)
+    {
+        memmove(&pool->idle[0], &pool->idle[n], sizeof(pool->idle[0]) * (pool->count - n));
+        pool->count -= n;
+    }
+    return n;
+}
+
+static void close_expired(struct upstream_pool *pool, const int *expired, int n)
+{
+    for (int i = 0; i < n; i++)
+        close(expired[i]);
+    if (n > 0)
+        atomic_fetch_add(&pool->closed_expired, n);
+}
+
+// idle 상태의 연결이 아직 쓸 수 있는지 확인 (백엔드가 닫았거나 요청하지 않은 데이터가 와 있으면 버림)
+static int is_alive(int fd)
+{
+    char c;
+    ssize_t n = recv(fd, &c, 1, MSG_PEEK | MSG_DONTWAIT);
+    return n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK);
+}
+
+void upstream_pool_init(struct upstream_pool *pool)
+{
+    pthread_mutex_init(&pool->lock, NULL);
+    pool->count = 0;
+    atomic_init(&pool->reused, 0);
+    atomic_init(&pool->created, 0);
+    atomic_init(&pool->returned, 0);
+    atomic_init(&pool->closed_stale, 0);
+    atomic_init(&pool->closed_expired, 0);
+    atomic_init(&pool->closed_full, 0);
+}
+
+void upstream_pool_destroy(struct upstream_pool *pool)
+{
+    pthread_mutex_lock(&pool->lock);
+    for (int i = 0; i < pool->count; i++)
+        close(pool->idle[i].fd);
+    pool->count = 0;
+    pthread_mutex_unlock(&pool->lock);
+    pthread_mutex_destroy(&pool->lock);
+}
+
+int upstream_pool_checkout(struct upstream_pool *pool)
+{
+    int expired[UPSTREAM_POOL_SIZE];
+
+    while (1)
+    {
+        pthread_mutex_lock(&pool->lock);
+        int n = take_expired(pool, now_ms(), expired);
+        int fd = -1;
+        if (pool->count > 0)
+        {
+            pool->count--;
+            fd = pool->idle[pool->count].fd;
+        }
+        pthread_mutex_unlock(&pool->lock);
+
+        close_expired(pool, expired, n);
+        if (fd < 0)
+            return -1;
+
+        if (is_alive(fd))
+        {
+            atomic_fetch_add(&pool->reused, 1);
+            return fd;
+        }
+        close(fd);
+        atomic_fetch_add(&pool->closed_stale, 1);
+    }
+}
+
+void upstream_pool_note_created(struct upstream_pool *pool)
+{
+    atomic_fetch_add(&pool->created, 1);
+}
+
+void upstream_pool_checkin(struct upstream_pool *pool, int fd)
+{
+    int expired[UPSTREAM_POOL_SIZE];
+    long long now = now_ms();
+
+    pthread_mutex_lock(&pool->lock);
+    int n = take_expired(pool, now, expired);
+    int stored = 0;
+    if (pool->count < UPSTREAM_POOL_SIZE)
+    {
+        pool->idle[pool->count].fd = fd;
+        pool->idle[pool->count].idle_since_ms = now;
+        pool->count++;
+        stored = 1;
+    }
+    pthread_mutex_unlock(&pool->lock);
+
+    close_expired(pool, expired, n);
+    if (stored)
+    {
+        atomic_fetch_add(&pool->returned, 1);
+    }
+    else
+    {
+        close(fd);
+        atomic_fetch_add(&pool->closed_full, 1);
+    }
+}
+
+void upstream_pool_log_stats(struct upstream_pool *pool, const char *address, int port)
+{
+    pthread_mutex_lock(&pool->lock);
+    int idle = pool->count;
+    pthread_mutex_unlock(&pool->lock);
+
+    unsigned long reused = atomic_load(&pool->reused);
+    unsigned long created = atomic_load(&pool->created);
+    log_message(LOG_INFO, "Upstream pool %s:%d - idle: %d, reused: %lu, created: %lu (reuse rate %.1f%%), "
+                          "returned: %lu, closed stale: %lu, expired: %lu, full: %lu",
+                address, port, idle, reused, created,
+                reused + created ? 100.0 * reused / (reused + created) : 0.0,
+                atomic_load(&pool->returned), atomic_load(&pool->closed_stale),
+                atomic_load(&pool->closed_expired), atomic_load(&pool->closed_full));
+}
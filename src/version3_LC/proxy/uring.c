@@ -0,0 +1,1221 @@
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <stdint.h>
+#include <poll.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <arpa/inet.h>
+#include <linux/io_uring.h>
+#include <linux/time_types.h>
+#include "connection.h"
+#include "pool_rcu.h"
+#include "admin.h"
+#include "../utils/logger.h"
+
+/*
+ * io_uring 기반 I/O 백엔드
+ * - epoll 백엔드와 같은 struct connection 생명주기(요청 수신 → 백엔드 선택/연결 → 요청 전달 → 응답 중계 → 정리)를 사용
+ * - multishot accept, provided buffer ring 기반 recv, 백엔드 connect+send 링크, 루프당 한 번의 일괄 제출
+ * - connection별 timeout은 reactor의 타이머 휠로 관리하고, 완료 대기 시간(EXT_ARG)을 가장 빠른 만료까지로 제한
+ * - liburing 없이 io_uring_setup/io_uring_enter/io_uring_register 시스템 콜을 직접 사용
+ */
+
+#define URING_ENTRIES 1024
+#define URING_BUF_GROUP 0
+#define URING_BUF_COUNT 128 // 2의 거듭제곱
+#define URING_BUF_SIZE (64 * 1024)
+#define URING_QUEUE_LIMIT (URING_BUF_COUNT / 4) // connection 한 방향이 붙잡을 수 있는 최대 버퍼 수
+
+// user_data 하위 4비트에 작업 종류를 기록 (connection은 캐시 라인 단위로 정렬되어 할당됨)
+#define URING_OP_MASK 15ULL
+
+enum uring_op
+{
+    URING_OP_NONE = 0,
+    URING_OP_ACCEPT,
+    URING_OP_CLIENT_RECV,
+    URING_OP_CONNECT,
+    URING_OP_REQUEST_SEND,
+    URING_OP_BACKEND_RECV,
+    URING_OP_RESPONSE_SEND,
+    URING_OP_CANCEL,
+    URING_OP_ADMIN, // 관리 포트 epoll 인스턴스의 poll (connection 없음)
+};
+
+struct uring
+{
+    int ring_fd;
+
+    // SQ 링
+    unsigned *sq_head;
+    unsigned *sq_tail;
+    unsigned sq_mask;
+    unsigned sq_entries;
+    unsigned *sq_array;
+    struct io_uring_sqe *sqes;
+    unsigned sqe_tail;   // 아직 커널에 공개하지 않은 SQE를 포함한 tail
+    unsigned sqe_submit; // 마지막으로 제출한 tail
+
+    // CQ 링
+    unsigned *cq_head;
+    unsigned *cq_tail;
+    unsigned cq_mask;
+    struct io_uring_cqe *cqes;
+
+    void *sq_ring_ptr;
+    size_t sq_ring_size;
+    void *cq_ring_ptr;
+    size_t cq_ring_size;
+    size_t sqes_size;
+
+    // provided buffer ring
+    struct io_uring_buf_ring *buf_ring;
+    size_t buf_ring_size;
+    char *buf_base;
+    uint32_t buf_len[URING_BUF_COUNT]; // 수신된 데이터 길이 (버퍼 id별)
+    uint16_t buf_tail;
+    int buffers_returned;
+
+    // 버퍼 부족(ENOBUFS)으로 recv를 다시 걸지 못한 connection 목록
+    struct uring_connection *starved;
+
+    unsigned long enter_calls;
+    unsigned long completed_requests;
+};
+
+// 한 방향(클라이언트→백엔드 또는 백엔드→클라이언트)으로 보낼 provided buffer 큐
+struct uring_queue
+{
+    uint16_t bids[URING_BUF_COUNT];
+    unsigned head;
+    unsigned tail;
+    uint32_t offset; // head 버퍼에서 이미 전송한 바이트 수
+    int send_inflight;
+    int recv_armed;
+    int recv_starved;
+};
+
+struct uring_connection
+{
+    struct connection base;
+
+    int inflight; // 완료되지 않은 SQE 수, 0이 되어야 해제 가능
+    int closing;
+    int backend_eof;
+    int in_starved_list;
+    struct uring_connection *next_starved;
+    int connect_inflight;
+    int retry_pending; // 실패한 백엔드 fd의 작업이 모두 완료되면 다른 서버로 재시도
+
+    // request 링 앞쪽 중 현재 요청에 속해 아직 백엔드로 보내지 않은 바이트 수 (그 뒤는 파이프라이닝된 다음 요청)
+    size_t ring_pending;
+    // 현재 요청 중 백엔드로 보내기 위해 넘긴 바이트 수 (request 링 + 제공 버퍼 큐)
+    unsigned long long request_queued;
+
+    struct uring_queue to_backend;
+    struct uring_queue to_client;
+
+    struct sockaddr_in backend_addr; // connect SQE가 완료될 때까지 유지
+};
+
+static void uring_close_connection(struct reactor *reactor, struct uring_connection *uc);
+static void uring_finalize_if_done(struct reactor *reactor, struct uring_connection *uc);
+static void uring_finish_request(struct reactor *reactor, struct uring_connection *uc);
+static void uring_close_fd(struct uring *u, int fd);
+
+static int sys_io_uring_setup(unsigned entries, struct io_uring_params *p)
+{
+    return (int)syscall(__NR_io_uring_setup, entries, p);
+}
+
+static int sys_io_uring_enter(int fd, unsigned to_submit, unsigned min_complete, unsigned flags,
+                              void *arg, size_t argsz)
+{
+    return (int)syscall(__NR_io_uring_enter, fd, to_submit, min_complete, flags, arg, argsz);
+}
+
+static int sys_io_uring_register(int fd, unsigned opcode, void *arg, unsigned nr_args)
+{
+    return (int)syscall(__NR_io_uring_register, fd, opcode, arg, nr_args);
+}
+
+static void uring_free(struct uring *u)
+{
+    if (u->buf_base)
+        free(u->buf_base);
+    if (u->buf_ring)
+        munmap(u->buf_ring, u->buf_ring_size);
+    if (u->sqes)
+        munmap(u->sqes, u->sqes_size);
+    if (u->cq_ring_ptr && u->cq_ring_ptr != u->sq_ring_ptr)
+        munmap(u->cq_ring_ptr, u->cq_ring_size);
+    if (u->sq_ring_ptr)
+        munmap(u->sq_ring_ptr, u->sq_ring_size);
+    if (u->ring_fd >= 0)
+        close(u->ring_fd);
+    free(u);
+}
+
+// provided buffer를 링에 돌려줌
+static void uring_buf_recycle(struct uring *u, uint16_t bid)
+{
+    struct io_uring_buf *buf = &u->buf_ring->bufs[u->buf_tail & (URING_BUF_COUNT - 1)];
+    buf->addr = (uint64_t)(uintptr_t)(u->buf_base + (size_t)bid * URING_BUF_SIZE);
+    buf->len = URING_BUF_SIZE;
+    buf->bid = bid;
+    u->buf_tail++;
+    __atomic_store_n(&u->buf_ring->tail, u->buf_tail, __ATOMIC_RELEASE);
+    u->buffers_returned = 1;
+}
+
+static int uring_setup_buffers(struct uring *u)
+{
+    u->buf_ring_size = URING_BUF_COUNT * sizeof(struct io_uring_buf);
+    u->buf_ring = mmap(NULL, u->buf_ring_size, PROT_READ | PROT_WRITE,
+                       MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (u->buf_ring == MAP_FAILED)
+    {
+        u->buf_ring = NULL;
+        return -1;
+    }
+
+    u->buf_base = malloc((size_t)URING_BUF_COUNT * URING_BUF_SIZE);
+    if (!u->buf_base)
+        return -1;
+
+    struct io_uring_buf_reg reg;
+    memset(&reg, 0, sizeof(reg));
+    reg.ring_addr = (uint64_t)(uintptr_t)u->buf_ring;
+    reg.ring_entries = URING_BUF_COUNT;
+    reg.bgid = URING_BUF_GROUP;
+    if (sys_io_uring_register(u->ring_fd, IORING_REGISTER_PBUF_RING, &reg, 1) < 0)
+        return -1;
+
+    u->buf_tail = 0;
+    for (uint16_t bid = 0; bid < URING_BUF_COUNT; bid++)
+        uring_buf_recycle(u, bid);
+    u->buffers_returned = 0;
+    return 0;
+}
+
+static int uring_setup(struct uring *u)
+{
+    struct io_uring_params params;
+    memset(&params, 0, sizeof(params));
+    params.flags = IORING_SETUP_SINGLE_ISSUER | IORING_SETUP_COOP_TASKRUN;
+
+    u->ring_fd = sys_io_uring_setup(URING_ENTRIES, &params);
+    if (u->ring_fd < 0 && errno == EINVAL)
+    {
+        // 오래된 커널: 최적화 플래그 없이 재시도
+        memset(&params, 0, sizeof(params));
+        u->ring_fd = sys_io_uring_setup(URING_ENTRIES, &params);
+    }
+    if (u->ring_fd < 0)
+        return -1;
+
+    u->sq_ring_size = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    u->cq_ring_size = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+    if (params.features & IORING_FEAT_SINGLE_MMAP)
+    {
+        if (u->cq_ring_size > u->sq_ring_size)
+            u->sq_ring_size = u->cq_ring_size;
+        u->cq_ring_size = u->sq_ring_size;
+    }
+
+    u->sq_ring_ptr = mmap(NULL, u->sq_ring_size, PROT_READ | PROT_WRITE,
+                          MAP_SHARED | MAP_POPULATE, u->ring_fd, IORING_OFF_SQ_RING);
+    if (u->sq_ring_ptr == MAP_FAILED)
+    {
+        u->sq_ring_ptr = NULL;
+        return -1;
+    }
+
+    if (params.features & IORING_FEAT_SINGLE_MMAP)
+    {
+        u->cq_ring_ptr = u->sq_ring_ptr;
+    }
+    else
+    {
+        u->cq_ring_ptr = mmap(NULL, u->cq_ring_size, PROT_READ | PROT_WRITE,
+                              MAP_SHARED | MAP_POPULATE, u->ring_fd, IORING_OFF_CQ_RING);
+        if (u->cq_ring_ptr == MAP_FAILED)
+        {
+            u->cq_ring_ptr = NULL;
+            return -1;
+        }
+    }
+
+    u->sqes_size = params.sq_entries * sizeof(struct io_uring_sqe);
+    u->sqes = mmap(NULL, u->sqes_size, PROT_READ | PROT_WRITE,
+                   MAP_SHARED | MAP_POPULATE, u->ring_fd, IORING_OFF_SQES);
+    if (u->sqes == MAP_FAILED)
+    {
+        u->sqes = NULL;
+        return -1;
+    }
+
+    char *sq = u->sq_ring_ptr;
+    u->sq_head = (unsigned *)(sq + params.sq_off.head);
+    u->sq_tail = (unsigned *)(sq + params.sq_off.tail);
+    u->sq_mask = *(unsigned *)(sq + params.sq_off.ring_mask);
+    u->sq_entries = *(unsigned *)(sq + params.sq_off.ring_entries);
+    u->sq_array = (unsigned *)(sq + params.sq_off.array);
+    u->sqe_tail = *u->sq_tail;
+    u->sqe_submit = u->sqe_tail;
+
+    char *cq = u->cq_ring_ptr;
+    u->cq_head = (unsigned *)(cq + params.cq_off.head);
+    u->cq_tail = (unsigned *)(cq + params.cq_off.tail);
+    u->cq_mask = *(unsigned *)(cq + params.cq_off.ring_mask);
+    u->cqes = (struct io_uring_cqe *)(cq + params.cq_off.cqes);
+
+    return uring_setup_buffers(u);
+}
+
+/**
+ * 쌓인 SQE를 커널에 제출하고 min_complete개의 완료를 대기
+ * - 이벤트 루프 한 바퀴 동안 만든 SQE를 한 번의 io_uring_enter로 일괄 제출
+ * - wait_ms >= 0이면 그 시간까지만 대기 (완료 없이 시간이 지나면 errno ETIME)
+ */
+static int uring_submit_and_wait(struct uring *u, unsigned min_complete, int wait_ms)
+{
+    unsigned to_submit = u->sqe_tail - u->sqe_submit;
+    __atomic_store_n(u->sq_tail, u->sqe_tail, __ATOMIC_RELEASE);
+
+    unsigned flags = min_complete ? IORING_ENTER_GETEVENTS : 0;
+    struct __kernel_timespec ts;
+    struct io_uring_getevents_arg arg;
+    void *argp = NULL;
+    size_t argsz = 0;
+    if (min_complete && wait_ms >= 0)
+    {
+        ts.tv_sec = wait_ms / 1000;
+        ts.tv_nsec = (wait_ms % 1000) * 1000000LL;
+        memset(&arg, 0, sizeof(arg));
+        arg.ts = (uint64_t)(uintptr_t)&ts;
+        flags |= IORING_ENTER_EXT_ARG;
+        argp = &arg;
+        argsz = sizeof(arg);
+    }
+
+    u->enter_calls++;
+    int ret = sys_io_uring_enter(u->ring_fd, to_submit, min_complete, flags, argp, argsz);
+    if (ret >= 0)
+        u->sqe_submit += ret;
+    return ret;
+}
+
+static struct io_uring_sqe *uring_get_sqe(struct uring *u)
+{
+    unsigned head = __atomic_load_n(u->sq_head, __ATOMIC_ACQUIRE);
+    if (u->sqe_tail - head >= u->sq_entries)
+    {
+        // SQ가 가득 찬 경우 먼저 제출해서 자리를 확보
+        uring_submit_and_wait(u, 0, -1);
+        head = __atomic_load_n(u->sq_head, __ATOMIC_ACQUIRE);
+        if (u->sqe_tail - head >= u->sq_entries)
+            return NULL;
+    }
+
+    unsigned idx = u->sqe_tail & u->sq_mask;
+    struct io_uring_sqe *sqe = &u->sqes[idx];
+    memset(sqe, 0, sizeof(*sqe));
+    u->sq_array[idx] = idx;
+    u->sqe_tail++;
+    return sqe;
+}
+
+static uint64_t uring_user_data(struct uring_connection *uc, enum uring_op op)
+{
+    return (uint64_t)(uintptr_t)uc | op;
+}
+
+// connection에 속한 SQE 준비 (완료될 때까지 inflight로 집계)
+static struct io_uring_sqe *uring_conn_sqe(struct reactor *reactor, struct uring_connection *uc,
+                                           enum uring_op op)
+{
+    struct io_uring_sqe *sqe = uring_get_sqe(reactor->uring);
+    if (!sqe)
+        return NULL;
+    sqe->user_data = uring_user_data(uc, op);
+    uc->inflight++;
+    return sqe;
+}
+
+// 관리 포트에 처리할 이벤트가 생기면 완료되는 일회성 poll
+static int uring_arm_admin(struct reactor *reactor)
+{
+    struct io_uring_sqe *sqe = uring_get_sqe(reactor->uring);
+    if (!sqe)
+        return -1;
+    sqe->opcode = IORING_OP_POLL_ADD;
+    sqe->fd = admin_server_fd(reactor->admin);
+    sqe->poll32_events = POLLIN;
+    sqe->user_data = URING_OP_ADMIN;
+    return 0;
+}
+
+static int uring_arm_accept(struct reactor *reactor)
+{
+    struct io_uring_sqe *sqe = uring_get_sqe(reactor->uring);
+    if (!sqe)
+        return -1;
+    sqe->opcode = IORING_OP_ACCEPT;
+    sqe->fd = reactor->listen_fd;
+    sqe->accept_flags = SOCK_CLOEXEC;
+    sqe->ioprio = IORING_ACCEPT_MULTISHOT;
+    sqe->user_data = URING_OP_ACCEPT;
+    return 0;
+}
+
+// 한 방향의 recv 등록 (provided buffer ring에서 커널이 버퍼를 고름)
+static void uring_arm_recv(struct reactor *reactor, struct uring_connection *uc, int from_backend)
+{
+    struct uring_queue *queue = from_backend ? &uc->to_client : &uc->to_backend;
+    if (uc->closing || queue->recv_armed || queue->recv_starved)
+        return;
+
+    // 응답을 끝까지 받았으면 백엔드 recv를 더 등록하지 않음 (keep-alive 연결은 풀에 반납)
+    if (from_backend && uc->backend_eof)
+        return;
+    if (!from_backend && uc->base.client_eof)
+        return;
+
+    // 상대편이 아직 가져가지 않은 버퍼가 많으면 recv를 멈춰서 backpressure 적용
+    if (queue->tail - queue->head >= URING_QUEUE_LIMIT)
+        return;
+
+    // 응답을 기다리는 동안 받은 다음 요청은 request 링에 보관하므로, 링에 버퍼 하나를 더 담을 여유가 있을 때만 수신
+    if (!from_backend && uc->base.backend_fd >= 0 &&
+        ring_buffer_used(&uc->base.request) + URING_BUF_SIZE > REQUEST_RING_SIZE)
+        return;
+
+    enum uring_op op = from_backend ? URING_OP_BACKEND_RECV : URING_OP_CLIENT_RECV;
+    struct io_uring_sqe *sqe = uring_conn_sqe(reactor, uc, op);
+    if (!sqe)
+    {
+        uring_close_connection(reactor, uc);
+        return;
+    }
+    sqe->opcode = IORING_OP_RECV;
+    sqe->fd = from_backend ? uc->base.backend_fd : uc->base.client_fd;
+    sqe->flags = IOSQE_BUFFER_SELECT;
+    sqe->buf_group = URING_BUF_GROUP;
+    if (from_backend)
+    {
+        // 응답 길이를 알면 다음 응답의 데이터를 가져오지 않도록 남은 본문만큼만 수신
+        size_t remaining = http_response_remaining(&uc->base.response_state);
+        if (remaining < URING_BUF_SIZE)
+            sqe->len = (uint32_t)remaining;
+    }
+    queue->recv_armed = 1;
+}
+
+// 큐의 다음 데이터를 전송 (한 방향에 send는 항상 하나만 진행해서 순서를 보장)
+static void uring_kick_send(struct reactor *reactor, struct uring_connection *uc, int to_backend)
+{
+    struct uring_queue *queue = to_backend ? &uc->to_backend : &uc->to_client;
+    if (uc->closing || queue->send_inflight)
+        return;
+    if (to_backend && !uc->base.is_backend_connected)
+        return;
+
+    const char *data;
+    size_t len;
+    if (to_backend && uc->ring_pending > 0)
+    {
+        // 헤더와 함께 수신한 요청 데이터
+        data = connection_request_unsent(&uc->base, &len);
+        if (len > uc->ring_pending)
+            len = uc->ring_pending;
+    }
+    else if (queue->head != queue->tail)
+    {
+        uint16_t bid = queue->bids[queue->head & (URING_BUF_COUNT - 1)];
+        data = reactor->uring->buf_base + (size_t)bid * URING_BUF_SIZE + queue->offset;
+        len = reactor->uring->buf_len[bid] - queue->offset;
+    }
+    else
+    {
+        return;
+    }
+
+    struct io_uring_sqe *sqe = uring_conn_sqe(reactor, uc, to_backend ? URING_OP_REQUEST_SEND : URING_OP_RESPONSE_SEND);
+    if (!sqe)
+    {
+        uring_close_connection(reactor, uc);
+        return;
+    }
+    sqe->opcode = IORING_OP_SEND;
+    sqe->fd = to_backend ? uc->base.backend_fd : uc->base.client_fd;
+    sqe->addr = (uint64_t)(uintptr_t)data;
+    sqe->len = (uint32_t)len;
+    sqe->msg_flags = MSG_NOSIGNAL;
+    queue->send_inflight = 1;
+}
+
+// 백엔드 연결 시작: connect와 첫 요청 전송을 링크해서 한 번에 제출
+// keep-alive 풀에서 꺼낸 연결이면 connect 없이 바로 요청 전송과 응답 수신을 등록
+static void uring_connect_backend(struct reactor *reactor, struct uring_connection *uc, int opened);
+
+static void uring_start_backend(struct reactor *reactor, struct uring_connection *uc)
+{
+    int opened = connection_open_backend(reactor, &uc->base, &uc->backend_addr);
+
+    // request 링 중 현재 요청에 속하는 부분 (나머지는 파이프라이닝된 다음 요청)
+    size_t used = ring_buffer_used(&uc->base.request);
+    if (uc->base.request_length >= 0 && (unsigned long long)uc->base.request_length < used)
+        used = (size_t)uc->base.request_length;
+    uc->ring_pending = used;
+    uc->request_queued = used;
+
+    uring_connect_backend(reactor, uc, opened);
+}
+
+// 실패한 백엔드 fd의 작업이 모두 끝났으면 닫고 다른 서버로 요청을 처음부터 다시 보냄
+static void uring_retry_if_ready(struct reactor *reactor, struct uring_connection *uc)
+{
+    if (!uc->retry_pending || uc->connect_inflight || uc->to_backend.send_inflight || uc->to_client.recv_armed)
+        return;
+    uc->retry_pending = 0;
+    uc->backend_eof = 0;
+    uc->to_client.recv_starved = 0;
+
+    uring_close_fd(reactor->uring, uc->base.backend_fd);
+    uc->base.backend_fd = -1;
+
+    // 재시도하는 요청은 전체가 request 링에 남아 있음
+    uc->ring_pending = (size_t)uc->base.request_length;
+    int opened = connection_retry_backend(&uc->base, &uc->backend_addr);
+    uring_connect_backend(reactor, uc, opened);
+}
+
+/**
+ * 백엔드가 응답하기 전에 실패한 경우 (connect 실패/timeout, 응답 전에 연결이 끊김)
+ * - 재시도할 수 있으면 실패한 백엔드 fd에 남은 작업을 취소하고, 모두 완료된 뒤 다른 서버로 다시 보냄
+ * - 그 외에는 connection 정리
+ */
+static void uring_backend_failed(struct reactor *reactor, struct uring_connection *uc)
+{
+    if (!connection_backend_failed(reactor, &uc->base))
+    {
+        uring_close_connection(reactor, uc);
+        return;
+    }
+
+    uc->retry_pending = 1;
+    connection_clear_timeout(reactor, &uc->base);
+    if (uc->connect_inflight || uc->to_backend.send_inflight || uc->to_client.recv_armed)
+    {
+        struct io_uring_sqe *sqe = uring_conn_sqe(reactor, uc, URING_OP_CANCEL);
+        if (!sqe)
+        {
+            uring_close_connection(reactor, uc);
+            return;
+        }
+        sqe->opcode = IORING_OP_ASYNC_CANCEL;
+        sqe->fd = uc->base.backend_fd;
+        sqe->cancel_flags = IORING_ASYNC_CANCEL_FD | IORING_ASYNC_CANCEL_ALL;
+    }
+    uring_retry_if_ready(reactor, uc);
+}
+
+// 백엔드 연결 시작 (connection_open_backend / connection_retry_backend의 결과에 따라)
+static void uring_connect_backend(struct reactor *reactor, struct uring_connection *uc, int opened)
+{
+    if (opened < 0)
+    {
+        uring_close_connection(reactor, uc);
+        return;
+    }
+    connection_set_timeout(reactor, &uc->base, opened == 1 ? PROXY_TIMEOUT_FIRST_BYTE : PROXY_TIMEOUT_CONNECT);
+
+    if (opened == 1)
+    {
+        uc->base.is_backend_connected = 1;
+        uring_kick_send(reactor, uc, 1);
+        uring_arm_recv(reactor, uc, 1);
+        return;
+    }
+
+    struct io_uring_sqe *sqe = uring_conn_sqe(reactor, uc, URING_OP_CONNECT);
+    if (!sqe)
+    {
+        uring_close_connection(reactor, uc);
+        return;
+    }
+    sqe->opcode = IORING_OP_CONNECT;
+    sqe->fd = uc->base.backend_fd;
+    sqe->addr = (uint64_t)(uintptr_t)&uc->backend_addr;
+    sqe->off = sizeof(uc->backend_addr);
+    sqe->flags = IOSQE_IO_LINK;
+    uc->connect_inflight = 1;
+
+    sqe = uring_conn_sqe(reactor, uc, URING_OP_REQUEST_SEND);
+    if (!sqe)
+    {
+        uring_close_connection(reactor, uc);
+        return;
+    }
+    sqe->opcode = IORING_OP_SEND;
+    sqe->fd = uc->base.backend_fd;
+    size_t len;
+    const char *data = connection_request_unsent(&uc->base, &len);
+    if (len > uc->ring_pending)
+        len = uc->ring_pending;
+    sqe->addr = (uint64_t)(uintptr_t)data;
+    sqe->len = (uint32_t)len;
+    sqe->msg_flags = MSG_NOSIGNAL;
+    uc->to_backend.send_inflight = 1;
+}
+
+static void uring_add_starved(struct uring *u, struct uring_connection *uc)
+{
+    if (uc->in_starved_list)
+        return;
+    uc->in_starved_list = 1;
+    uc->next_starved = u->starved;
+    u->starved = uc;
+}
+
+// 버퍼가 반환되었으면 ENOBUFS로 멈췄던 recv를 다시 등록
+static void uring_rearm_starved(struct reactor *reactor)
+{
+    struct uring *u = reactor->uring;
+    if (!u->buffers_returned)
+        return;
+    u->buffers_returned = 0;
+
+    struct uring_connection *list = u->starved;
+    u->starved = NULL;
+    while (list)
+    {
+        struct uring_connection *uc = list;
+        list = uc->next_starved;
+        uc->in_starved_list = 0;
+        uc->next_starved = NULL;
+
+        if (uc->to_backend.recv_starved)
+        {
+            uc->to_backend.recv_starved = 0;
+            uring_arm_recv(reactor, uc, 0);
+        }
+        if (uc->to_client.recv_starved)
+        {
+            uc->to_client.recv_starved = 0;
+            uring_arm_recv(reactor, uc, 1);
+        }
+        uring_finalize_if_done(reactor, uc);
+    }
+}
+
+static void uring_queue_release(struct uring *u, struct uring_queue *queue)
+{
+    while (queue->head != queue->tail)
+    {
+        uring_buf_recycle(u, queue->bids[queue->head & (URING_BUF_COUNT - 1)]);
+        queue->head++;
+    }
+}
+
+static void uring_close_fd(struct uring *u, int fd)
+{
+    struct io_uring_sqe *sqe = uring_get_sqe(u);
+    if (!sqe)
+    {
+        close(fd);
+        return;
+    }
+    sqe->opcode = IORING_OP_CLOSE;
+    sqe->fd = fd;
+    sqe->user_data = URING_OP_NONE;
+}
+
+// 요청 하나가 끝날 때마다 reactor 통계 갱신 (로그는 BUFFER_POOL_STATS_INTERVAL 요청마다 한 번)
+static void uring_count_completed_request(struct reactor *reactor)
+{
+    struct uring *u = reactor->uring;
+    u->completed_requests++;
+    if (u->completed_requests % BUFFER_POOL_STATS_INTERVAL == 0)
+    {
+        log_message(LOG_INFO, "io_uring_enter calls per request (reactor %d average over %lu requests): %.2f",
+                    reactor->id, u->completed_requests, (double)u->enter_calls / u->completed_requests);
+        buffer_pool_log_stats(&reactor->buffer_pool, reactor->id);
+        log_upstream_pool_stats();
+    }
+}
+
+// 진행 중인 작업이 모두 끝난 connection 해제
+static void uring_finalize_connection(struct reactor *reactor, struct uring_connection *uc)
+{
+    struct uring *u = reactor->uring;
+
+    uring_queue_release(u, &uc->to_backend);
+    uring_queue_release(u, &uc->to_client);
+
+    // close도 링으로 제출해서 다음 io_uring_enter에 함께 처리
+    if (uc->base.backend_fd >= 0)
+        uring_close_fd(u, uc->base.backend_fd);
+    if (uc->base.client_fd >= 0)
+    {
+        uring_close_fd(u, uc->base.client_fd);
+        atomic_fetch_sub_explicit(&reactor->open_connections, 1, memory_order_relaxed);
+    }
+    uc->base.backend_fd = -1;
+    uc->base.client_fd = -1;
+
+    // 요청 처리 중이 아니었던 idle connection은 통계에서 제외
+    int request_in_progress = uc->base.server_idx >= 0;
+    connection_release(&uc->base);
+    if (request_in_progress)
+        uring_count_completed_request(reactor);
+
+    if (uc->in_starved_list)
+    {
+        struct uring_connection **pp = &u->starved;
+        while (*pp && *pp != uc)
+            pp = &(*pp)->next_starved;
+        if (*pp)
+            *pp = uc->next_starved;
+    }
+    free(uc);
+}
+
+/**
+ * connection 정리 시작
+ * - 진행 중인 SQE가 있으면 fd 기준으로 모두 취소
+ * - 실제 해제는 진행 중인 SQE가 모두 완료된 뒤 uring_finalize_if_done에서 수행
+ */
+static void uring_close_connection(struct reactor *reactor, struct uring_connection *uc)
+{
+    if (!uc->closing)
+    {
+        uc->closing = 1;
+        uc->base.already_cleaned = 1;
+        connection_clear_timeout(reactor, &uc->base);
+
+        // 응답을 끝까지 받은 keep-alive 연결은 백엔드 fd에 진행 중인 작업이 없을 때 풀에 반납
+        if (connection_backend_reusable(&uc->base) &&
+            !uc->to_backend.send_inflight && !uc->to_client.recv_armed)
+        {
+            connection_checkin_backend(&uc->base);
+        }
+
+        int fds[2] = {uc->base.client_fd, uc->base.backend_fd};
+        for (int i = 0; i < 2 && uc->inflight > 0; i++)
+        {
+            if (fds[i] < 0)
+                continue;
+            struct io_uring_sqe *sqe = uring_conn_sqe(reactor, uc, URING_OP_CANCEL);
+            if (!sqe)
+                break;
+            sqe->opcode = IORING_OP_ASYNC_CANCEL;
+            sqe->fd = fds[i];
+            sqe->cancel_flags = IORING_ASYNC_CANCEL_FD | IORING_ASYNC_CANCEL_ALL;
+        }
+    }
+}
+
+// 정리 중인 connection의 진행 중인 작업이 모두 끝났으면 해제
+static void uring_finalize_if_done(struct reactor *reactor, struct uring_connection *uc)
+{
+    if (uc->closing && uc->inflight == 0)
+        uring_finalize_connection(reactor, uc);
+}
+
+static void uring_handle_accept(struct reactor *reactor, struct io_uring_cqe *cqe)
+{
+    if (!(cqe->flags & IORING_CQE_F_MORE))
+    {
+        // multishot accept가 종료된 경우 다시 등록
+        if (uring_arm_accept(reactor) < 0)
+            log_message(LOG_ERROR, "Reactor %d: failed to re-arm accept", reactor->id);
+    }
+
+    if (cqe->res < 0)
+    {
+        log_message(LOG_ERROR, "Accept failed: %s", strerror(-cqe->res));
+        return;
+    }
+
+    int client_fd = cqe->res;
+    struct sockaddr_in client_addr;
+    socklen_t client_len = sizeof(client_addr);
+    memset(&client_addr, 0, sizeof(client_addr));
+    getpeername(client_fd, (struct sockaddr *)&client_addr, &client_len);
+
+    // 클라이언트 소켓 버퍼 크기 설정
+    set_socket_buffer_size(client_fd);
+
+    // struct connection이 캐시 라인 단위로 정렬되어 있으므로 aligned_alloc 사용
+    struct uring_connection *uc = aligned_alloc(_Alignof(struct uring_connection), sizeof(struct uring_connection));
+    if (uc)
+        memset(uc, 0, sizeof(*uc));
+    if (!uc || connection_init(&uc->base, &reactor->buffer_pool, client_fd, client_addr) < 0)
+    {
+        log_message(LOG_ERROR, "Failed to create connection");
+        free(uc);
+        close(client_fd);
+        return;
+    }
+    atomic_fetch_add_explicit(&reactor->open_connections, 1, memory_order_relaxed);
+
+    connection_set_timeout(reactor, &uc->base, PROXY_TIMEOUT_HEADER);
+    uring_arm_recv(reactor, uc, 0);
+}
+
+// 응답을 기다리는 동안 도착한 다음 요청의 데이터를 request 링 뒤쪽에 보관
+static int uring_store_pipelined(struct uring_connection *uc, const char *data, size_t len)
+{
+    while (len > 0)
+    {
+        if (ring_buffer_reserve(&uc->base.request, len) < 0)
+            return -1;
+        size_t space;
+        char *dst = ring_buffer_write_ptr(&uc->base.request, &space);
+        if (space == 0)
+            return -1;
+        if (space > len)
+            space = len;
+        memcpy(dst, data, space);
+        ring_buffer_produce(&uc->base.request, space);
+        data += space;
+        len -= space;
+    }
+    return 0;
+}
+
+/**
+ * recv 완료 처리
+ * - 백엔드 연결 전: 요청 버퍼에 누적하고 헤더가 완성되면 백엔드 연결 시작
+ * - 백엔드 연결 후: 수신한 provided buffer를 그대로 상대편 send 큐에 넣음 (복사 없음)
+ *   현재 요청의 끝을 넘는 클라이언트 데이터는 다음 요청이므로 request 링에 복사해 둠
+ */
+static void uring_handle_recv(struct reactor *reactor, struct uring_connection *uc,
+                              struct io_uring_cqe *cqe, int from_backend)
+{
+    struct uring *u = reactor->uring;
+    struct uring_queue *queue = from_backend ? &uc->to_client : &uc->to_backend;
+    queue->recv_armed = 0;
+
+    if (from_backend && uc->retry_pending)
+    {
+        // 실패 처리 중인 백엔드 fd의 recv가 끝남
+        if (cqe->res > 0 && (cqe->flags & IORING_CQE_F_BUFFER))
+            uring_buf_recycle(u, cqe->flags >> IORING_CQE_BUFFER_SHIFT);
+        uring_retry_if_ready(reactor, uc);
+        return;
+    }
+
+    if (cqe->res == -ENOBUFS)
+    {
+        queue->recv_starved = 1;
+        uring_add_starved(u, uc);
+        return;
+    }
+
+    if (cqe->res <= 0)
+    {
+        // 응답을 하나도 보내지 않고 연결이 끊김 (닫힌 keep-alive 연결, 요청을 받다가 종료된 서버 등)
+        if (from_backend && (cqe->res < 0 || !uc->base.response_started))
+        {
+            if (cqe->res < 0)
+                log_message(LOG_ERROR, "Failed to read from backend: %s", strerror(-cqe->res));
+            uring_backend_failed(reactor, uc);
+            return;
+        }
+        if (from_backend && cqe->res == 0)
+        {
+            // 정상적인 연결 종료 - 남은 데이터를 모두 전송한 뒤 정리
+            connection_response_done(&uc->base);
+            uc->backend_eof = 1;
+            if (!uc->to_client.send_inflight && uc->to_client.head == uc->to_client.tail)
+                uring_finish_request(reactor, uc);
+            return;
+        }
+        if (!from_backend && cqe->res == 0 && uc->base.backend_fd >= 0)
+        {
+            // 요청을 보낸 뒤 클라이언트가 보내기만 끝냄 (half-close): 응답을 보낸 뒤 닫음
+            uc->base.client_eof = 1;
+            return;
+        }
+        if (cqe->res < 0)
+            log_message(LOG_INFO, "Connection closed during read: %s", strerror(-cqe->res));
+        uring_close_connection(reactor, uc);
+        return;
+    }
+
+    uint16_t bid = cqe->flags >> IORING_CQE_BUFFER_SHIFT;
+    size_t len = (size_t)cqe->res;
+
+    if (!from_backend && uc->base.backend_fd == -1)
+    {
+        // 요청 헤더 수신 중: 요청 버퍼에 누적
+        if (connection_reserve(&uc->base, len) < 0)
+        {
+            uring_buf_recycle(u, bid);
+            uring_close_connection(reactor, uc);
+            return;
+        }
+        size_t space;
+        char *dst = ring_buffer_write_ptr(&uc->base.request, &space);
+        memcpy(dst, u->buf_base + (size_t)bid * URING_BUF_SIZE, len);
+        ring_buffer_produce(&uc->base.request, len);
+        uring_buf_recycle(u, bid);
+        connection_request_data(reactor, &uc->base);
+
+        int ready = connection_request_ready(&uc->base);
+        if (ready == HTTP_PARSE_ERROR)
+        {
+            uring_close_connection(reactor, uc);
+            return;
+        }
+        if (ready == HTTP_PARSE_DONE)
+            uring_start_backend(reactor, uc);
+        uring_arm_recv(reactor, uc, 0);
+        return;
+    }
+
+    if (from_backend)
+    {
+        connection_response_data(reactor, &uc->base);
+
+        // 응답이 끝난 뒤에 온 데이터는 버림 (이 경우 연결은 재사용하지 않음)
+        len = http_response_feed(&uc->base.response_state, u->buf_base + (size_t)bid * URING_BUF_SIZE, len);
+        if (http_response_complete(&uc->base.response_state))
+        {
+            connection_response_done(&uc->base);
+            uc->backend_eof = 1;
+        }
+        if (len == 0)
+        {
+            uring_buf_recycle(u, bid);
+            if (uc->backend_eof && !uc->to_client.send_inflight && uc->to_client.head == uc->to_client.tail)
+                uring_finish_request(reactor, uc);
+            return;
+        }
+    }
+    else if (uc->base.request_length >= 0)
+    {
+        unsigned long long remaining = (unsigned long long)uc->base.request_length - uc->request_queued;
+        if (len > remaining)
+        {
+            const char *extra = u->buf_base + (size_t)bid * URING_BUF_SIZE + remaining;
+            if (uring_store_pipelined(uc, extra, len - (size_t)remaining) < 0)
+            {
+                uring_buf_recycle(u, bid);
+                uring_close_connection(reactor, uc);
+                return;
+            }
+            len = (size_t)remaining;
+        }
+        uc->request_queued += len;
+        if (len == 0)
+        {
+            uring_buf_recycle(u, bid);
+            uring_arm_recv(reactor, uc, 0);
+            return;
+        }
+    }
+
+    u->buf_len[bid] = (uint32_t)len;
+    queue->bids[queue->tail & (URING_BUF_COUNT - 1)] = bid;
+    queue->tail++;
+
+    uring_kick_send(reactor, uc, !from_backend);
+    uring_arm_recv(reactor, uc, from_backend);
+}
+
+static void uring_handle_send(struct reactor *reactor, struct uring_connection *uc,
+                              struct io_uring_cqe *cqe, int to_backend)
+{
+    struct uring *u = reactor->uring;
+    struct uring_queue *queue = to_backend ? &uc->to_backend : &uc->to_client;
+    queue->send_inflight = 0;
+
+    if (to_backend && uc->retry_pending)
+    {
+        // 실패 처리 중인 백엔드 fd로의 전송이 끝남 (connect 실패로 취소된 링크 포함)
+        uring_retry_if_ready(reactor, uc);
+        return;
+    }
+
+    if (cqe->res < 0)
+    {
+        log_message(LOG_ERROR, "Failed to send data to %s: %s",
+                    to_backend ? "backend" : "client", strerror(-cqe->res));
+        if (to_backend)
+            uring_backend_failed(reactor, uc);
+        else
+            uring_close_connection(reactor, uc);
+        return;
+    }
+
+    size_t sent = (size_t)cqe->res;
+    if (to_backend)
+    {
+        uc->base.request_forwarded += sent;
+        connection_request_sent(reactor, &uc->base);
+    }
+    if (to_backend && uc->ring_pending > 0)
+    {
+        // 재시도에 대비해 남겨 두는 요청은 응답이 시작될 때 한 번에 제거
+        if (!uc->base.request_held)
+            ring_buffer_consume(&uc->base.request, sent);
+        uc->ring_pending -= sent;
+        // 헤더와 함께 받은 요청을 모두 보냈으면 버퍼를 풀에 반납 (이후 요청 본문은 제공 버퍼로 중계)
+        ring_buffer_trim(&uc->base.request);
+    }
+    else if (queue->head != queue->tail)
+    {
+        uint16_t bid = queue->bids[queue->head & (URING_BUF_COUNT - 1)];
+        queue->offset += sent;
+        if (queue->offset >= u->buf_len[bid])
+        {
+            queue->offset = 0;
+            queue->head++;
+            uring_buf_recycle(u, bid);
+        }
+    }
+
+    uring_kick_send(reactor, uc, to_backend);
+
+    // 큐에 여유가 생겼으므로 멈춰 두었던 recv 재개
+    uring_arm_recv(reactor, uc, !to_backend);
+
+    if (!to_backend && uc->backend_eof && !queue->send_inflight && queue->head == queue->tail)
+        uring_finish_request(reactor, uc);
+}
+
+/**
+ * 응답을 클라이언트로 모두 보낸 뒤 호출
+ * - 클라이언트 연결을 유지할 수 있으면 백엔드 연결만 반납(또는 닫기)하고 다음 요청 대기
+ * - 이미 받아 둔 파이프라이닝 요청이 있으면 바로 이어서 처리
+ * - 그 외에는 connection 정리
+ */
+static void uring_finish_request(struct reactor *reactor, struct uring_connection *uc)
+{
+    struct connection *conn = &uc->base;
+
+    // 백엔드 fd에 진행 중인 작업이 남아 있으면 다음 요청으로 넘어갈 수 없으므로 정리
+    if (!connection_keep_alive(conn) || uc->to_backend.send_inflight || uc->to_client.recv_armed ||
+        uc->to_backend.head != uc->to_backend.tail)
+    {
+        uring_close_connection(reactor, uc);
+        return;
+    }
+
+    if (connection_backend_reusable(conn))
+        connection_checkin_backend(conn);
+    else
+        uring_close_fd(reactor->uring, conn->backend_fd);
+
+    if (connection_finish_request(conn) < 0)
+    {
+        uring_close_connection(reactor, uc);
+        return;
+    }
+    uc->backend_eof = 0;
+    uc->ring_pending = 0;
+    uc->request_queued = 0;
+    uring_count_completed_request(reactor);
+
+    // 파이프라이닝된 요청의 일부를 이미 받았으면 idle이 아니라 요청 헤더를 기다리는 중
+    connection_set_timeout(reactor, conn, ring_buffer_used(&conn->request) > 0 ? PROXY_TIMEOUT_HEADER : PROXY_TIMEOUT_IDLE);
+    int ready = connection_request_ready(conn);
+    if (ready == HTTP_PARSE_ERROR || (ready != HTTP_PARSE_DONE && conn->client_eof))
+    {
+        uring_close_connection(reactor, uc); // half-close한 클라이언트는 받아 둔 요청을 모두 처리하면 닫음
+        return;
+    }
+    if (ready == HTTP_PARSE_DONE)
+        uring_start_backend(reactor, uc);
+    uring_arm_recv(reactor, uc, 0);
+}
+
+static void uring_handle_connect(struct reactor *reactor, struct uring_connection *uc, struct io_uring_cqe *cqe)
+{
+    uc->connect_inflight = 0;
+    if (uc->retry_pending)
+    {
+        // connect timeout으로 취소됨
+        uring_retry_if_ready(reactor, uc);
+        return;
+    }
+
+    if (cqe->res < 0)
+    {
+        log_message(LOG_ERROR, "Backend connection failed with error: %s", strerror(-cqe->res));
+        uring_backend_failed(reactor, uc);
+        return;
+    }
+
+    uc->base.is_backend_connected = 1;
+    connection_set_timeout(reactor, &uc->base, PROXY_TIMEOUT_FIRST_BYTE);
+    uring_arm_recv(reactor, uc, 1);
+}
+
+static void uring_handle_cqe(struct reactor *reactor, struct io_uring_cqe *cqe)
+{
+    enum uring_op op = (enum uring_op)(cqe->user_data & URING_OP_MASK);
+    struct uring_connection *uc = (struct uring_connection *)(uintptr_t)(cqe->user_data & ~URING_OP_MASK);
+
+    if (op == URING_OP_NONE)
+        return;
+    if (op == URING_OP_ACCEPT)
+    {
+        uring_handle_accept(reactor, cqe);
+        return;
+    }
+    if (op == URING_OP_ADMIN)
+    {
+        admin_server_poll(reactor->admin);
+        if (uring_arm_admin(reactor) < 0)
+            log_message(LOG_ERROR, "Reactor %d: failed to re-arm admin port poll", reactor->id);
+        return;
+    }
+
+    uc->inflight--;
+
+    if (uc->closing)
+    {
+        // 정리 중에 완료된 recv가 가져간 버퍼는 바로 반환
+        if (cqe->res > 0 && (cqe->flags & IORING_CQE_F_BUFFER))
+            uring_buf_recycle(reactor->uring, cqe->flags >> IORING_CQE_BUFFER_SHIFT);
+        uring_finalize_if_done(reactor, uc);
+        return;
+    }
+
+    switch (op)
+    {
+    case URING_OP_CLIENT_RECV:
+        uring_handle_recv(reactor, uc, cqe, 0);
+        break;
+    case URING_OP_BACKEND_RECV:
+        uring_handle_recv(reactor, uc, cqe, 1);
+        break;
+    case URING_OP_CONNECT:
+        uring_handle_connect(reactor, uc, cqe);
+        break;
+    case URING_OP_REQUEST_SEND:
+        uring_handle_send(reactor, uc, cqe, 1);
+        break;
+    case URING_OP_RESPONSE_SEND:
+        uring_handle_send(reactor, uc, cqe, 0);
+        break;
+    default:
+        break;
+    }
+
+    uring_finalize_if_done(reactor, uc);
+}
+
+/**
+ * reactor에서 사용할 io_uring 준비
+ * - IORING_SETUP_SINGLE_ISSUER를 사용하므로 반드시 링을 사용할 reactor 스레드에서 호출
+ *
+ * 반환값:
+ * - 성공: 0
+ * - 실패: -1 (커널이 io_uring 또는 provided buffer ring을 지원하지 않음, epoll로 대체)
+ */
+int uring_reactor_init(struct reactor *reactor)
+{
+    struct uring *u = calloc(1, sizeof(struct uring));
+    if (!u)
+        return -1;
+    u->ring_fd = -1;
+
+    if (uring_setup(u) < 0)
+    {
+        log_message(LOG_ERROR, "Reactor %d: io_uring setup failed: %s", reactor->id, strerror(errno));
+        uring_free(u);
+        return -1;
+    }
+
+    reactor->uring = u;
+    atomic_store_explicit(&reactor->uring_buffer_bytes, (size_t)URING_BUF_COUNT * URING_BUF_SIZE,
+                          memory_order_relaxed);
+    return 0;
+}
+
+// io_uring 이벤트 루프 (uring_reactor_init 성공 후 같은 스레드에서 호출)
+void uring_reactor_run(struct reactor *reactor)
+{
+    struct uring *u = reactor->uring;
+
+    if (uring_arm_accept(reactor) < 0)
+    {
+        log_message(LOG_ERROR, "Reactor %d: failed to register accept", reactor->id);
+        uring_free(u);
+        reactor->uring = NULL;
+        atomic_store_explicit(&reactor->uring_buffer_bytes, 0, memory_order_relaxed);
+        return;
+    }
+
+    if (reactor->admin && uring_arm_admin(reactor) < 0)
+        log_message(LOG_ERROR, "Reactor %d: failed to register admin port poll", reactor->id);
+
+    log_message(LOG_INFO, "Reactor %d listening on port %d (io_uring)", reactor->id, reactor->listen_port);
+
+    int running = 1;
+    while (running)
+    {
+        // 이전 바퀴에서 만든 SQE를 모두 제출하고 최소 하나의 완료를 대기 (가장 빠른 timeout까지만)
+        // 기다리는 동안에는 backend_pool을 사용하지 않으므로 설정을 다시 읽는 쪽이 이 reactor를 기다리지 않음
+        pool_rcu_offline(reactor->id);
+        int ret = uring_submit_and_wait(u, 1, connection_timeout_wait_ms(reactor));
+        pool_rcu_online(reactor->id);
+        if (ret < 0)
+        {
+            if (errno == EINTR)
+            {
+                running = 0;
+                continue;
+            }
+            if (errno != EBUSY && errno != EAGAIN && errno != ETIME)
+                break;
+        }
+
+        unsigned head = *u->cq_head;
+        unsigned tail = __atomic_load_n(u->cq_tail, __ATOMIC_ACQUIRE);
+        while (head != tail)
+        {
+            uring_handle_cqe(reactor, &u->cqes[head & u->cq_mask]);
+            head++;
+            // 처리 중에 새 CQE가 더 도착했을 수 있음
+            if (head == tail)
+            {
+                __atomic_store_n(u->cq_head, head, __ATOMIC_RELEASE);
+                tail = __atomic_load_n(u->cq_tail, __ATOMIC_ACQUIRE);
+            }
+        }
+        __atomic_store_n(u->cq_head, head, __ATOMIC_RELEASE);
+
+        uring_rearm_starved(reactor);
+
+        // timeout이 지난 connection 정리 (struct connection은 uring_connection의 첫 멤버)
+        struct connection *expired;
+        int kind;
+        while ((expired = connection_pop_timed_out(reactor, &kind)) != NULL)
+        {
+            struct uring_connection *uc = (struct uring_connection *)expired;
+            if (kind == PROXY_TIMEOUT_CONNECT)
+                uring_backend_failed(reactor, uc);
+            else
+                uring_close_connection(reactor, uc);
+            uring_finalize_if_done(reactor, uc);
+        }
+    }
+
+    pool_rcu_offline(reactor->id);
+    log_message(LOG_INFO, "Reactor %d stopped", reactor->id);
+    uring_free(u);
+    reactor->uring = NULL;
+    atomic_store_explicit(&reactor->uring_buffer_bytes, 0, memory_order_relaxed);
+}
@@ -0,0 +1,129 @@
+#include <stdlib.h>
+#include "buffer_pool.h"
+#include "logger.h"
+
+// 등급별 크기와 보관 개수 (등급마다 최대 4~8MB 정도만 보관)
+static const size_t class_sizes[BUFFER_POOL_CLASSES] = {4096, 16384, 65536, BUFFER_POOL_MAX_SIZE};
+static const size_t class_max_cached[BUFFER_POOL_CLASSES] = {1024, 256, 64, 8};
+
+static struct buffer_class *find_class(struct buffer_pool *pool, size_t size)
+{
+    for (int i = 0; i < BUFFER_POOL_CLASSES; i++)
+    {
+        if (pool->classes[i].size == size)
+            return &pool->classes[i];
+    }
+    return NULL;
+}
+
+void buffer_pool_init(struct buffer_pool *pool)
+{
+    for (int i = 0; i < BUFFER_POOL_CLASSES; i++)
+    {
+        struct buffer_class *class = &pool->classes[i];
+        class->size = class_sizes[i];
+        class->free_list = NULL;
+        class->cached = 0;
+        class->max_cached = class_max_cached[i];
+        class->acquires = 0;
+        class->hits = 0;
+        class->in_use = 0;
+        class->peak_in_use = 0;
+    }
+    atomic_init(&pool->allocated_bytes, 0);
+}
+
+void buffer_pool_destroy(struct buffer_pool *pool)
+{
+    for (int i = 0; i < BUFFER_POOL_CLASSES; i++)
+    {
+        struct buffer_class *class = &pool->classes[i];
+        while (class->free_list)
+        {
+            void *next = *(void **)class->free_list;
+            free(class->free_list);
+            class->free_list = next;
+            atomic_fetch_sub_explicit(&pool->allocated_bytes, class->size, memory_order_relaxed);
+        }
+        class->cached = 0;
+    }
+}
+
+size_t buffer_pool_class_size(size_t want)
+{
+    for (int i = 0; i < BUFFER_POOL_CLASSES; i++)
+    {
+        if (want <= class_sizes[i])
+            return class_sizes[i];
+    }
+    return 0;
+}
+
+char *buffer_pool_acquire(struct buffer_pool *pool, size_t size)
+{
+    struct buffer_class *class = find_class(pool, size);
+    if (!class)
+        return NULL;
+
+    char *buffer;
+    class->acquires++;
+    if (class->free_list)
+    {
+        buffer = class->free_list;
+        class->free_list = *(void **)buffer;
+        class->cached--;
+        class->hits++;
+    }
+    else
+    {
+        // 내용을 0으로 채울 필요가 없으므로 malloc만 수행 (페이지는 실제로 쓸 때 할당됨)
+        buffer = malloc(size);
+        if (!buffer)
+            return NULL;
+        atomic_fetch_add_explicit(&pool->allocated_bytes, size, memory_order_relaxed);
+    }
+
+    class->in_use++;
+    if (class->in_use > class->peak_in_use)
+        class->peak_in_use = class->in_use;
+    return buffer;
+}
+
+void buffer_pool_release(struct buffer_pool *pool, char *buffer, size_t size)
+{
+    struct buffer_class *class = find_class(pool, size);
+    if (!buffer || !class)
+        return;
+
+    class->in_use--;
+    if (class->cached >= class->max_cached)
+    {
+        free(buffer);
+        atomic_fetch_sub_explicit(&pool->allocated_bytes, size, memory_order_relaxed);
+        return;
+    }
+
+    *(void **)buffer = class->free_list;
+    class->free_list = buffer;
+    class->cached++;
+}
+
+void buffer_pool_log_stats(const struct buffer_pool *pool, int owner_id)
+{
+    for (int i = 0; i < BUFFER_POOL_CLASSES; i++)
+    {
+        const struct buffer_class *class = &pool->classes[i];
+        if (class->acquires == 0)
+            continue;
+
+        log_message(LOG_INFO, "Buffer pool %d [%zuKB] in use: %lu (peak %lu), cached: %zu/%zu, hit rate: %.1f%% (%lu/%lu)",
+                    owner_id, class->size / 1024, class->in_use, class->peak_in_use,
+                    class->cached, class->max_cached,
+                    100.0 * class->hits / class->acquires, class->hits, class->acquires);
+    }
+}
+
+size_t buffer_pool_allocated(struct buffer_pool *pool)
+{
+    return atomic_load_explicit(&pool->allocated_bytes, memory_order_relaxed);
+}
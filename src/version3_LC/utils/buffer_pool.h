@@ -0,0 +1,52 @@
+#ifndef BUFFER_POOL_H
+#define BUFFER_POOL_H
+
+#include <stddef.h>
+#include <stdatomic.h>
+
+// 크기 등급별 버퍼 풀
+// - 등급: 4KB / 16KB / 64KB / 1MB (모두 2의 거듭제곱이라 링 버퍼에 그대로 사용 가능)
+// - 반납된 버퍼는 등급별 free list에 보관했다가 재사용, 보관 개수를 넘으면 free
+// - reactor마다 하나씩 두고 해당 reactor 스레드에서만 사용하므로 잠금 없음
+#define BUFFER_POOL_CLASSES 4
+#define BUFFER_POOL_MAX_SIZE (1024 * 1024)
+
+struct buffer_class
+{
+    size_t size;
+    void *free_list;   // 반납된 버퍼 목록 (버퍼 앞부분에 다음 버퍼 포인터 저장)
+    size_t cached;     // free list에 보관 중인 버퍼 수
+    size_t max_cached; // 보관할 최대 개수
+
+    // 통계
+    unsigned long acquires; // 요청 횟수
+    unsigned long hits;     // free list에서 바로 꺼낸 횟수
+    unsigned long in_use;   // 현재 사용 중인 버퍼 수
+    unsigned long peak_in_use;
+};
+
+struct buffer_pool
+{
+    struct buffer_class classes[BUFFER_POOL_CLASSES];
+
+    // malloc으로 할당한 버퍼의 총 크기 (사용 중 + 보관 중)
+    // 다른 스레드(/metrics)가 읽으므로 atomic, malloc/free할 때만 갱신
+    atomic_size_t allocated_bytes;
+};
+
+void buffer_pool_init(struct buffer_pool *pool);
+void buffer_pool_destroy(struct buffer_pool *pool);
+
+// want 바이트 이상을 담을 수 있는 가장 작은 등급의 크기 (최대 등급보다 크면 0)
+size_t buffer_pool_class_size(size_t want);
+
+// size는 buffer_pool_class_size()가 반환한 등급 크기여야 함
+char *buffer_pool_acquire(struct buffer_pool *pool, size_t size);
+void buffer_pool_release(struct buffer_pool *pool, char *buffer, size_t size);
+
+void buffer_pool_log_stats(const struct buffer_pool *pool, int owner_id);
+
+// 할당된 버퍼 메모리 (소유 reactor가 아닌 스레드에서도 호출 가능)
+size_t buffer_pool_allocated(struct buffer_pool *pool);
+
+#endif
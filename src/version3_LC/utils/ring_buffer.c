@@ -0,0 +1,172 @@
+#include <string.h>
+#include "ring_buffer.h"
+
+void ring_buffer_init(struct ring_buffer *rb, struct buffer_pool *pool, size_t initial_size, size_t max_size)
+{
+    rb->data = NULL;
+    rb->size = 0;
+    rb->head = 0;
+    rb->tail = 0;
+    rb->pool = pool;
+    rb->max_size = buffer_pool_class_size(max_size);
+    rb->initial_size = buffer_pool_class_size(initial_size);
+}
+
+void ring_buffer_free(struct ring_buffer *rb)
+{
+    if (rb->data)
+    {
+        buffer_pool_release(rb->pool, rb->data, rb->size);
+        rb->data = NULL;
+    }
+    rb->size = 0;
+    rb->head = 0;
+    rb->tail = 0;
+}
+
+int ring_buffer_reserve(struct ring_buffer *rb, size_t want)
+{
+    size_t used = ring_buffer_used(rb);
+
+    if (rb->data && rb->size - used >= want)
+        return 0;
+
+    // used + want를 담을 수 있는 가장 작은 등급 (최대 크기를 넘으면 최대 크기로)
+    size_t new_size = buffer_pool_class_size(used + want);
+    if (new_size == 0 || new_size > rb->max_size)
+        new_size = rb->max_size;
+    if (!rb->data && new_size < rb->initial_size)
+        new_size = rb->initial_size;
+    if (rb->data && new_size <= rb->size)
+        return 0;
+
+    char *new_data = buffer_pool_acquire(rb->pool, new_size);
+    if (!new_data)
+        return -1;
+
+    // 남은 데이터를 새 버퍼의 앞쪽으로 옮김 (링이 돌아간 경우 두 조각)
+    if (rb->data)
+    {
+        size_t len;
+        const char *data = ring_buffer_read_ptr(rb, &len);
+        memcpy(new_data, data, len);
+        if (len < used)
+            memcpy(new_data + len, rb->data, used - len);
+        buffer_pool_release(rb->pool, rb->data, rb->size);
+    }
+
+    rb->data = new_data;
+    rb->size = new_size;
+    rb->head = 0;
+    rb->tail = used;
+    return 0;
+}
+
+int ring_buffer_linearize(struct ring_buffer *rb)
+{
+    size_t used = ring_buffer_used(rb);
+    if (!rb->data || (rb->head & (rb->size - 1)) == 0)
+        return 0;
+
+    size_t len;
+    const char *data = ring_buffer_read_ptr(rb, &len);
+    if (len == used)
+    {
+        // 한 조각이면 버퍼 안에서 앞으로 옮김
+        memmove(rb->data, data, used);
+    }
+    else
+    {
+        // 링이 돌아간 경우 같은 등급의 새 버퍼로 두 조각을 이어 붙임
+        char *new_data = buffer_pool_acquire(rb->pool, rb->size);
+        if (!new_data)
+            return -1;
+        memcpy(new_data, data, len);
+        memcpy(new_data + len, rb->data, used - len);
+        buffer_pool_release(rb->pool, rb->data, rb->size);
+        rb->data = new_data;
+    }
+
+    rb->head = 0;
+    rb->tail = used;
+    return 0;
+}
+
+void ring_buffer_trim(struct ring_buffer *rb)
+{
+    if (!rb->data || rb->head != rb->tail)
+        return;
+
+    rb->initial_size = rb->size;
+    ring_buffer_free(rb);
+}
+
+size_t ring_buffer_used(const struct ring_buffer *rb)
+{
+    return rb->tail - rb->head;
+}
+
+int ring_buffer_full(const struct ring_buffer *rb)
+{
+    return ring_buffer_used(rb) >= rb->max_size;
+}
+
+size_t ring_buffer_space(const struct ring_buffer *rb)
+{
+    return rb->size - (rb->tail - rb->head);
+}
+
+char *ring_buffer_write_ptr(struct ring_buffer *rb, size_t *len)
+{
+    if (!rb->data)
+    {
+        *len = 0;
+        return NULL;
+    }
+
+    size_t offset = rb->tail & (rb->size - 1);
+    size_t contiguous = rb->size - offset;
+    size_t space = ring_buffer_space(rb);
+
+    *len = contiguous < space ? contiguous : space;
+    return rb->data + offset;
+}
+
+void ring_buffer_produce(struct ring_buffer *rb, size_t len)
+{
+    rb->tail += len;
+}
+
+const char *ring_buffer_read_ptr(const struct ring_buffer *rb, size_t *len)
+{
+    return ring_buffer_peek(rb, 0, len);
+}
+
+const char *ring_buffer_peek(const struct ring_buffer *rb, size_t skip, size_t *len)
+{
+    size_t used = ring_buffer_used(rb);
+    if (!rb->data || skip >= used)
+    {
+        *len = 0;
+        return NULL;
+    }
+
+    size_t offset = (rb->head + skip) & (rb->size - 1);
+    size_t contiguous = rb->size - offset;
+    used -= skip;
+
+    *len = contiguous < used ? contiguous : used;
+    return rb->data + offset;
+}
+
+void ring_buffer_consume(struct ring_buffer *rb, size_t len)
+{
+    rb->head += len;
+
+    // 비었으면 처음 위치로 되돌려서 다음 데이터가 최대한 연속된 영역에 들어가도록 함
+    if (rb->head == rb->tail)
+    {
+        rb->head = 0;
+        rb->tail = 0;
+    }
+}
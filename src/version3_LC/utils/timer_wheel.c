@@ -0,0 +1,178 @@
+#include <string.h>
+#include "timer_wheel.h"
+
+#define SLOT_MASK (TIMER_WHEEL_SLOTS - 1)
+#define LEVEL_SHIFT(level) ((level) * TIMER_WHEEL_BITS)
+#define MAX_DELTA ((1ULL << (TIMER_WHEEL_LEVELS * TIMER_WHEEL_BITS)) - 1)
+
+void timer_wheel_init(struct timer_wheel *wheel, long long now_ms)
+{
+    memset(wheel, 0, sizeof(*wheel));
+    wheel->base_ms = now_ms;
+}
+
+static void link_timer(struct timer_wheel *wheel, struct timer *timer)
+{
+    uint64_t expires = timer->expires;
+    uint64_t delta;
+    int level;
+
+    if (expires < wheel->now)
+        expires = wheel->now; // 이미 지난 시각은 다음 처리 때 바로 만료
+    delta = expires - wheel->now;
+    if (delta > MAX_DELTA)
+    {
+        delta = MAX_DELTA;
+        expires = wheel->now + delta;
+    }
+
+    // 남은 tick 수로 단계를 고르고, 만료 tick의 해당 단계 자릿수로 칸을 고름
+    for (level = 0; level < TIMER_WHEEL_LEVELS - 1; level++)
+    {
+        if (delta < (1ULL << LEVEL_SHIFT(level + 1)))
+            break;
+    }
+    unsigned slot = (unsigned)(expires >> LEVEL_SHIFT(level)) & SLOT_MASK;
+
+    struct timer **head = &wheel->slots[level][slot];
+    timer->next = *head;
+    if (timer->next)
+        timer->next->pprev = &timer->next;
+    timer->pprev = head;
+    *head = timer;
+    timer->level = (uint8_t)level;
+    timer->slot = (uint8_t)slot;
+    wheel->occupied[level] |= 1ULL << slot;
+}
+
+static void unlink_timer(struct timer_wheel *wheel, struct timer *timer)
+{
+    *timer->pprev = timer->next;
+    if (timer->next)
+        timer->next->pprev = timer->pprev;
+    if (!wheel->slots[timer->level][timer->slot])
+        wheel->occupied[timer->level] &= ~(1ULL << timer->slot);
+    timer->next = NULL;
+    timer->pprev = NULL;
+}
+
+void timer_wheel_add(struct timer_wheel *wheel, struct timer *timer, long long expires_ms)
+{
+    if (timer_pending(timer))
+        unlink_timer(wheel, timer);
+    else
+        wheel->count++;
+
+    // 일찍 만료되지 않도록 tick 단위로 올림
+    long long offset = expires_ms - wheel->base_ms;
+    timer->expires = offset <= 0 ? 0 : (uint64_t)(offset + TIMER_WHEEL_TICK_MS - 1) / TIMER_WHEEL_TICK_MS;
+    link_timer(wheel, timer);
+}
+
+void timer_wheel_del(struct timer_wheel *wheel, struct timer *timer)
+{
+    if (!timer_pending(timer))
+        return;
+    unlink_timer(wheel, timer);
+    wheel->count--;
+}
+
+// now가 해당 단계의 경계에 도달하면 위 단계 칸의 타이머를 남은 시간에 맞는 단계로 다시 배치
+static void cascade(struct timer_wheel *wheel)
+{
+    for (int level = 1; level < TIMER_WHEEL_LEVELS; level++)
+    {
+        unsigned slot = (unsigned)(wheel->now >> LEVEL_SHIFT(level)) & SLOT_MASK;
+        struct timer *timer = wheel->slots[level][slot];
+        wheel->slots[level][slot] = NULL;
+        wheel->occupied[level] &= ~(1ULL << slot);
+
+        while (timer)
+        {
+            struct timer *next = timer->next;
+            link_timer(wheel, timer);
+            timer = next;
+        }
+
+        // 이 단계도 한 바퀴를 돌았을 때만 다음 단계를 내려 보냄
+        if (slot != 0)
+            break;
+    }
+}
+
+struct timer *timer_wheel_expire(struct timer_wheel *wheel, long long now_ms)
+{
+    if (now_ms < wheel->base_ms)
+        return NULL;
+    uint64_t target = (uint64_t)(now_ms - wheel->base_ms) / TIMER_WHEEL_TICK_MS;
+
+    while (wheel->now <= target)
+    {
+        if (wheel->count == 0)
+        {
+            // 등록된 타이머가 없으면 내려 보낼 것도 없으므로 바로 이동
+            wheel->now = target + 1;
+            break;
+        }
+
+        struct timer *timer = wheel->slots[0][wheel->now & SLOT_MASK];
+        if (timer)
+        {
+            unlink_timer(wheel, timer);
+            wheel->count--;
+            return timer;
+        }
+
+        // 가장 아래 단계가 비어 있으면 다음 경계까지 한 번에 이동
+        // (현재 시각보다 앞서 가면 이후에 등록하는 타이머가 늦게 만료되므로 target + 1까지만)
+        if (wheel->occupied[0] == 0)
+        {
+            uint64_t boundary = (wheel->now | SLOT_MASK) + 1;
+            wheel->now = boundary < target + 1 ? boundary : target + 1;
+        }
+        else
+        {
+            wheel->now++;
+        }
+
+        if ((wheel->now & SLOT_MASK) == 0)
+            cascade(wheel);
+    }
+    return NULL;
+}
+
+// 비트맵에서 from 칸부터 순환하며 처음으로 비어 있지 않은 칸까지의 거리 (없으면 -1)
+static int next_occupied(uint64_t occupied, unsigned from)
+{
+    if (occupied == 0)
+        return -1;
+    uint64_t rotated = from ? (occupied >> from) | (occupied << (TIMER_WHEEL_SLOTS - from)) : occupied;
+    return __builtin_ctzll(rotated);
+}
+
+long long timer_wheel_next_ms(const struct timer_wheel *wheel)
+{
+    if (wheel->count == 0)
+        return -1;
+
+    uint64_t next = UINT64_MAX;
+
+    // 가장 아래 단계는 칸 = 만료 tick
+    int distance = next_occupied(wheel->occupied[0], (unsigned)(wheel->now & SLOT_MASK));
+    if (distance >= 0)
+        next = wheel->now + (uint64_t)distance;
+
+    // 위 단계는 그 칸이 아래로 내려오는 경계 tick (현재 칸은 이미 내려 보냈으므로 다음 칸부터)
+    for (int level = 1; level < TIMER_WHEEL_LEVELS; level++)
+    {
+        uint64_t index = wheel->now >> LEVEL_SHIFT(level);
+        distance = next_occupied(wheel->occupied[level], (unsigned)((index + 1) & SLOT_MASK));
+        if (distance < 0)
+            continue;
+        uint64_t tick = (index + 1 + (uint64_t)distance) << LEVEL_SHIFT(level);
+        if (tick < next)
+            next = tick;
+    }
+
+    return wheel->base_ms + (long long)(next * TIMER_WHEEL_TICK_MS);
+}
@@ -0,0 +1,62 @@
+#ifndef TIMER_WHEEL_H
+#define TIMER_WHEEL_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// 계층형 타이머 휠
+// - 단계마다 64칸, 4단계 (1칸 = 10ms / 640ms / 41초 / 44분, 최대 약 46시간)
+// - 등록/해제는 O(1), 시간이 흐르면 위 단계의 칸을 아래 단계로 내려 보내며(cascade) 만료 처리
+// - 타이머는 사용하는 쪽 구조체에 넣어 두는 intrusive 방식이라 메모리를 할당하지 않음
+// - reactor마다 하나씩 두고 해당 reactor 스레드에서만 사용하므로 잠금 없음
+#define TIMER_WHEEL_TICK_MS 10
+#define TIMER_WHEEL_BITS 6
+#define TIMER_WHEEL_SLOTS (1 << TIMER_WHEEL_BITS)
+#define TIMER_WHEEL_LEVELS 4
+
+struct timer
+{
+    struct timer *next;
+    struct timer **pprev; // 앞 노드의 next(또는 칸의 head)를 가리킴, 등록되지 않았으면 NULL
+    uint64_t expires;     // 만료 tick
+    uint8_t level;        // 들어 있는 칸
+    uint8_t slot;
+};
+
+struct timer_wheel
+{
+    uint64_t now;     // 다음에 처리할 tick (그 이전 tick은 모두 처리됨)
+    long long base_ms; // tick 0의 시각
+    size_t count;     // 등록된 타이머 수
+    uint64_t occupied[TIMER_WHEEL_LEVELS]; // 비어 있지 않은 칸 비트맵
+    struct timer *slots[TIMER_WHEEL_LEVELS][TIMER_WHEEL_SLOTS];
+};
+
+void timer_wheel_init(struct timer_wheel *wheel, long long now_ms);
+
+static inline void timer_init(struct timer *timer)
+{
+    timer->next = NULL;
+    timer->pprev = NULL;
+}
+
+static inline int timer_pending(const struct timer *timer)
+{
+    return timer->pprev != NULL;
+}
+
+// expires_ms 시각 이후에 만료되도록 등록 (이미 등록되어 있으면 옮김)
+void timer_wheel_add(struct timer_wheel *wheel, struct timer *timer, long long expires_ms);
+
+// 등록 해제 (등록되지 않은 타이머면 아무것도 하지 않음)
+void timer_wheel_del(struct timer_wheel *wheel, struct timer *timer);
+
+// now_ms까지 만료된 타이머를 하나씩 꺼냄 (등록 해제된 상태로 반환, 없으면 NULL)
+// 반환된 타이머를 처리하면서 다른 타이머를 등록/해제해도 됨
+struct timer *timer_wheel_expire(struct timer_wheel *wheel, long long now_ms);
+
+// 다음에 timer_wheel_expire()를 호출해야 하는 시각 (등록된 타이머가 없으면 -1)
+// 위 단계의 타이머는 아래 단계로 내려가는 시각을 반환하므로 실제 만료보다 이를 수 있음
+long long timer_wheel_next_ms(const struct timer_wheel *wheel);
+
+#endif
@@ -0,0 +1,129 @@
+// 응답 시간 히스토그램 마이크로벤치마크
+// - 정확도: 꼬리가 긴 응답 시간 분포(로그 정규)에서 p50/p90/p99/p999를 정렬한 정확한 값과 비교
+// - 기록 비용: histogram_record 한 번에 걸리는 시간
+// - 기록 중 읽기: 워커 스레드가 기록하는 동안 snapshot을 반복해서 읽고, 끝난 뒤 개수가 정확히 맞는지 확인
+//
+// 빌드/실행: make bench && ./histogram_bench [샘플 수]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include <math.h>
+#include <time.h>
+#include "histogram.h"
+
+#define WRITER_THREADS 4
+#define WRITER_RECORDS 2000000
+
+static struct latency_histogram histogram;
+static atomic_int writers_done;
+
+static double now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static int compare_values(const void *a, const void *b)
+{
+    unsigned long long x = *(const unsigned long long *)a;
+    unsigned long long y = *(const unsigned long long *)b;
+    return x < y ? -1 : x > y;
+}
+
+// 중앙값 약 2ms, p999가 수십 ms인 응답 시간 (us)
+static unsigned long long sample_latency(void)
+{
+    double u1 = (rand() + 1.0) / (RAND_MAX + 2.0);
+    double u2 = (rand() + 1.0) / (RAND_MAX + 2.0);
+    double normal = sqrt(-2 * log(u1)) * cos(2 * M_PI * u2);
+    return (unsigned long long)(2000 * exp(normal * 0.9));
+}
+
+static void report_accuracy(int samples)
+{
+    static const double quantiles[] = {0.50, 0.90, 0.99, 0.999};
+    unsigned long long *values = malloc(samples * sizeof(*values));
+    if (!values)
+        return;
+
+    srand(42);
+    histogram_init(&histogram);
+    for (int i = 0; i < samples; i++)
+        values[i] = sample_latency();
+
+    double start = now_ns();
+    for (int i = 0; i < samples; i++)
+        histogram_record(&histogram, values[i]);
+    double record_ns = (now_ns() - start) / samples;
+
+    struct histogram_snapshot snapshot;
+    histogram_snapshot_init(&snapshot);
+    start = now_ns();
+    histogram_snapshot_add(&snapshot, &histogram);
+    double snapshot_us = (now_ns() - start) / 1000;
+
+    qsort(values, samples, sizeof(*values), compare_values);
+    printf("%d samples, record %.1f ns, snapshot %.1f us (%d buckets, %zu bytes):\n",
+           samples, record_ns, snapshot_us, HISTOGRAM_BUCKETS, sizeof(histogram));
+    for (size_t i = 0; i < sizeof(quantiles) / sizeof(quantiles[0]); i++)
+    {
+        unsigned long long rank = (unsigned long long)(quantiles[i] * samples + 0.5);
+        unsigned long long exact = values[rank > 0 ? rank - 1 : 0];
+        unsigned long long estimate = histogram_quantile(&snapshot, quantiles[i]);
+        printf("  p%-5g exact %8.3f ms  histogram %8.3f ms  error %+5.2f%%\n", quantiles[i] * 100,
+               exact / 1000.0, estimate / 1000.0, (estimate - (double)exact) / exact * 100);
+    }
+    free(values);
+}
+
+static void *writer(void *arg)
+{
+    unsigned long long value = (unsigned long long)(size_t)arg * 1000 + 1;
+    for (int i = 0; i < WRITER_RECORDS; i++)
+        histogram_record(&histogram, value + (unsigned long long)(i % 50000));
+    atomic_fetch_add(&writers_done, 1);
+    return NULL;
+}
+
+static void report_concurrent(void)
+{
+    pthread_t threads[WRITER_THREADS];
+    struct histogram_snapshot snapshot;
+    unsigned long long previous = 0;
+    int reads = 0, went_back = 0;
+
+    histogram_init(&histogram);
+    for (int t = 0; t < WRITER_THREADS; t++)
+        pthread_create(&threads[t], NULL, writer, (void *)(size_t)t);
+
+    // 기록을 멈추지 않고 읽음 (읽을 때마다 개수는 줄어들지 않아야 함)
+    while (atomic_load(&writers_done) < WRITER_THREADS)
+    {
+        histogram_snapshot_init(&snapshot);
+        histogram_snapshot_add(&snapshot, &histogram);
+        went_back += snapshot.total_count < previous;
+        previous = snapshot.total_count;
+        histogram_quantile(&snapshot, 0.99);
+        reads++;
+    }
+    for (int t = 0; t < WRITER_THREADS; t++)
+        pthread_join(threads[t], NULL);
+
+    histogram_snapshot_init(&snapshot);
+    histogram_snapshot_add(&snapshot, &histogram);
+    printf("%d writers x %d records with %d reads in between: total %llu of %d, count went back %d times\n",
+           WRITER_THREADS, WRITER_RECORDS, reads, snapshot.total_count, WRITER_THREADS * WRITER_RECORDS,
+           went_back);
+}
+
+int main(int argc, char *argv[])
+{
+    int samples = argc > 1 ? atoi(argv[1]) : 1000000;
+
+    report_accuracy(samples);
+    report_concurrent();
+    return 0;
+}
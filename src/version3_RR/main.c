@@ -1,13 +1,88 @@
 #include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include "proxy.h"
 
-extern int run_proxy(int listen_port, int target_port, char* target_host);
+static void usage(const char *prog)
+{
+    fprintf(stderr, "Usage: %s [-p listen_port] [-r num_reactors] [-e] [-u] [-S] [-t kind=ms]... [-R retries] [-k key=value]... [-b policy] [-w server=weight]... [-c config] [-m [address:]admin_port]\n", prog);
+    fprintf(stderr, "  -t: timeout (connect, header, idle, first_byte), 0 disables\n");
+    fprintf(stderr, "  -R: retries of idempotent requests on another backend after a failure before the response\n");
+    fprintf(stderr, "  -k: active health check (interval, timeout, rise, fall, path), interval=0 disables\n");
+    fprintf(stderr, "  -b: backend selection policy (default, p2c, swrr, maglev-ip, maglev-uri)\n");
+    fprintf(stderr, "  -w: weight of a backend by index for weighted round robin, 0 drains it (without -c)\n");
+    fprintf(stderr, "  -c: backend config file, one 'server addr:port [weight=N] [max_conns=N]' per line, reloaded on SIGHUP\n");
+    fprintf(stderr, "  -m: admin port serving Prometheus metrics at /metrics, on 127.0.0.1 unless an address is given\n");
+}
+
+int main(int argc, char *argv[]) {
+    struct proxy_options options;
+    proxy_options_init(&options);
 
-int main() {
-    int listen_port = 39071;
-    int target_port = 39020;
-    char* target_host = "10.198.138.212";
-    //char* target_host = "10.198.138.213";
-    //char* target_host = "127.0.0.1";
+    int opt;
+    while ((opt = getopt(argc, argv, "p:r:euSt:R:k:b:w:c:m:h")) != -1) {
+        switch (opt) {
+        case 'p':
+            options.listen_port = atoi(optarg);
+            break;
+        case 'r':
+            options.num_reactors = atoi(optarg);
+            break;
+        case 'e':
+            options.edge_triggered = 1;
+            break;
+        case 'u':
+            options.io_backend = IO_BACKEND_URING;
+            break;
+        case 'S':
+            options.splice_relay = 0;
+            break;
+        case 'R':
+            options.max_retries = atoi(optarg);
+            break;
+        case 'b':
+            if (proxy_options_set_balancer(&options, optarg) < 0) {
+                fprintf(stderr, "Invalid balancer: %s\n", optarg);
+                usage(argv[0]);
+                return 1;
+            }
+            break;
+        case 'w':
+            if (proxy_options_set_weight(&options, optarg) < 0) {
+                fprintf(stderr, "Invalid weight: %s\n", optarg);
+                usage(argv[0]);
+                return 1;
+            }
+            break;
+        case 'c':
+            options.config_path = optarg;
+            break;
+        case 'm':
+            if (proxy_options_set_admin(&options, optarg) < 0) {
+                fprintf(stderr, "Invalid admin address: %s\n", optarg);
+                usage(argv[0]);
+                return 1;
+            }
+            break;
+        case 'k':
+            if (health_check_options_set(&options.health_check, optarg) < 0) {
+                fprintf(stderr, "Invalid health check option: %s\n", optarg);
+                usage(argv[0]);
+                return 1;
+            }
+            break;
+        case 't':
+            if (proxy_options_set_timeout(&options, optarg) < 0) {
+                fprintf(stderr, "Invalid timeout: %s\n", optarg);
+                usage(argv[0]);
+                return 1;
+            }
+            break;
+        default:
+            usage(argv[0]);
+            return opt == 'h' ? 0 : 1;
+        }
+    }
 
-    return run_proxy(listen_port, target_port, target_host);
+    return run_proxy(&options);
 }
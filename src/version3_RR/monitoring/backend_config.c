@@ -0,0 +1,132 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <limits.h>
+#include <arpa/inet.h>
+#include "backend_config.h"
+#include "../utils/logger.h"
+
+static int parse_int(const char *value, int min, int max, int *out)
+{
+    char *end;
+    errno = 0;
+    long parsed = strtol(value, &end, 10);
+    if (errno != 0 || end == value || *end != '\0' || parsed < min || parsed > max)
+        return -1;
+    *out = (int)parsed;
+    return 0;
+}
+
+// "주소:포트" 확인 (백엔드 연결은 inet_addr로 만드므로 IPv4 주소만 허용)
+static int parse_endpoint(char *endpoint, char **address, int *port)
+{
+    char *colon = strrchr(endpoint, ':');
+    if (!colon)
+        return -1;
+    *colon = '\0';
+
+    struct in_addr addr;
+    if (inet_pton(AF_INET, endpoint, &addr) != 1)
+        return -1;
+    *address = endpoint;
+    return parse_int(colon + 1, 1, 65535, port);
+}
+
+// server 줄 하나를 해석해서 pool에 추가
+static int parse_server(struct backend_pool *pool, char *line)
+{
+    char *save;
+    char *word = strtok_r(line, " \t", &save);
+    if (!word || strcmp(word, "server") != 0)
+        return -1;
+
+    char *address;
+    int port;
+    word = strtok_r(NULL, " \t", &save);
+    if (!word || parse_endpoint(word, &address, &port) < 0)
+        return -1;
+
+    int weight = DEFAULT_BACKEND_WEIGHT;
+    int max_connections = 0;
+    while ((word = strtok_r(NULL, " \t", &save)) != NULL)
+    {
+        if (strncmp(word, "weight=", 7) == 0)
+        {
+            if (parse_int(word + 7, 0, MAX_BACKEND_WEIGHT, &weight) < 0)
+                return -1;
+        }
+        else if (strncmp(word, "max_conns=", 10) == 0)
+        {
+            if (parse_int(word + 10, 0, INT_MAX, &max_connections) < 0)
+                return -1;
+        }
+        else
+            return -1;
+    }
+
+    return add_backend_server(pool, address, port, weight, max_connections) < 0 ? -1 : 0;
+}
+
+// 주석과 빈 줄을 뺀 줄 수 (pool의 크기를 정하기 위해 먼저 한 번 읽음)
+static int count_server_lines(FILE *file)
+{
+    char line[BACKEND_CONFIG_LINE_MAX];
+    int count = 0;
+    while (fgets(line, sizeof(line), file))
+    {
+        line[strcspn(line, "#\r\n")] = '\0';
+        if (line[strspn(line, " \t")] != '\0')
+            count++;
+    }
+    rewind(file);
+    return count;
+}
+
+int load_backend_config(struct backend_pool *pool, const char *path)
+{
+    FILE *file = fopen(path, "r");
+    if (!file)
+    {
+        log_message(LOG_ERROR, "Cannot open backend config %s: %s", path, strerror(errno));
+        return -1;
+    }
+
+    int count = count_server_lines(file);
+    if (count == 0 || count > MAX_BACKENDS)
+    {
+        log_message(LOG_ERROR, "Backend config %s has %d servers (expected 1 to %d)", path, count, MAX_BACKENDS);
+        fclose(file);
+        return -1;
+    }
+    if (init_empty_backend_pool(pool, count) < 0)
+    {
+        log_message(LOG_ERROR, "Backend pool allocation failed for %d servers", count);
+        fclose(file);
+        return -1;
+    }
+
+    char line[BACKEND_CONFIG_LINE_MAX];
+    int line_no = 0;
+    int rc = 0;
+    while (fgets(line, sizeof(line), file))
+    {
+        line_no++;
+        line[strcspn(line, "#\r\n")] = '\0';
+        if (line[strspn(line, " \t")] == '\0')
+            continue;
+
+        if (parse_server(pool, line) < 0)
+        {
+            log_message(LOG_ERROR, "Invalid backend config %s:%d (expected 'server addr:port [weight=N] [max_conns=N]')",
+                        path, line_no);
+            rc = -1;
+            break;
+        }
+    }
+    fclose(file);
+
+    if (rc < 0)
+        cleanup_backend_pool(pool);
+    return rc;
+}
@@ -0,0 +1,22 @@
+#ifndef BACKEND_CONFIG_H
+#define BACKEND_CONFIG_H
+
+#include "health.h"
+
+/**
+ * 백엔드 서버 설정 파일
+ * - 한 줄에 서버 하나: server <IPv4 주소>:<포트> [weight=<0~MAX_BACKEND_WEIGHT>] [max_conns=<요청 수>]
+ * - weight 기본값은 DEFAULT_BACKEND_WEIGHT, max_conns 기본값은 0(제한 없음)
+ * - '#' 뒤는 주석, 빈 줄은 무시
+ *
+ *   # 예시
+ *   server 10.0.0.1:39020 weight=3
+ *   server 10.0.0.2:39020 weight=1 max_conns=200
+ */
+#define BACKEND_CONFIG_LINE_MAX 512
+
+// 파일의 서버 수만큼 pool을 초기화하고 채움
+// 잘못된 줄이 있거나 서버가 없으면 -1 (pool은 초기화되지 않은 상태로 남음)
+int load_backend_config(struct backend_pool *pool, const char *path);
+
+#endif
@@ -3,45 +3,99 @@
 
 #include <stdbool.h>
 #include <time.h>
+#include <stdatomic.h>
+#include "upstream_pool.h"
+#include "histogram.h"
 
 #define MAX_FAILURES 3
-#define MAX_BACKENDS 5 // HTTP 서버 최대 개수
+#define MAX_BACKENDS 65535 // HTTP 서버 최대 개수 (Maglev 테이블에 16비트 인덱스로 기록)
+#define DEFAULT_BACKENDS 5 // 설정 파일 없이 시작할 때의 서버 수 (BACKEND_ADDRESS의 BASE_PORT부터)
 #define BASE_PORT 39020
 #define BACKEND_ADDRESS "10.198.138.212"
+#define BACKEND_ADDRESS_LEN 64
+#define DEFAULT_BACKEND_WEIGHT 1 // 가중치 라운드 로빈 기본값 (0이면 선택하지 않음)
+#define MAX_BACKEND_WEIGHT 1000
 
+// 응답 시간 peak EWMA (P2C 선택 점수)
+#define LATENCY_EWMA_DECAY_MS 10000     // 시간 상수: 이 시간이 지나면 이전 값의 영향이 절반으로 줄어듦
+#define LATENCY_FAILURE_PENALTY_MS 1000 // 실패한 요청은 최소 이 시간이 걸린 것으로 기록 (빨리 실패하는 서버로 몰리지 않도록)
+
+// 서버 하나의 주소와 통계 (선택할 때마다 모든 서버를 훑지 않는 값)
 struct backend_server
 {
-    char *address;
+    char address[BACKEND_ADDRESS_LEN];
     int port;
-    bool is_healthy;
-    int failed_responses;
-
-    // 메트릭
-    int current_requests;
-    int total_requests;
-    int total_failures;
-    double total_response_time;
-    double avg_response_time;
-    double failure_rate;
+    atomic_int failed_responses;
+
+    // 메트릭 (여러 reactor 스레드가 공유하므로 atomic)
+    atomic_int total_requests;
+    atomic_int total_failures;
+    struct latency_histogram latency; // 백엔드를 선택한 때부터 응답의 마지막 바이트까지 걸린 시간
+
+    // peak EWMA 응답 시간 (마이크로초)과 마지막으로 갱신한 시각
+    atomic_ullong latency_ewma_us;
+    atomic_llong latency_stamp_ns;
+
+    // 이 서버로 가는 keep-alive 연결 풀
+    struct upstream_pool idle_connections;
 };
 
+/**
+ * 백엔드 서버 pool (structure of arrays)
+ * - 선택 정책이 서버마다 확인하는 값(처리 중인 요청 수, 정상 여부, 가중치, 상한)은 서버 인덱스로 접근하는 촘촘한 배열
+ *   서버가 수천 개여도 least-connection은 캐시 라인 하나에 16개 서버의 요청 수를 읽으며 벡터 연산으로 비교
+ * - 주소, 통계, keep-alive 풀처럼 선택한 서버 하나에만 접근하는 값은 servers 배열
+ * - 서버 수는 만들 때 정하고 이후에는 바뀌지 않음 (설정을 다시 읽으면 새 pool을 만듦)
+ */
 struct backend_pool
 {
-    struct backend_server servers[MAX_BACKENDS];
     int server_count;
+    int capacity;
+
+    atomic_int *current_requests; // 서버별 처리 중인 요청 수 (64바이트 정렬, capacity를 벡터 폭의 배수로 올림)
+    atomic_int *weight;           // 가중치 라운드 로빈에서 선택 비율, 실행 중에도 잠금 없이 변경 가능
+    int *max_connections;         // 동시에 처리하는 요청 수 상한, 제한이 없으면 INT_MAX
+    atomic_ullong *healthy;       // 서버마다 1비트 (64개씩 한 워드)
+    struct backend_server *servers;
 
     // 전체 시스템 메트릭
-    int total_requests;
-    int total_failures;
-    double total_response_time;
-    double avg_response_time;
+    atomic_int total_requests;
+    atomic_int total_failures;
+    struct latency_histogram latency; // 모든 서버의 응답 시간
+
+    // 설정을 다시 읽으면 새 pool로 바뀌므로, 이 pool로 진행 중인 요청이 끝날 때까지 유지하기 위한 참조 수
+    atomic_int refs;
+    struct maglev_table *maglev; // BALANCER_MAGLEV_* 정책의 조회 테이블 (사용하지 않으면 NULL)
 };
 
-void init_backend_pool(struct backend_pool *pool);
+// 배열 길이를 이 값(int 16개 = 캐시 라인 하나)의 배수로 맞춰 벡터 연산이 남는 서버 없이 끝까지 읽도록 함
+#define BACKEND_POOL_LANES 16
+
+// 기본 서버 구성(DEFAULT_BACKENDS개)으로 초기화, 메모리가 부족하면 -1
+int init_backend_pool(struct backend_pool *pool);
+// 서버를 capacity개까지 담을 수 있는 빈 pool로 초기화, 메모리가 부족하면 -1
+int init_empty_backend_pool(struct backend_pool *pool, int capacity);
+// 서버 추가 (max_connections 0은 제한 없음), 자리가 없거나 값이 범위를 벗어나면 -1
+int add_backend_server(struct backend_pool *pool, const char *address, int port, int weight, int max_connections);
+// 같은 주소:포트의 서버가 old에 있으면 헬스 상태와 응답 시간 EWMA를 이어받음 (설정을 다시 읽을 때)
+void inherit_backend_state(struct backend_pool *pool, struct backend_pool *old);
+// idle keep-alive 연결을 닫고 배열과 조회 테이블을 해제 (pool 자체는 호출하는 쪽에서 해제)
 void cleanup_backend_pool(struct backend_pool *pool);
 void track_request_start(struct backend_pool *pool, int server_idx);
 void track_request_end(struct backend_pool *pool, int server_idx, bool success, double response_time);
 void update_server_status(struct backend_pool *pool, int server_idx, bool request_success);
 bool is_server_available(struct backend_pool *pool, int server_idx);
+void set_server_available(struct backend_pool *pool, int server_idx, bool healthy);
+
+// 서버 하나 / pool 전체의 응답 시간 분포를 snapshot에 더함 (기록을 멈추지 않고 언제든 읽을 수 있음)
+void read_server_latency(struct backend_pool *pool, int server_idx, struct histogram_snapshot *snapshot);
+void read_pool_latency(struct backend_pool *pool, struct histogram_snapshot *snapshot);
+
+// 가중치 변경 (0 ~ MAX_BACKEND_WEIGHT), 범위를 벗어나면 -1
+int set_server_weight(struct backend_pool *pool, int server_idx, int weight);
+
+// 지금 시각 기준으로 감쇠시킨 peak EWMA 응답 시간 (밀리초, 최소 1µs)
+// 측정한 적이 없거나 LATENCY_EWMA_DECAY_MS 넘게 기록이 없으면 -1
+double server_recent_latency_ms(struct backend_server *server);
 
 #endif
\ No newline at end of file
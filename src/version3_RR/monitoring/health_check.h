@@ -0,0 +1,41 @@
+#ifndef HEALTH_CHECK_H
+#define HEALTH_CHECK_H
+
+#include "health.h"
+
+/**
+ * 능동 헬스 체크
+ * - 전용 스레드가 interval마다 모든 백엔드에 HTTP GET을 동시에 보냄 (non-blocking connect + epoll)
+ * - 주기와 응답 대기 시간은 timerfd로 관리, timeout 안에 2xx/3xx 상태 줄을 받으면 성공
+ * - 연속 성공 rise번이면 정상, 연속 실패 fall번이면 비정상으로 is_healthy를 atomic하게 변경
+ * - 실제 요청의 실패로 비정상이 된 서버(passive)도 프로브가 성공하면 다시 정상으로 돌아옴
+ */
+#define DEFAULT_HEALTH_CHECK_INTERVAL_MS 2000
+#define DEFAULT_HEALTH_CHECK_TIMEOUT_MS 1000
+#define DEFAULT_HEALTH_CHECK_RISE 2
+#define DEFAULT_HEALTH_CHECK_FALL 3
+#define DEFAULT_HEALTH_CHECK_PATH "/"
+#define HEALTH_CHECK_PATH_MAX 256
+
+struct health_check_options
+{
+    int interval_ms; // 0이면 능동 헬스 체크를 사용하지 않음
+    int timeout_ms;  // 프로브 하나의 connect부터 상태 줄 수신까지 (interval보다 길면 interval로 제한)
+    int rise;
+    int fall;
+    char path[HEALTH_CHECK_PATH_MAX];
+};
+
+void health_check_options_init(struct health_check_options *options);
+
+// "항목=값" 형식의 설정 (interval, timeout, rise, fall, path), 잘못된 형식이면 -1
+int health_check_options_set(struct health_check_options *options, const char *spec);
+
+// 헬스 체크 스레드 시작 (interval_ms가 0이면 아무것도 하지 않음), 실패하면 -1
+int health_check_start(struct backend_pool *pool, const struct health_check_options *options);
+void health_check_stop(void);
+
+// 헬스 체크 스레드가 실행 중인지 (비정상 서버를 되살리는 일을 맡고 있는지)
+int health_check_running(void);
+
+#endif
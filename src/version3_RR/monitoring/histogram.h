@@ -0,0 +1,57 @@
+#ifndef HISTOGRAM_H
+#define HISTOGRAM_H
+
+#include <stdatomic.h>
+
+/**
+ * 응답 시간 히스토그램 (HDR 방식의 log-linear 칸, 단위 마이크로초)
+ * - 32 미만은 값마다 한 칸, 그 위로는 2의 거듭제곱 구간마다 32칸으로 나눠 칸 폭이 값의 3% 이내
+ * - 기록은 칸 하나에 atomic 덧셈만 하므로 잠금이 없고, 여러 스레드가 동시에 기록하는 중에도 읽을 수 있음
+ * - 읽을 때는 칸을 snapshot으로 복사한 뒤 분위수를 계산 (복사하는 동안 들어온 요청은 일부만 반영될 수 있음)
+ */
+#define HISTOGRAM_SUB_BUCKET_BITS 5
+#define HISTOGRAM_SUB_BUCKETS (1 << HISTOGRAM_SUB_BUCKET_BITS)
+#define HISTOGRAM_MAX_BITS 32 // 2^32 us(약 71분) 이상은 마지막 칸에 기록
+#define HISTOGRAM_BUCKETS ((HISTOGRAM_MAX_BITS - HISTOGRAM_SUB_BUCKET_BITS + 1) * HISTOGRAM_SUB_BUCKETS)
+
+struct latency_histogram
+{
+    atomic_ullong counts[HISTOGRAM_BUCKETS];
+    atomic_ullong total_count;
+    atomic_ullong sum_us;
+    atomic_ullong max_us;
+};
+
+// 한 순간에 읽어 둔 히스토그램 (여러 히스토그램을 더해 pool 전체나 스레드별 shard를 합칠 때도 사용)
+struct histogram_snapshot
+{
+    unsigned long long counts[HISTOGRAM_BUCKETS];
+    unsigned long long total_count;
+    unsigned long long sum_us;
+    unsigned long long max_us;
+};
+
+// 자주 보는 분위수 (ms)
+struct latency_percentiles
+{
+    double p50;
+    double p90;
+    double p99;
+    double p999;
+};
+
+void histogram_init(struct latency_histogram *histogram);
+void histogram_record(struct latency_histogram *histogram, unsigned long long value_us);
+
+void histogram_snapshot_init(struct histogram_snapshot *snapshot);
+// histogram의 현재 값을 snapshot에 더함
+void histogram_snapshot_add(struct histogram_snapshot *snapshot, const struct latency_histogram *histogram);
+
+// q(0 ~ 1) 분위수 값 (해당 칸의 상한, 기록된 최댓값을 넘지 않음), 기록이 없으면 0
+unsigned long long histogram_quantile(const struct histogram_snapshot *snapshot, double q);
+void histogram_percentiles(const struct histogram_snapshot *snapshot, struct latency_percentiles *percentiles);
+
+// 칸 index에 들어가는 값의 상한 (이 값 이하가 그 칸까지의 누적)
+unsigned long long histogram_bucket_upper(int index);
+
+#endif
@@ -1,15 +1,25 @@
 #ifndef METRICS_H
 #define METRICS_H
 
+#include <stdbool.h>
+#include <stddef.h>
+#include "health.h"
+
+/**
+ * backend_pool 통계를 읽어서 계산하는 메트릭 (/metrics 응답, 로그)
+ * - 요청 처리 경로는 health.c의 atomic 카운터와 히스토그램만 갱신하고, 여기서는 그 값을 atomic load로 읽기만 함
+ * - 읽는 동안 진행 중인 요청은 일부 값에만 반영될 수 있음 (잠금으로 멈추지 않는 대신 카운터 간 순간적인 오차 허용)
+ */
 struct server_metrics
 {
     // 서버별 메트릭
-    int current_requests;       // 현재 활성 요청 수
-    int total_requests;         // 총 처리 요청 수
-    int failed_requests;        // 실패한 요청 수
-    double total_response_time; // 총 응답 시간 (평균 계산용)
-    double avg_response_time;   // 평균 응답 시간
-    double failure_rate;        // 실패율 (%)
+    int current_requests;     // 현재 활성 요청 수
+    int total_requests;       // 총 처리 요청 수
+    int failed_requests;      // 실패한 요청 수
+    int weight;               // 가중치 (0이면 선택하지 않음)
+    bool healthy;             // 헬스 상태
+    double avg_response_time; // 평균 응답 시간 (ms, 히스토그램 합계 기준)
+    double failure_rate;      // 실패율 (%)
 };
 
 struct system_metrics
@@ -17,7 +27,8 @@ struct system_metrics
     // 전체 시스템 메트릭
     int total_throughput;      // 총 처리량
     int total_errors;          // 총 에러 수
-    double error_rate;         // 전체 에러율
+    int healthy_servers;       // 정상 서버 수
+    double error_rate;         // 전체 에러율 (%)
     double load_balance_score; // 부하 분산 상태 점수 (0-1)
 };
 
@@ -25,13 +36,38 @@ struct system_metrics
 void init_server_metrics(struct server_metrics *metrics);
 void init_system_metrics(struct system_metrics *metrics);
 
-// 메트릭 업데이트
-void update_request_start(struct server_metrics *metrics);
-void update_request_end(struct server_metrics *metrics, bool success, double response_time);
+// pool에서 서버 하나의 현재 값을 읽음
+void collect_server_metrics(struct backend_pool *pool, int server_idx, struct server_metrics *metrics);
+// 서버별 메트릭을 합쳐 전체 메트릭 계산
 void update_system_metrics(struct system_metrics *metrics, struct server_metrics *server_metrics, int server_count);
 
 // 메트릭 계산
 void calculate_server_metrics(struct server_metrics *metrics);
 void calculate_system_metrics(struct system_metrics *metrics);
 
-#endif
\ No newline at end of file
+/**
+ * 부하 분산 점수 (Jain's fairness index)
+ * - 가중치가 있는 정상 서버마다 처리한 요청 수를 가중치로 나눈 값 x에 대해 (Σx)² / (n·Σx²)
+ * - 모든 서버가 가중치에 비례해서 요청을 받으면 1, 한 서버에 몰릴수록 1/n에 가까워짐
+ * - 대상 서버나 요청이 없으면 1
+ */
+double load_balance_score(const struct server_metrics *server_metrics, int server_count);
+
+// Prometheus text format을 쌓는 출력 버퍼 (필요한 만큼 늘어남)
+struct metrics_output
+{
+    char *data;
+    size_t len;
+    size_t capacity;
+    int failed; // 메모리가 부족해서 일부를 쓰지 못함
+};
+
+void metrics_output_init(struct metrics_output *out);
+void metrics_output_reset(struct metrics_output *out);
+void metrics_output_free(struct metrics_output *out);
+void metrics_printf(struct metrics_output *out, const char *format, ...) __attribute__((format(printf, 2, 3)));
+
+// 백엔드 서버별 / 전체 메트릭과 응답 시간 히스토그램을 Prometheus text format으로 출력
+void metrics_render_backends(struct metrics_output *out, struct backend_pool *pool);
+
+#endif
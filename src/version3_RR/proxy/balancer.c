@@ -0,0 +1,341 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <stdatomic.h>
+#include <time.h>
+#include "balancer.h"
+#include "../utils/logger.h"
+
+// reactor 스레드마다 따로 쓰는 xorshift 난수 상태 (공유 카운터나 잠금 없이 뽑기 위함)
+static __thread uint64_t random_state;
+
+static uint32_t next_random(void)
+{
+    if (random_state == 0)
+    {
+        struct timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        random_state = ((uint64_t)ts.tv_nsec << 32) ^ (uint64_t)(uintptr_t)&random_state ^ (uint64_t)ts.tv_sec;
+        if (random_state == 0)
+            random_state = 1;
+    }
+    random_state ^= random_state << 13;
+    random_state ^= random_state >> 7;
+    random_state ^= random_state << 17;
+    return (uint32_t)(random_state >> 32);
+}
+
+// smooth weighted round robin의 서버별 current 값 (reactor 스레드 전용, 서버 수에 맞춰 할당)
+// 설정을 다시 읽어 pool이 바뀌면 인덱스가 가리키는 서버가 달라지므로 처음부터 다시 셈
+static __thread int *swrr_current;
+static __thread int swrr_size;
+static __thread const struct backend_pool *swrr_pool;
+
+// max_connections는 여러 reactor가 동시에 확인하므로 순간적으로 스레드 수만큼 넘을 수 있음
+static int is_candidate(struct backend_pool *pool, int idx, const struct backend_set *excluded, int skip)
+{
+    return idx != skip && !backend_set_contains(excluded, idx) && is_server_available(pool, idx) &&
+           atomic_load(&pool->current_requests[idx]) < pool->max_connections[idx];
+}
+
+static int least_conn_scalar(struct backend_pool *pool, const struct backend_set *excluded)
+{
+    int selected = -1;
+    int min_connections = INT_MAX;
+
+    // 모든 서버를 순회하며 가장 적은 요청 수를 가진 서버를 찾음
+    for (int i = 0; i < pool->server_count; i++)
+    {
+        // 서버가 유효하고 헬스 상태가 "정상"일 때만 고려
+        // 다른 reactor 스레드가 동시에 갱신하므로 atomic load로 읽음
+        int current_requests = atomic_load(&pool->current_requests[i]);
+        if (current_requests < min_connections && is_candidate(pool, i, excluded, -1))
+        {
+            min_connections = current_requests;
+            selected = i;
+        }
+    }
+    return selected;
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+#define BALANCER_X86
+#include <immintrin.h>
+
+// int 8개 (AVX2) 단위로 current_requests, max_connections 배열과 헬스 비트맵을 읽어 레인별 최솟값과 그 인덱스를 구함
+// 배열 길이는 BACKEND_POOL_LANES의 배수이고 64바이트 정렬이므로 마지막 서버 뒤까지 정렬된 load로 읽어도 됨
+__attribute__((target("avx2"))) static int least_conn_avx2(struct backend_pool *pool)
+{
+    const __m256i lane_bits = _mm256_setr_epi32(1, 2, 4, 8, 16, 32, 64, 128);
+    const __m256i none = _mm256_set1_epi32(INT_MAX);
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i step = _mm256_set1_epi32(8);
+    __m256i index = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+    __m256i best = none;
+    __m256i best_index = zero;
+    int blocks = (pool->server_count + 7) / 8;
+    unsigned long long healthy = 0;
+
+    for (int block = 0; block < blocks; block++)
+    {
+        if (block % 8 == 0)
+            healthy = atomic_load(&pool->healthy[block / 8]);
+        // 후보가 아닌 서버(비정상, 상한 도달, 배열 끝의 빈 칸)는 INT_MAX로 바꿈
+        // 요청 수는 다른 reactor가 바꾸는 중일 수 있지만 조금 오래된 값이어도 선택에는 문제없음
+        __m256i current = _mm256_load_si256((const __m256i *)(pool->current_requests + block * 8));
+        __m256i limit = _mm256_load_si256((const __m256i *)(pool->max_connections + block * 8));
+        __m256i bits = _mm256_and_si256(_mm256_set1_epi32((int)(healthy >> (block % 8 * 8))), lane_bits);
+        __m256i eligible = _mm256_andnot_si256(_mm256_cmpeq_epi32(bits, zero), _mm256_cmpgt_epi32(limit, current));
+        __m256i key = _mm256_blendv_epi8(none, current, eligible);
+        // 같은 값이면 앞 서버를 유지하도록 더 작을 때만 바꿈
+        __m256i smaller = _mm256_cmpgt_epi32(best, key);
+        best = _mm256_blendv_epi8(best, key, smaller);
+        best_index = _mm256_blendv_epi8(best_index, index, smaller);
+        index = _mm256_add_epi32(index, step);
+    }
+
+    // 레인별 결과 중 요청 수가 가장 적은 서버, 같으면 인덱스가 작은 서버 (서버마다 확인하는 반복문과 같은 결과)
+    int values[8];
+    int indexes[8];
+    _mm256_storeu_si256((__m256i *)values, best);
+    _mm256_storeu_si256((__m256i *)indexes, best_index);
+    int selected = -1;
+    int min_connections = INT_MAX;
+    for (int lane = 0; lane < 8; lane++)
+    {
+        if (values[lane] < min_connections || (values[lane] == min_connections && indexes[lane] < selected))
+        {
+            min_connections = values[lane];
+            selected = indexes[lane];
+        }
+    }
+    return min_connections == INT_MAX ? -1 : selected;
+}
+
+// 스레드가 생기기 전에 한 번만 정하므로 이후에는 읽기만 함
+static int least_conn_avx2_supported;
+
+__attribute__((constructor)) static void balancer_init(void)
+{
+    __builtin_cpu_init();
+    least_conn_avx2_supported = __builtin_cpu_supports("avx2");
+}
+#endif
+
+int balancer_select_least_conn(struct backend_pool *pool, const struct backend_set *excluded)
+{
+    int selected;
+#ifdef BALANCER_X86
+    // 서버가 적으면 벡터로 바꾸는 비용이 더 커서 서버마다 확인하는 반복문이 빠름 (bench/balancer_bench.c)
+    if (least_conn_avx2_supported && pool->server_count >= LEAST_CONN_VECTOR_MIN && !(excluded && excluded->count > 0))
+        selected = least_conn_avx2(pool);
+    else
+#endif
+        selected = least_conn_scalar(pool, excluded);
+
+    if (selected == -1)
+        log_message(LOG_ERROR, "No healthy backend servers available");
+    return selected;
+}
+
+// 후보 하나를 무작위로 고름 (skip은 이미 고른 서버)
+static int sample_candidate(struct backend_pool *pool, const struct backend_set *excluded, int skip)
+{
+    int count = pool->server_count;
+
+    for (int attempt = 0; attempt < P2C_SAMPLE_ATTEMPTS; attempt++)
+    {
+        int idx = (int)(next_random() % (uint32_t)count);
+        if (is_candidate(pool, idx, excluded, skip))
+            return idx;
+    }
+
+    // 대부분의 서버가 제외된 드문 경우에만 무작위 위치부터 한 바퀴 확인
+    int start = (int)(next_random() % (uint32_t)count);
+    for (int i = 0; i < count; i++)
+    {
+        int idx = (start + i) % count;
+        if (is_candidate(pool, idx, excluded, skip))
+            return idx;
+    }
+    return -1;
+}
+
+static double score(struct backend_pool *pool, int idx, double latency_ms)
+{
+    return latency_ms * (atomic_load(&pool->current_requests[idx]) + 1);
+}
+
+int balancer_select_p2c(struct backend_pool *pool, const struct backend_set *excluded)
+{
+    int first = sample_candidate(pool, excluded, -1);
+    if (first < 0)
+    {
+        log_message(LOG_ERROR, "No healthy backend servers available");
+        return -1;
+    }
+
+    int second = sample_candidate(pool, excluded, first);
+    if (second < 0)
+        return first;
+
+    // 새로 추가됐거나 한동안 선택되지 않은 서버는 상대 후보와 응답 시간이 같다고 보고 처리 중인 요청 수로 비교
+    // (둘 다 모르면 처리 중인 요청 수만 비교)
+    double first_ms = server_recent_latency_ms(&pool->servers[first]);
+    double second_ms = server_recent_latency_ms(&pool->servers[second]);
+    if (first_ms < 0)
+        first_ms = second_ms;
+    if (second_ms < 0)
+        second_ms = first_ms;
+    if (first_ms < 0)
+        first_ms = second_ms = 1.0;
+
+    return score(pool, second, second_ms) < score(pool, first, first_ms) ? second : first;
+}
+
+int balancer_select_swrr(struct backend_pool *pool, const struct backend_set *excluded)
+{
+    int best = -1;
+    int total = 0;
+
+    if (swrr_pool != pool)
+    {
+        if (swrr_size < pool->server_count)
+        {
+            int *current = realloc(swrr_current, pool->server_count * sizeof(int));
+            if (!current)
+            {
+                log_message(LOG_ERROR, "Weighted round robin state allocation failed");
+                return -1;
+            }
+            swrr_current = current;
+            swrr_size = pool->server_count;
+        }
+        memset(swrr_current, 0, swrr_size * sizeof(int));
+        swrr_pool = pool;
+    }
+
+    for (int i = 0; i < pool->server_count; i++)
+    {
+        int weight = atomic_load(&pool->weight[i]);
+        if (weight <= 0 || !is_candidate(pool, i, excluded, -1))
+            continue;
+
+        swrr_current[i] += weight;
+        total += weight;
+        if (best < 0 || swrr_current[i] > swrr_current[best])
+            best = i;
+    }
+
+    if (best < 0)
+    {
+        log_message(LOG_ERROR, "No healthy backend servers available");
+        return -1;
+    }
+    swrr_current[best] -= total;
+    return best;
+}
+
+// FNV-1a 뒤에 murmur3 finalizer로 비트를 섞음 (짧은 키도 모든 비트가 고르게 바뀌도록)
+uint64_t balancer_hash(const void *data, size_t len)
+{
+    const unsigned char *p = data;
+    uint64_t h = 0xcbf29ce484222325ULL;
+    for (size_t i = 0; i < len; i++)
+    {
+        h ^= p[i];
+        h *= 0x100000001b3ULL;
+    }
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ULL;
+    h ^= h >> 33;
+    return h;
+}
+
+int maglev_build(struct maglev_table *table, struct backend_pool *pool, int removed)
+{
+    int count = pool->server_count;
+    for (int i = 0; i < MAGLEV_TABLE_SIZE; i++)
+        table->entries[i] = MAGLEV_EMPTY;
+    if (count == 0 || (count == 1 && removed == 0))
+        return 0;
+
+    uint64_t *offset = malloc(count * sizeof(uint64_t));
+    uint64_t *skip = malloc(count * sizeof(uint64_t));
+    uint64_t *next = malloc(count * sizeof(uint64_t));
+    if (!offset || !skip || !next)
+    {
+        free(offset);
+        free(skip);
+        free(next);
+        return -1;
+    }
+
+    // 서버마다 순열 (offset + j * skip) % M, M이 소수이므로 skip이 0이 아니면 모든 칸을 한 번씩 지남
+    for (int i = 0; i < count; i++)
+    {
+        char name[BACKEND_ADDRESS_LEN + 8];
+        int len = snprintf(name, sizeof(name), "%s:%d", pool->servers[i].address, pool->servers[i].port);
+        uint64_t h = balancer_hash(name, (size_t)len);
+        offset[i] = h % MAGLEV_TABLE_SIZE;
+        skip[i] = (h >> 32) % (MAGLEV_TABLE_SIZE - 1) + 1;
+        next[i] = 0;
+    }
+
+    // 서버를 돌아가며 자기 순열에서 아직 비어 있는 첫 칸을 차지
+    int filled = 0;
+    while (filled < MAGLEV_TABLE_SIZE)
+    {
+        for (int i = 0; i < count && filled < MAGLEV_TABLE_SIZE; i++)
+        {
+            if (i == removed)
+                continue;
+            uint64_t slot = (offset[i] + next[i] * skip[i]) % MAGLEV_TABLE_SIZE;
+            while (table->entries[slot] != MAGLEV_EMPTY)
+            {
+                next[i]++;
+                slot = (offset[i] + next[i] * skip[i]) % MAGLEV_TABLE_SIZE;
+            }
+            table->entries[slot] = (uint16_t)i;
+            next[i]++;
+            filled++;
+        }
+    }
+
+    free(offset);
+    free(skip);
+    free(next);
+    return 0;
+}
+
+static int is_maglev_candidate(struct backend_pool *pool, int idx, const struct backend_set *excluded)
+{
+    return idx != MAGLEV_EMPTY && is_candidate(pool, idx, excluded, -1) && atomic_load(&pool->weight[idx]) > 0;
+}
+
+int balancer_select_maglev(struct backend_pool *pool, const struct maglev_table *table,
+                           uint64_t key, const struct backend_set *excluded)
+{
+    uint64_t slot = key % MAGLEV_TABLE_SIZE;
+
+    for (int probe = 0; probe < MAGLEV_MAX_PROBES; probe++)
+    {
+        int idx = table->entries[(slot + (uint64_t)probe) % MAGLEV_TABLE_SIZE];
+        if (is_maglev_candidate(pool, idx, excluded))
+            return idx;
+    }
+
+    // 대부분의 서버가 후보가 아닌 드문 경우, 키에서 정한 위치부터 한 바퀴 확인
+    for (int i = 0; i < pool->server_count; i++)
+    {
+        int idx = (int)((key + (uint64_t)i) % (uint64_t)pool->server_count);
+        if (is_maglev_candidate(pool, idx, excluded))
+            return idx;
+    }
+    log_message(LOG_ERROR, "No healthy backend servers available");
+    return -1;
+}
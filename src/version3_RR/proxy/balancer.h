@@ -0,0 +1,103 @@
+#ifndef BALANCER_H
+#define BALANCER_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "health.h"
+
+// 모든 정책은 excluded의 서버, 비정상 서버, 처리 중인 요청이 max_connections에 도달한 서버를 건너뜀
+
+// 요청 하나가 이미 보내 본 서버 (재시도에서 제외, 서버 수와 상관없이 재시도 횟수만큼만 기록)
+#define BACKEND_SET_MAX 8
+
+struct backend_set
+{
+    int count;
+    int servers[BACKEND_SET_MAX];
+};
+
+static inline void backend_set_clear(struct backend_set *set)
+{
+    set->count = 0;
+}
+
+static inline void backend_set_add(struct backend_set *set, int server_idx)
+{
+    if (set->count < BACKEND_SET_MAX)
+        set->servers[set->count++] = server_idx;
+}
+
+static inline int backend_set_contains(const struct backend_set *set, int server_idx)
+{
+    for (int i = 0; set && i < set->count; i++)
+        if (set->servers[i] == server_idx)
+            return 1;
+    return 0;
+}
+
+// 무작위로 고른 후보가 제외되었거나 비정상일 때 다시 뽑는 횟수 (그래도 없으면 순서대로 확인)
+#define P2C_SAMPLE_ATTEMPTS 4
+
+// 서버가 이 수 이상이고 AVX2를 지원할 때만 벡터 경로를 사용 (그보다 적으면 반복문이 더 빠름)
+#define LEAST_CONN_VECTOR_MIN 64
+
+/**
+ * 처리 중인 요청 수가 가장 적은 서버 (LC 빌드의 select_server)
+ * - 서버가 LEAST_CONN_VECTOR_MIN개 이상이고 제외할 서버가 없으면 current_requests, max_connections
+ *   배열과 헬스 비트맵을 서버 8개씩 AVX2로 읽어 최솟값과 그 값을 가진 첫 서버를 구함 (실행 중에 CPU 확인)
+ * - 그 밖의 경우(서버가 적음, 재시도로 제외할 서버가 있음, AVX2 없음)는 서버마다 확인하는 반복문 사용
+ *
+ * 반환값: 선택된 서버의 인덱스, 후보가 없으면 -1
+ */
+int balancer_select_least_conn(struct backend_pool *pool, const struct backend_set *excluded);
+
+/**
+ * Power of two choices
+ * - 제외되지 않은 정상 서버 두 개를 무작위로 골라 점수가 낮은 쪽을 선택
+ * - 점수 = peak EWMA 응답 시간 x (처리 중인 요청 수 + 1)
+ * - 최근 응답 기록이 없는 서버는 상대 후보의 응답 시간을 대신 써서 처리 중인 요청 수로 비교
+ * - 서버 수와 상관없이 두 서버만 비교하고, 모든 스레드가 같은 최솟값으로 몰리지 않음
+ *
+ * 반환값: 선택된 서버의 인덱스, 후보가 없으면 -1
+ */
+int balancer_select_p2c(struct backend_pool *pool, const struct backend_set *excluded);
+
+/**
+ * Smooth weighted round robin (nginx 방식)
+ * - 선택할 때마다 후보 서버의 current에 weight를 더하고, current가 가장 큰 서버를 고른 뒤 가중치 합만큼 뺌
+ * - 가중치 5:1:1이면 a a b a c a a 처럼 한 서버로 몰아서 보내지 않고 사이사이에 섞어서 선택
+ * - current는 스레드마다 따로 두므로 잠금이 없고, 각 reactor가 가중치 비율대로 나눠 보냄
+ * - 선택할 때마다 모든 서버를 확인하므로 서버 수에 비례하는 비용
+ * - 제외된 서버, 비정상 서버, 가중치가 0인 서버는 건너뜀
+ *
+ * 반환값: 선택된 서버의 인덱스, 후보가 없으면 -1
+ */
+int balancer_select_swrr(struct backend_pool *pool, const struct backend_set *excluded);
+
+/**
+ * Maglev 일관 해싱 조회 테이블
+ * - 서버마다 이름(주소:포트)의 해시로 정한 순열을 따라 돌아가며 빈 칸을 채워, 모든 서버가 거의 같은 수의 칸을 가짐
+ * - 조회는 키 해시로 칸 하나를 읽는 O(1), 같은 키(클라이언트 주소, URI)는 항상 같은 서버로 감
+ * - 서버를 추가/제거해 다시 만들어도 각 서버의 순열이 그대로이므로 대부분의 칸은 주인이 바뀌지 않음
+ * - 칸의 서버가 제외/비정상/가중치 0이면 다음 칸의 서버를 사용 (그 서버의 키만 흩어지고, 복구되면 돌아옴)
+ */
+#define MAGLEV_TABLE_SIZE 65537 // 소수, 서버가 수백 개까지는 서버마다 칸 수의 차이가 수 % 이내 (서버 수의 100배 이상 권장)
+#define MAGLEV_MAX_PROBES 16    // 후보가 아닌 칸을 만났을 때 이어서 확인하는 칸 수 (그래도 없으면 순서대로 확인)
+#define MAGLEV_EMPTY 0xFFFF     // 서버 인덱스는 MAX_BACKENDS(65535)보다 작음
+
+struct maglev_table
+{
+    uint16_t entries[MAGLEV_TABLE_SIZE]; // 칸마다 서버 인덱스
+};
+
+// pool의 서버로 테이블을 채움 (removed는 빼고 만들 서버 인덱스, 없으면 -1), 메모리가 부족하면 -1
+int maglev_build(struct maglev_table *table, struct backend_pool *pool, int removed);
+
+// 반환값: 선택된 서버의 인덱스, 후보가 없으면 -1
+int balancer_select_maglev(struct backend_pool *pool, const struct maglev_table *table,
+                           uint64_t key, const struct backend_set *excluded);
+
+// 선택 키 해시 (클라이언트 주소 바이트 또는 요청 URI)
+uint64_t balancer_hash(const void *data, size_t len);
+
+#endif
@@ -0,0 +1,197 @@
+#include <string.h>
+#include <stdint.h>
+#include "http_scan.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define HTTP_SCAN_X86 1
+#endif
+
+// 바이트 분류 (바이트 단위 구현과 벡터 구현의 나머지 부분에서 사용)
+#define SCAN_PLAIN 0
+#define SCAN_INVALID 1
+#define SCAN_COLON 2
+#define SCAN_NEWLINE 3
+
+static const unsigned char scan_class[256] = {
+    [0x00 ... 0x08] = SCAN_INVALID,
+    ['\n'] = SCAN_NEWLINE,
+    [0x0b ... 0x0c] = SCAN_INVALID,
+    [0x0e ... 0x1f] = SCAN_INVALID,
+    [':'] = SCAN_COLON,
+    [0x7f] = SCAN_INVALID,
+};
+
+// data[start..len) 을 한 바이트씩 검사 (결과 위치는 data 기준)
+static size_t scan_bytes(const char *data, size_t start, size_t len, struct http_scan *scan)
+{
+    for (size_t i = start; i < len; i++)
+    {
+        switch (scan_class[(unsigned char)data[i]])
+        {
+        case SCAN_NEWLINE:
+            return i;
+        case SCAN_COLON:
+            if (scan->colon == HTTP_SCAN_NONE)
+                scan->colon = i;
+            break;
+        case SCAN_INVALID:
+            scan->invalid = 1;
+            break;
+        }
+    }
+    return len;
+}
+
+static size_t scan_line_scalar(const char *data, size_t len, struct http_scan *scan)
+{
+    return scan_bytes(data, 0, len, scan);
+}
+
+#ifdef HTTP_SCAN_X86
+/**
+ * 블록 하나의 비교 결과(비트마스크)를 반영
+ * - 첫 '\n' 앞의 비트만 사용하고, '\n'이 있으면 1
+ */
+static inline int scan_masks(size_t base, uint32_t newline, uint32_t colon, uint32_t invalid,
+                             struct http_scan *scan)
+{
+    uint32_t before = newline ? (newline & -newline) - 1 : UINT32_MAX;
+
+    colon &= before;
+    if (colon && scan->colon == HTTP_SCAN_NONE)
+        scan->colon = base + (size_t)__builtin_ctz(colon);
+    if (invalid & before)
+        scan->invalid = 1;
+    return newline != 0;
+}
+
+// data[start..len) 을 16바이트씩 비교
+// x86-64에서는 기본 명령어지만 i386에서는 없을 수 있으므로 AVX2와 같이 실행 중에 확인해서 사용
+__attribute__((target("sse2"))) static size_t scan_sse2(const char *data, size_t start, size_t len, struct http_scan *scan)
+{
+    const __m128i newline = _mm_set1_epi8('\n');
+    const __m128i colon = _mm_set1_epi8(':');
+    const __m128i tab = _mm_set1_epi8('\t');
+    const __m128i cr = _mm_set1_epi8('\r');
+    const __m128i del = _mm_set1_epi8(0x7f);
+    const __m128i ctl_max = _mm_set1_epi8(0x1f);
+
+    size_t i = start;
+    for (; i + 16 <= len; i += 16)
+    {
+        __m128i v = _mm_loadu_si128((const __m128i *)(data + i));
+        __m128i ctl = _mm_cmpeq_epi8(_mm_min_epu8(v, ctl_max), v); // v <= 0x1f
+        ctl = _mm_andnot_si128(_mm_or_si128(_mm_cmpeq_epi8(v, tab), _mm_cmpeq_epi8(v, cr)), ctl);
+        ctl = _mm_or_si128(ctl, _mm_cmpeq_epi8(v, del));
+
+        uint32_t nl_mask = (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(v, newline));
+        uint32_t colon_mask = (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(v, colon));
+        if (scan_masks(i, nl_mask, colon_mask, (uint32_t)_mm_movemask_epi8(ctl), scan))
+            return i + (size_t)__builtin_ctz(nl_mask);
+    }
+    return scan_bytes(data, i, len, scan);
+}
+
+__attribute__((target("sse2"))) static size_t scan_line_sse2(const char *data, size_t len, struct http_scan *scan)
+{
+    return scan_sse2(data, 0, len, scan);
+}
+
+// 32바이트씩 비교
+__attribute__((target("avx2"))) static size_t scan_line_avx2(const char *data, size_t len, struct http_scan *scan)
+{
+    const __m256i newline = _mm256_set1_epi8('\n');
+    const __m256i colon = _mm256_set1_epi8(':');
+    const __m256i tab = _mm256_set1_epi8('\t');
+    const __m256i cr = _mm256_set1_epi8('\r');
+    const __m256i del = _mm256_set1_epi8(0x7f);
+    const __m256i ctl_max = _mm256_set1_epi8(0x1f);
+
+    size_t i = 0;
+    for (; i + 32 <= len; i += 32)
+    {
+        __m256i v = _mm256_loadu_si256((const __m256i *)(data + i));
+        __m256i ctl = _mm256_cmpeq_epi8(_mm256_min_epu8(v, ctl_max), v); // v <= 0x1f
+        ctl = _mm256_andnot_si256(_mm256_or_si256(_mm256_cmpeq_epi8(v, tab), _mm256_cmpeq_epi8(v, cr)), ctl);
+        ctl = _mm256_or_si256(ctl, _mm256_cmpeq_epi8(v, del));
+
+        uint32_t nl_mask = (uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, newline));
+        uint32_t colon_mask = (uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, colon));
+        if (scan_masks(i, nl_mask, colon_mask, (uint32_t)_mm256_movemask_epi8(ctl), scan))
+            return i + (size_t)__builtin_ctz(nl_mask);
+    }
+    // 남은 31바이트 이하는 16바이트 단위로
+    // SSE 코드로 넘어가기 전에 상위 레지스터를 비워야 전환 비용이 없음 (tail call에서는 컴파일러가 넣지 않음)
+    _mm256_zeroupper();
+    return scan_sse2(data, i, len, scan);
+}
+#endif
+
+typedef size_t (*scan_line_fn)(const char *data, size_t len, struct http_scan *scan);
+
+struct scan_impl
+{
+    const char *name;
+    scan_line_fn scan_line;
+};
+
+static const struct scan_impl scan_impls[] = {
+#ifdef HTTP_SCAN_X86
+    {"avx2", scan_line_avx2},
+    {"sse2", scan_line_sse2},
+#endif
+    {"scalar", scan_line_scalar},
+};
+
+static const struct scan_impl *scan_selected = &scan_impls[sizeof(scan_impls) / sizeof(scan_impls[0]) - 1];
+
+size_t http_scan_line(const char *data, size_t len, struct http_scan *scan)
+{
+    scan->colon = HTTP_SCAN_NONE;
+    scan->invalid = 0;
+    return scan_selected->scan_line(data, len, scan);
+}
+
+const char *http_scan_impl(void)
+{
+    return scan_selected->name;
+}
+
+static int cpu_supports(const char *name)
+{
+#ifdef HTTP_SCAN_X86
+    if (strcmp(name, "avx2") == 0)
+        return __builtin_cpu_supports("avx2");
+    if (strcmp(name, "sse2") == 0)
+        return __builtin_cpu_supports("sse2");
+#endif
+    (void)name;
+    return 1;
+}
+
+int http_scan_select(const char *name)
+{
+    for (size_t i = 0; i < sizeof(scan_impls) / sizeof(scan_impls[0]); i++)
+    {
+        if (strcmp(scan_impls[i].name, name) == 0 && cpu_supports(name))
+        {
+            scan_selected = &scan_impls[i];
+            return 0;
+        }
+    }
+    return -1;
+}
+
+// 스레드가 생기기 전에 한 번만 선택하므로 이후에는 읽기만 함 (지원하는 구현 중 가장 넓은 것)
+__attribute__((constructor)) static void http_scan_init(void)
+{
+#ifdef HTTP_SCAN_X86
+    __builtin_cpu_init();
+#endif
+    for (size_t i = 0; i < sizeof(scan_impls) / sizeof(scan_impls[0]); i++)
+    {
+        if (http_scan_select(scan_impls[i].name) == 0)
+            return;
+    }
+}
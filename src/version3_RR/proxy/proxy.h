@@ -0,0 +1,74 @@
+#ifndef PROXY_H
+#define PROXY_H
+
+#include "health_check.h"
+#include "admin.h"
+
+#define DEFAULT_LISTEN_PORT 39071
+
+// 이벤트 루프 I/O 백엔드
+#define IO_BACKEND_EPOLL 0
+#define IO_BACKEND_URING 1 // 사용할 수 없는 커널에서는 epoll로 대체
+
+// 백엔드 서버 선택 정책
+#define BALANCER_DEFAULT 0 // 이 빌드의 select_server
+#define BALANCER_P2C 1     // 무작위 두 서버 중 peak EWMA 응답 시간 x 처리 중인 요청 수가 작은 쪽
+#define BALANCER_SWRR 2    // 서버별 가중치에 따른 smooth weighted round robin
+#define BALANCER_MAGLEV_CLIENT 3 // 클라이언트 주소의 Maglev 일관 해싱 (같은 클라이언트는 같은 서버로)
+#define BALANCER_MAGLEV_URI 4    // 요청 URI의 Maglev 일관 해싱 (같은 URI는 같은 서버의 캐시로)
+
+// connection마다 하나씩 걸리는 timeout 종류
+enum proxy_timeout
+{
+    PROXY_TIMEOUT_CONNECT,    // 백엔드 connect 완료까지
+    PROXY_TIMEOUT_HEADER,     // 요청의 첫 바이트(새 연결은 accept)부터 요청 헤더가 완성될 때까지
+    PROXY_TIMEOUT_IDLE,       // keep-alive 연결에서 다음 요청의 첫 바이트까지
+    PROXY_TIMEOUT_FIRST_BYTE, // 요청을 마지막으로 보낸 뒤 백엔드 응답의 첫 바이트까지
+    PROXY_TIMEOUT_KINDS
+};
+
+#define DEFAULT_CONNECT_TIMEOUT_MS 5000
+#define DEFAULT_HEADER_TIMEOUT_MS 30000
+#define DEFAULT_IDLE_TIMEOUT_MS 60000
+#define DEFAULT_FIRST_BYTE_TIMEOUT_MS 60000
+#define DEFAULT_MAX_RETRIES 2 // 백엔드 연결 실패 시 멱등 요청을 다른 서버로 다시 보내는 최대 횟수
+
+// 실행 시점에 결정되는 프록시 설정
+struct proxy_options
+{
+    int listen_port;
+    int num_reactors; // 이벤트 루프(reactor) 스레드 수, 기본값은 온라인 코어 수
+    int edge_triggered; // 1이면 EPOLLET 모드 (fd당 한 번만 등록, EAGAIN까지 읽기/쓰기)
+    int io_backend;     // IO_BACKEND_EPOLL 또는 IO_BACKEND_URING
+    int splice_relay;   // 1이면 응답 헤더 이후 본문을 splice()로 중계 (epoll 백엔드)
+    int timeout_ms[PROXY_TIMEOUT_KINDS]; // 0이면 해당 timeout을 사용하지 않음
+    int max_retries;    // 요청당 재시도 횟수 (최대 BACKEND_SET_MAX - 1), 0이면 재시도하지 않음
+    int balancer;       // BALANCER_* 선택 정책
+    int weights[DEFAULT_BACKENDS]; // 기본 서버 구성의 서버별 가중치 (설정 파일을 쓰면 파일의 weight 사용)
+    const char *config_path;   // 백엔드 서버 설정 파일 (SIGHUP으로 다시 읽음), NULL이면 기본 서버 구성
+    int admin_port;     // /metrics를 제공하는 관리 포트, 0이면 열지 않음
+    char admin_address[ADMIN_ADDRESS_LEN]; // 관리 포트를 여는 주소 (기본값 ADMIN_DEFAULT_ADDRESS)
+    struct health_check_options health_check; // 능동 헬스 체크 (interval_ms가 0이면 사용하지 않음)
+};
+
+void proxy_options_init(struct proxy_options *options);
+
+// "종류=밀리초" 형식의 timeout 설정 (connect, header, idle, first_byte), 잘못된 형식이면 -1
+int proxy_options_set_timeout(struct proxy_options *options, const char *spec);
+const char *proxy_timeout_name(int kind);
+
+// 선택 정책 이름 (default, p2c, swrr, maglev-ip, maglev-uri), 잘못된 이름이면 -1
+int proxy_options_set_balancer(struct proxy_options *options, const char *name);
+
+// "서버 인덱스=가중치" 형식의 가중치 설정, 잘못된 형식이면 -1
+int proxy_options_set_weight(struct proxy_options *options, const char *spec);
+
+// "[주소:]포트" 형식의 관리 포트 설정 (주소를 생략하면 ADMIN_DEFAULT_ADDRESS), 잘못된 형식이면 -1
+int proxy_options_set_admin(struct proxy_options *options, const char *spec);
+int run_proxy(const struct proxy_options *options);
+
+// excluded: 선택하지 않을 서버 (이 요청을 이미 보내 본 서버)
+struct backend_set;
+int select_server(struct backend_pool *pool, const struct backend_set *excluded);
+
+#endif
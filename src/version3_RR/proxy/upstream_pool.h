@@ -0,0 +1,49 @@
+#ifndef UPSTREAM_POOL_H
+#define UPSTREAM_POOL_H
+
+#include <pthread.h>
+#include <stdatomic.h>
+
+#define UPSTREAM_POOL_SIZE 32          // 백엔드 서버마다 보관하는 idle 연결 수
+#define UPSTREAM_IDLE_TIMEOUT_MS 15000 // 이보다 오래 쉰 연결은 백엔드가 닫았을 수 있으므로 버림
+
+struct upstream_idle
+{
+    int fd;
+    long long idle_since_ms;
+};
+
+/**
+ * 백엔드 서버 하나의 keep-alive 연결 풀
+ * - 요청마다 checkout으로 꺼내 쓰고, 응답이 끝나면 checkin으로 반납
+ * - 가장 최근에 반납된 연결부터 사용(LIFO)하고, 오래된 연결은 배열 앞쪽에서 만료 처리
+ * - 여러 스레드가 공유하므로 짧은 임계 구역만 mutex로 보호 (fd close는 잠금 밖에서 수행)
+ */
+struct upstream_pool
+{
+    pthread_mutex_t lock;
+    struct upstream_idle idle[UPSTREAM_POOL_SIZE]; // [0]이 가장 오래된 연결
+    int count;
+
+    // 통계
+    atomic_ulong reused;         // 풀에서 꺼내 재사용한 횟수
+    atomic_ulong created;        // 풀이 비어 새로 연결한 횟수
+    atomic_ulong returned;       // 응답 후 풀에 반납한 횟수
+    atomic_ulong closed_stale;   // checkout 시 백엔드가 이미 닫은 것으로 확인되어 버린 수
+    atomic_ulong closed_expired; // idle 시간이 지나 버린 수
+    atomic_ulong closed_full;    // 풀이 가득 차서 반납하지 못하고 닫은 수
+};
+
+void upstream_pool_init(struct upstream_pool *pool);
+void upstream_pool_destroy(struct upstream_pool *pool);
+
+// 살아 있는 idle 연결을 꺼냄, 없으면 -1 (호출하는 쪽에서 새로 연결한 뒤 upstream_pool_note_created 호출)
+int upstream_pool_checkout(struct upstream_pool *pool);
+void upstream_pool_note_created(struct upstream_pool *pool);
+
+// 응답이 끝난 연결을 반납 (풀이 가득 차면 닫음)
+void upstream_pool_checkin(struct upstream_pool *pool, int fd);
+
+void upstream_pool_log_stats(struct upstream_pool *pool, const char *address, int port);
+
+#endif
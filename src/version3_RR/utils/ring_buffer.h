@@ -0,0 +1,52 @@
+#ifndef RING_BUFFER_H
+#define RING_BUFFER_H
+
+#include <stddef.h>
+#include "buffer_pool.h"
+
+// 링 버퍼 (버퍼 풀의 등급 크기를 사용)
+// - size는 2의 거듭제곱, head/tail은 계속 증가하는 바이트 위치 (size로 나눈 나머지가 실제 위치)
+// - 처음 쓸 때 버퍼를 가져오고, 가득 차면 max_size까지 다음 등급으로 키움
+// - 비어 있을 때 ring_buffer_trim()으로 풀에 반납 (다음에는 마지막으로 쓰던 등급으로 다시 가져옴)
+struct ring_buffer
+{
+    char *data; // 버퍼를 가져오기 전이나 반납한 뒤에는 NULL
+    size_t size;
+    size_t head; // 다음에 읽을(소비할) 위치
+    size_t tail; // 다음에 쓸(채울) 위치
+
+    struct buffer_pool *pool;
+    size_t initial_size; // 처음 가져올 등급 크기 (반납 후에는 마지막으로 쓰던 크기)
+    size_t max_size;     // 키울 수 있는 최대 크기 = 이 링이 가질 수 있는 데이터의 상한
+};
+
+void ring_buffer_init(struct ring_buffer *rb, struct buffer_pool *pool, size_t initial_size, size_t max_size);
+void ring_buffer_free(struct ring_buffer *rb);
+
+// 최소 want 바이트를 쓸 수 있도록 버퍼를 가져오거나 키움 (max_size에 도달하면 남은 공간만큼만)
+// 반환값: 0 성공, -1 메모리 부족
+int ring_buffer_reserve(struct ring_buffer *rb, size_t want);
+
+// 남은 데이터를 버퍼의 처음부터 연속되도록 옮김 (다음 요청 헤더를 한 번에 해석하기 위해 사용)
+// 반환값: 0 성공, -1 메모리 부족
+int ring_buffer_linearize(struct ring_buffer *rb);
+
+// 비어 있으면 버퍼를 풀에 반납
+void ring_buffer_trim(struct ring_buffer *rb);
+
+size_t ring_buffer_used(const struct ring_buffer *rb);
+int ring_buffer_full(const struct ring_buffer *rb); // max_size까지 가득 찼는지
+size_t ring_buffer_space(const struct ring_buffer *rb);
+
+// 연속으로 채울 수 있는 영역과 그 길이 (가득 찼거나 버퍼가 없으면 *len = 0)
+char *ring_buffer_write_ptr(struct ring_buffer *rb, size_t *len);
+void ring_buffer_produce(struct ring_buffer *rb, size_t len);
+
+// 연속으로 읽을 수 있는 영역과 그 길이 (비어 있는 경우 *len = 0)
+const char *ring_buffer_read_ptr(const struct ring_buffer *rb, size_t *len);
+void ring_buffer_consume(struct ring_buffer *rb, size_t len);
+
+// 앞의 skip 바이트를 건너뛴 위치부터 연속으로 읽을 수 있는 영역 (소비하지 않고 다시 읽을 때 사용)
+const char *ring_buffer_peek(const struct ring_buffer *rb, size_t skip, size_t *len);
+
+#endif
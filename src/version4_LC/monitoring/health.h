@@ -5,29 +5,48 @@
 #include <time.h>
 #include <pthread.h>
 #include <stdatomic.h>
+#include "upstream_pool.h"
+#include "histogram.h"
 
 #define MAX_FAILURES 3
 #define MAX_BACKENDS 5 // HTTP 서버 최대 개수
 #define BASE_PORT 39020
 #define BACKEND_ADDRESS "10.198.138.212"
 
+#define CACHE_LINE_SIZE 64
+#define STAT_SHARDS 64 // 통계 shard 수 (2의 거듭제곱, 스레드가 더 많으면 여러 스레드가 한 shard를 나눠 씀)
+
 struct backend_server
 {
     char *address;
     int port;
-    bool is_healthy;
-    int failed_responses;
-
-    // 메트릭
-    atomic_int current_requests;
-    atomic_int total_requests;
-    atomic_int total_failures;
-    double total_response_time;
-    double avg_response_time;
-    double failure_rate;
-
-    // 서버별 동기화를 위한 mutex
-    // pthread_mutex_t server_mutex;/
+    atomic_bool is_healthy;     // 요청 처리 스레드와 헬스 체크 스레드가 함께 갱신 (상태가 바뀔 때만 씀)
+    atomic_int failed_responses;
+
+    // 백엔드 선택이 요청마다 읽는 처리 중인 요청 수 (모든 스레드가 보는 유일한 요청 카운터)
+    // 요청마다 모든 스레드가 쓰므로 다른 값과 캐시 라인을 나눠 쓰지 않도록 따로 둠
+    _Alignas(CACHE_LINE_SIZE) atomic_int current_requests;
+    char current_requests_pad[CACHE_LINE_SIZE - sizeof(atomic_int)];
+
+    // 백엔드 서버와의 keep-alive 연결 풀
+    struct upstream_pool idle_connections;
+};
+
+// 스레드 하나가 쓰는 요청 통계 (다른 스레드의 shard와 캐시 라인을 나눠 쓰지 않도록 정렬)
+struct stat_shard
+{
+    atomic_ullong requests[MAX_BACKENDS];
+    atomic_ullong failures[MAX_BACKENDS];
+    struct latency_histogram latency[MAX_BACKENDS]; // 백엔드를 선택한 때부터 응답의 마지막 바이트까지 걸린 시간
+} __attribute__((aligned(CACHE_LINE_SIZE)));
+
+// 모든 shard를 합친 통계 (읽는 순간에도 다른 스레드가 더하고 있으므로 근사값)
+struct backend_stats
+{
+    unsigned long long total_requests;
+    unsigned long long total_failures;
+    double avg_response_time; // ms
+    double failure_rate;      // %
 };
 
 struct backend_pool
@@ -35,14 +54,8 @@ struct backend_pool
     struct backend_server servers[MAX_BACKENDS];
     int server_count;
 
-    // 전체 시스템 메트릭
-    atomic_int total_requests;
-    atomic_int total_failures;
-    double total_response_time;
-    double avg_response_time;
-
-    // 풀 전체 동기화를 위한 mutex
-    // pthread_mutex_t pool_mutex;
+    // 요청 수, 실패 수, 응답 시간 분포는 스레드별 shard에 더하고 읽을 때 합침
+    struct stat_shard shards[STAT_SHARDS];
 };
 
 void init_backend_pool(struct backend_pool *pool);
@@ -52,4 +65,12 @@ void track_request_end(struct backend_pool *pool, int server_idx, bool success,
 void update_server_status(struct backend_pool *pool, int server_idx, bool request_success);
 bool is_server_available(struct backend_pool *pool, int server_idx);
 
+// 서버 하나 / pool 전체의 통계를 shard에서 모아 읽음 (잠금 없음)
+void read_server_stats(struct backend_pool *pool, int server_idx, struct backend_stats *stats);
+void read_pool_stats(struct backend_pool *pool, struct backend_stats *stats);
+
+// 서버 하나 / pool 전체의 응답 시간 분포를 shard에서 모아 snapshot에 더함 (기록을 멈추지 않고 언제든 읽을 수 있음)
+void read_server_latency(struct backend_pool *pool, int server_idx, struct histogram_snapshot *snapshot);
+void read_pool_latency(struct backend_pool *pool, struct histogram_snapshot *snapshot);
+
 #endif
\ No newline at end of file
@@ -0,0 +1,105 @@
+#include "histogram.h"
+#include <string.h>
+
+// 값이 들어갈 칸
+// - 값 < 32: 값 그대로
+// - 그 외: 최상위 비트 위치(msb)로 구간을 정하고, 최상위 비트 아래 5비트로 구간 안의 칸을 정함
+static int bucket_index(unsigned long long value)
+{
+    if (value < HISTOGRAM_SUB_BUCKETS)
+        return (int)value;
+
+    int msb = 63 - __builtin_clzll(value);
+    if (msb >= HISTOGRAM_MAX_BITS)
+        return HISTOGRAM_BUCKETS - 1;
+    int shift = msb - HISTOGRAM_SUB_BUCKET_BITS;
+    return (shift + 1) * HISTOGRAM_SUB_BUCKETS + (int)(value >> shift) - HISTOGRAM_SUB_BUCKETS;
+}
+
+unsigned long long histogram_bucket_upper(int index)
+{
+    if (index < HISTOGRAM_SUB_BUCKETS)
+        return (unsigned long long)index;
+
+    int shift = index / HISTOGRAM_SUB_BUCKETS - 1;
+    unsigned long long sub = (unsigned long long)(index % HISTOGRAM_SUB_BUCKETS + HISTOGRAM_SUB_BUCKETS);
+    return ((sub + 1) << shift) - 1;
+}
+
+void histogram_init(struct latency_histogram *histogram)
+{
+    for (int i = 0; i < HISTOGRAM_BUCKETS; i++)
+        atomic_init(&histogram->counts[i], 0);
+    atomic_init(&histogram->total_count, 0);
+    atomic_init(&histogram->sum_us, 0);
+    atomic_init(&histogram->max_us, 0);
+}
+
+void histogram_record(struct latency_histogram *histogram, unsigned long long value_us)
+{
+    // 개수와 합계는 통계용이므로 순서 보장 없이 더함
+    atomic_fetch_add_explicit(&histogram->counts[bucket_index(value_us)], 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&histogram->total_count, 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&histogram->sum_us, value_us, memory_order_relaxed);
+
+    // 최댓값은 더 클 때만 바꾸므로 대부분의 요청은 읽기만 함
+    unsigned long long max = atomic_load_explicit(&histogram->max_us, memory_order_relaxed);
+    while (value_us > max &&
+           !atomic_compare_exchange_weak_explicit(&histogram->max_us, &max, value_us,
+                                                  memory_order_relaxed, memory_order_relaxed))
+        ;
+}
+
+void histogram_snapshot_init(struct histogram_snapshot *snapshot)
+{
+    memset(snapshot, 0, sizeof(*snapshot));
+}
+
+void histogram_snapshot_add(struct histogram_snapshot *snapshot, const struct latency_histogram *histogram)
+{
+    // 분위수는 칸 개수의 합으로 계산하므로, 기록 중에 읽어도 칸과 전체 개수가 어긋나지 않도록 total_count를 다시 셈
+    for (int i = 0; i < HISTOGRAM_BUCKETS; i++)
+    {
+        unsigned long long count = atomic_load_explicit(&histogram->counts[i], memory_order_relaxed);
+        snapshot->counts[i] += count;
+        snapshot->total_count += count;
+    }
+    snapshot->sum_us += atomic_load_explicit(&histogram->sum_us, memory_order_relaxed);
+
+    unsigned long long max = atomic_load_explicit(&histogram->max_us, memory_order_relaxed);
+    if (max > snapshot->max_us)
+        snapshot->max_us = max;
+}
+
+unsigned long long histogram_quantile(const struct histogram_snapshot *snapshot, double q)
+{
+    if (snapshot->total_count == 0)
+        return 0;
+
+    // q 비율의 요청이 이 값 이하가 되는 첫 칸 (rank는 1부터)
+    unsigned long long rank = (unsigned long long)(q * snapshot->total_count + 0.5);
+    if (rank < 1)
+        rank = 1;
+    if (rank > snapshot->total_count)
+        rank = snapshot->total_count;
+
+    unsigned long long seen = 0;
+    for (int i = 0; i < HISTOGRAM_BUCKETS; i++)
+    {
+        seen += snapshot->counts[i];
+        if (seen >= rank)
+        {
+            unsigned long long upper = histogram_bucket_upper(i);
+            return upper < snapshot->max_us ? upper : snapshot->max_us;
+        }
+    }
+    return snapshot->max_us;
+}
+
+void histogram_percentiles(const struct histogram_snapshot *snapshot, struct latency_percentiles *percentiles)
+{
+    percentiles->p50 = histogram_quantile(snapshot, 0.50) / 1000.0;
+    percentiles->p90 = histogram_quantile(snapshot, 0.90) / 1000.0;
+    percentiles->p99 = histogram_quantile(snapshot, 0.99) / 1000.0;
+    percentiles->p999 = histogram_quantile(snapshot, 0.999) / 1000.0;
+}
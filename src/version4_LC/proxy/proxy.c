@@ -1,3 +1,4 @@
+#define _GNU_SOURCE
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -7,6 +8,7 @@
 #include <errno.h>
 #include <signal.h>
 #include <limits.h>
+#include <time.h>
 #include <stdatomic.h>
 #include <arpa/inet.h>
 #include <sys/socket.h>
@@ -14,6 +16,10 @@
 #include "proxy.h"
 #include "threadpool.h"
 #include "health.h"
+#include "health_check.h"
+#include "http.h"
+#include "admin.h"
+#include "metrics.h"
 
 #include "../utils/logger.h"
 
@@ -21,11 +27,21 @@
 #define MAX_EVENTS 100
 #define NUM_THREADS 6
 #define CHUNK_SIZE (1024 * 1024)
+#define UPSTREAM_POOL_STATS_INTERVAL 1000 // 요청 수 기준 keep-alive 풀 통계 로그 주기
+#define ADMIN_ENV "NGINXX_ADMIN" // "[주소:]포트", 설정하면 이 주소에 /metrics를 제공하는 관리 포트를 엶 (주소를 생략하면 127.0.0.1)
+
+// 백엔드가 응답을 시작하기 전에 실패했을 때 클라이언트에 보내는 응답
+static const char BAD_GATEWAY_RESPONSE[] =
+    "HTTP/1.1 502 Bad Gateway\r\nContent-Length: 0\r\nConnection: close\r\n\r\n";
 
 static struct backend_pool backend_pool;
 static struct thread_pool thread_pool;
 static atomic_uint request_counter = 0;
 
+// /metrics gauge (메인 스레드와 워커 스레드가 갱신)
+static atomic_int open_connections; // accept했고 아직 닫지 않은 클라이언트 연결 (스레드 풀 대기 중 포함)
+static atomic_int busy_workers;     // 연결을 처리 중인 워커 스레드
+
 // non-blocking 소켓 설정
 static int set_nonblocking(int fd)
 {
@@ -51,50 +67,152 @@ int select_server()
     for (int i = 0; i < backend_pool.server_count; i++)
     {
         struct backend_server *server = &backend_pool.servers[i];
+        int current_requests = atomic_load(&server->current_requests);
 
-        if (!server->is_healthy && server->current_requests == 0)
+        // 능동 헬스 체크가 없을 때만 처리 중인 요청이 없는 비정상 서버를 다시 시도
+        // (헬스 체크가 실행 중이면 비정상 서버의 복구는 헬스 체크가 판단)
+        if (!health_check_running() && !atomic_load(&server->is_healthy) && current_requests == 0)
         {
-            server->is_healthy = true;
-            server->failed_responses = 0; // 실패 카운트 리셋
+            atomic_store(&server->is_healthy, true);
+            atomic_store(&server->failed_responses, 0); // 실패 카운트 리셋
         }
 
         // 서버가 유효하고 헬스 상태가 "정상"일 때만 고려
-        if (server->is_healthy && server->current_requests < min_connections)
+        if (atomic_load(&server->is_healthy) && current_requests < min_connections)
         {
-            min_connections = server->current_requests;
+            min_connections = current_requests;
             selected = i;
         }
     }
     if (selected == -1)
     {
+        if (health_check_running())
+        {
+            log_message(LOG_ERROR, "No healthy backend servers available");
+            return -1;
+        }
         selected = 0;
-        backend_pool.servers[0].is_healthy = true;
-        backend_pool.servers[0].failed_responses = 0;
+        atomic_store(&backend_pool.servers[0].is_healthy, true);
+        atomic_store(&backend_pool.servers[0].failed_responses, 0);
         log_message(LOG_INFO, "Forcing server 0 back to healthy state");
     }
 
     return selected;
 }
 
-void handle_connection(int client_fd, struct sockaddr_in client_addr)
+// 버퍼의 데이터를 모두 전송 (blocking 소켓)
+static int send_all(int fd, const char *data, size_t len)
+{
+    size_t total_sent = 0;
+    while (total_sent < len)
+    {
+        ssize_t sent = send(fd, data + total_sent, len - total_sent, MSG_NOSIGNAL);
+        if (sent < 0)
+        {
+            if (errno == EAGAIN || errno == EWOULDBLOCK)
+            {
+                usleep(1000);
+                continue;
+            }
+            return -1;
+        }
+        total_sent += sent;
+    }
+    return 0;
+}
+
+/**
+ * 백엔드 서버에 새로 연결
+ *
+ * 반환값:
+ * - 성공: 소켓 fd
+ * - 실패: -1
+ */
+static int connect_backend(struct backend_server *server)
+{
+    int backend_fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (backend_fd < 0)
+        return -1;
+
+    // 소켓 버퍼 크기 늘리기
+    int buffer_size = 10485760; // 10MB
+    setsockopt(backend_fd, SOL_SOCKET, SO_RCVBUF, &buffer_size, sizeof(buffer_size));
+    setsockopt(backend_fd, SOL_SOCKET, SO_SNDBUF, &buffer_size, sizeof(buffer_size));
+
+    struct sockaddr_in backend_addr;
+    memset(&backend_addr, 0, sizeof(backend_addr));
+    backend_addr.sin_family = AF_INET;
+    backend_addr.sin_port = htons(server->port);
+    backend_addr.sin_addr.s_addr = inet_addr(server->address);
+
+    if (connect(backend_fd, (struct sockaddr *)&backend_addr, sizeof(backend_addr)) < 0)
+    {
+        close(backend_fd);
+        return -1;
+    }
+
+    upstream_pool_note_created(&server->idle_connections);
+    return backend_fd;
+}
+
+/**
+ * 백엔드 서버와 연결된 소켓을 가져옴
+ * - 서버의 keep-alive 풀에 idle 연결이 있으면 재사용하고(*reused = true), 없으면 새로 연결
+ *
+ * 반환값:
+ * - 성공: 소켓 fd
+ * - 실패: -1
+ */
+static int open_backend(struct backend_server *server, bool *reused)
+{
+    int backend_fd = upstream_pool_checkout(&server->idle_connections);
+    *reused = backend_fd >= 0;
+    if (backend_fd >= 0)
+        return backend_fd;
+    return connect_backend(server);
+}
+
+static double elapsed_ms(const struct timespec *start)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (now.tv_sec - start->tv_sec) * 1000.0 + (now.tv_nsec - start->tv_nsec) / 1000000.0;
+}
+
+static void serve_connection(int client_fd, struct sockaddr_in client_addr)
 {
     unsigned int req_num = atomic_fetch_add(&request_counter, 1);
     char request_id[32];
     snprintf(request_id, sizeof(request_id), "REQ-%d-%u", client_fd, req_num);
 
-    // 클라이언트로부터 요청 받기
+    // 클라이언트로부터 요청 받기 (요청 길이를 알아야 백엔드 연결을 재사용할 수 있으므로 헤더 끝까지)
+    // 받은 부분까지 이어서 해석하므로 recv마다 처음부터 헤더 끝을 찾지 않음
     char buffer[CHUNK_SIZE];
     ssize_t bytes_received;
+    size_t header_received = 0;
+    struct http_request request;
+    http_request_init(&request);
+    int parsed = HTTP_PARSE_AGAIN;
+
+    while (header_received < CHUNK_SIZE)
+    {
+        bytes_received = recv(client_fd, buffer + header_received, CHUNK_SIZE - header_received, 0);
+        if (bytes_received <= 0)
+            break;
+        header_received += bytes_received;
+        parsed = http_request_parse(&request, buffer, header_received);
+        if (parsed != HTTP_PARSE_AGAIN)
+            break;
+    }
 
-    bytes_received = recv(client_fd, buffer, CHUNK_SIZE - 1, 0);
-    if (bytes_received <= 0)
+    if (parsed != HTTP_PARSE_DONE)
     {
         log_message(LOG_INFO, "[%s] Client connection closed or error", request_id);
         close(client_fd);
         return;
     }
 
-    buffer[bytes_received] = '\0';
+    long long request_length = http_request_length(&request);
 
     // 백엔드 서버 선택 및 연결
     int server_idx = select_server();
@@ -107,84 +225,152 @@ void handle_connection(int client_fd, struct sockaddr_in client_addr)
     track_request_start(&backend_pool, server_idx);
     struct backend_server *server = &backend_pool.servers[server_idx];
 
-    log_message(LOG_INFO, "[%s] Selected backend server %s:%d",
-                request_id, server->address, server->port);
-
-    int backend_fd = socket(AF_INET, SOCK_STREAM, 0);
-    if (backend_fd < 0)
-    {
-        close(client_fd);
-        track_request_end(&backend_pool, server_idx, 0, 1);
-        return;
-    }
+    struct timespec start_time;
+    clock_gettime(CLOCK_MONOTONIC, &start_time);
 
     // 소켓 버퍼 크기 늘리기
     int buffer_size = 10485760; // 10MB
-    setsockopt(backend_fd, SOL_SOCKET, SO_RCVBUF, &buffer_size, sizeof(buffer_size));
-    setsockopt(backend_fd, SOL_SOCKET, SO_SNDBUF, &buffer_size, sizeof(buffer_size));
     setsockopt(client_fd, SOL_SOCKET, SO_RCVBUF, &buffer_size, sizeof(buffer_size));
     setsockopt(client_fd, SOL_SOCKET, SO_SNDBUF, &buffer_size, sizeof(buffer_size));
 
-    struct sockaddr_in backend_addr;
-    memset(&backend_addr, 0, sizeof(backend_addr));
-    backend_addr.sin_family = AF_INET;
-    backend_addr.sin_port = htons(server->port);
-    backend_addr.sin_addr.s_addr = inet_addr(server->address);
-
-    if (connect(backend_fd, (struct sockaddr *)&backend_addr, sizeof(backend_addr)) < 0)
+    bool reused;
+    int backend_fd = open_backend(server, &reused);
+    if (backend_fd < 0)
     {
-        close(backend_fd);
+        send_all(client_fd, BAD_GATEWAY_RESPONSE, sizeof(BAD_GATEWAY_RESPONSE) - 1);
         close(client_fd);
-        track_request_end(&backend_pool, server_idx, 0, 1);
+        track_request_end(&backend_pool, server_idx, 0, elapsed_ms(&start_time));
         return;
     }
 
-    if (send(backend_fd, buffer, bytes_received, 0) < 0)
-    {
-        close(backend_fd);
-        close(client_fd);
-        track_request_end(&backend_pool, server_idx, 0, 1);
-        return;
-    }
+    // 요청 전달 (본문 길이를 알면 본문 끝까지, 요청 뒤에 이어서 온 데이터는 전달하지 않음)
+    size_t to_send = header_received - request.request_start; // 요청 앞의 빈 줄은 전달하지 않음
+    if (request_length >= 0 && (unsigned long long)request_length < to_send)
+        to_send = request_length;
+    // 요청 전체가 첫 버퍼에 있으면 다른 백엔드 연결로 다시 보낼 수 있음 (본문을 더 읽으면 버퍼를 덮어씀)
+    bool replayable = request_length < 0 || (unsigned long long)request_length == to_send;
 
-    // 백엔드로부터 응답 받기
+    unsigned long long forwarded;
+    bool success;
+    bool response_started;
     char response[CHUNK_SIZE];
-    bool success = true;
+    struct http_response response_state;
 
-    while (1)
+    for (;;)
     {
-        bytes_received = recv(backend_fd, response, CHUNK_SIZE, 0);
-        if (bytes_received <= 0)
+        forwarded = to_send;
+        success = send_all(backend_fd, buffer + request.request_start, to_send) == 0;
+
+        while (success && request_length >= 0 && forwarded < (unsigned long long)request_length)
         {
-            success = (bytes_received == 0); // 정상 종료인 경우는 성공으로 처리
-            goto cleanup;
+            size_t want = CHUNK_SIZE;
+            if ((unsigned long long)request_length - forwarded < want)
+                want = request_length - forwarded;
+            bytes_received = recv(client_fd, buffer, want, 0);
+            if (bytes_received <= 0 || send_all(backend_fd, buffer, bytes_received) < 0)
+            {
+                success = false;
+                break;
+            }
+            forwarded += bytes_received;
         }
 
-        // 클라이언트로 청크 단위 전송
-        size_t total_sent = 0;
-        while (total_sent < bytes_received)
+        // 백엔드로부터 응답 받기 (응답 길이를 알면 다음 응답의 데이터를 읽지 않도록 남은 만큼만 수신)
+        http_response_init(&response_state, request.head_request);
+        response_started = false;
+
+        while (success && !http_response_complete(&response_state))
         {
-            ssize_t sent = send(client_fd, response + total_sent,
-                                bytes_received - total_sent, 0);
-            if (sent < 0)
+            size_t want = http_response_remaining(&response_state);
+            if (want > CHUNK_SIZE)
+                want = CHUNK_SIZE;
+            bytes_received = recv(backend_fd, response, want, 0);
+            if (bytes_received <= 0)
             {
-                if (errno == EAGAIN || errno == EWOULDBLOCK)
-                {
-                    usleep(1000);
-                    continue;
-                }
+                // 응답을 시작한 뒤의 EOF는 길이 없는 응답의 끝, 첫 바이트 전의 EOF나 오류는 실패
+                success = (bytes_received == 0 && response_started);
                 break;
             }
-            total_sent += sent;
+            response_started = true;
+
+            // 클라이언트로 청크 단위 전송
+            size_t used = http_response_feed(&response_state, response, bytes_received);
+            if (send_all(client_fd, response, used) < 0)
+                break;
         }
+
+        // 풀에서 꺼낸 연결을 백엔드가 그 사이에 닫았으면 새 연결로 한 번만 다시 시도
+        if (success || response_started || !reused || !replayable)
+            break;
+        shutdown(backend_fd, SHUT_RDWR);
+        close(backend_fd);
+        reused = false;
+        backend_fd = connect_backend(server);
+        if (backend_fd < 0)
+            break;
     }
 
-cleanup:
-    shutdown(backend_fd, SHUT_RDWR);
+    // 응답을 보내기 전에 실패했으면 빈 응답 대신 502를 보냄
+    if (!success && !response_started)
+        send_all(client_fd, BAD_GATEWAY_RESPONSE, sizeof(BAD_GATEWAY_RESPONSE) - 1);
+
+    // 응답의 마지막 바이트(길이/chunked로 판단하거나 백엔드 EOF)를 받은 시점까지
+    double response_time = elapsed_ms(&start_time);
+
+    // 요청과 응답이 정확히 끝난 keep-alive 연결은 닫지 않고 풀에 반납
+    bool reusable = success && request_length >= 0 &&
+                    forwarded == (unsigned long long)request_length &&
+                    http_response_keep_alive(&response_state);
+
     shutdown(client_fd, SHUT_RDWR);
-    close(backend_fd);
     close(client_fd);
-    track_request_end(&backend_pool, server_idx, success, !success);
+    if (reusable)
+    {
+        upstream_pool_checkin(&server->idle_connections, backend_fd);
+    }
+    else if (backend_fd >= 0)
+    {
+        shutdown(backend_fd, SHUT_RDWR);
+        close(backend_fd);
+    }
+    track_request_end(&backend_pool, server_idx, success, response_time);
+
+    if (req_num % UPSTREAM_POOL_STATS_INTERVAL == 0)
+    {
+        struct backend_stats stats;
+        struct histogram_snapshot snapshot;
+        struct latency_percentiles percentiles;
+        for (int i = 0; i < backend_pool.server_count; i++)
+        {
+            struct backend_server *logged = &backend_pool.servers[i];
+            upstream_pool_log_stats(&logged->idle_connections, logged->address, logged->port);
+            read_server_stats(&backend_pool, i, &stats);
+            log_server_metrics(logged->address, logged->port, atomic_load(&logged->current_requests),
+                               (int)stats.total_requests, (int)stats.total_failures, stats.avg_response_time);
+            histogram_snapshot_init(&snapshot);
+            read_server_latency(&backend_pool, i, &snapshot);
+            histogram_percentiles(&snapshot, &percentiles);
+            log_message(LOG_INFO, "[METRIC][LATENCY %s:%d] p50 %.3fms p90 %.3fms p99 %.3fms p999 %.3fms",
+                        logged->address, logged->port, percentiles.p50, percentiles.p90, percentiles.p99,
+                        percentiles.p999);
+        }
+        read_pool_stats(&backend_pool, &stats);
+        log_system_metrics((int)stats.total_requests, (int)stats.total_failures, stats.avg_response_time);
+        histogram_snapshot_init(&snapshot);
+        read_pool_latency(&backend_pool, &snapshot);
+        histogram_percentiles(&snapshot, &percentiles);
+        log_message(LOG_INFO, "[METRIC][LATENCY SYSTEM] p50 %.3fms p90 %.3fms p99 %.3fms p999 %.3fms",
+                    percentiles.p50, percentiles.p90, percentiles.p99, percentiles.p999);
+    }
+}
+
+// 스레드 풀의 워커가 호출 (연결 하나를 끝까지 처리하고 닫음)
+void handle_connection(int client_fd, struct sockaddr_in client_addr)
+{
+    atomic_fetch_add_explicit(&busy_workers, 1, memory_order_relaxed);
+    serve_connection(client_fd, client_addr);
+    atomic_fetch_sub_explicit(&busy_workers, 1, memory_order_relaxed);
+    atomic_fetch_sub_explicit(&open_connections, 1, memory_order_relaxed);
 }
 
 static void handle_new_connection(int epoll_fd, int listen_fd)
@@ -199,13 +385,47 @@ static void handle_new_connection(int epoll_fd, int listen_fd)
     }
 
     // client_fd를 non-blocking으로 설정하기 전에 먼저 스레드풀에 작업 추가
+    atomic_fetch_add_explicit(&open_connections, 1, memory_order_relaxed);
     if (thread_pool_add_work(&thread_pool, client_fd, client_addr) < 0)
     {
+        atomic_fetch_sub_explicit(&open_connections, 1, memory_order_relaxed);
         close(client_fd);
         return;
     }
 }
 
+/**
+ * /metrics 응답 본문 (메인 스레드의 이벤트 루프에서 호출)
+ * - 백엔드 통계는 워커 스레드가 쓰는 shard를 읽기만 하므로 요청 처리를 멈추지 않음
+ * - 워커는 연결마다 요청/응답 버퍼(CHUNK_SIZE 2개)를 스택에 두므로 처리 중인 워커 수로 버퍼 메모리를 계산
+ */
+static void render_metrics(struct metrics_output *out)
+{
+    metrics_render_backends(out, &backend_pool);
+
+    int busy = atomic_load_explicit(&busy_workers, memory_order_relaxed);
+    metrics_printf(out, "# HELP nginxx_open_connections Client connections accepted and not yet closed.\n"
+                        "# TYPE nginxx_open_connections gauge\n"
+                        "nginxx_open_connections %d\n",
+                   atomic_load_explicit(&open_connections, memory_order_relaxed));
+    metrics_printf(out, "# HELP nginxx_busy_workers Worker threads serving a connection.\n"
+                        "# TYPE nginxx_busy_workers gauge\n"
+                        "nginxx_busy_workers %d\n"
+                        "# HELP nginxx_workers Worker threads in the pool.\n"
+                        "# TYPE nginxx_workers gauge\n"
+                        "nginxx_workers %d\n",
+                   busy, NUM_THREADS);
+    metrics_printf(out, "# HELP nginxx_buffer_bytes Request and response buffers held by busy workers.\n"
+                        "# TYPE nginxx_buffer_bytes gauge\n"
+                        "nginxx_buffer_bytes %zu\n",
+                   (size_t)busy * 2 * CHUNK_SIZE);
+
+    metrics_printf(out, "# HELP nginxx_log_dropped_records_total INFO log lines dropped because a thread's log buffer was full.\n"
+                        "# TYPE nginxx_log_dropped_records_total counter\n"
+                        "nginxx_log_dropped_records_total %lu\n",
+                   log_dropped_records());
+}
+
 int run_proxy(int listen_port)
 {
     // 백엔드 서버 초기화
@@ -213,6 +433,12 @@ int run_proxy(int listen_port)
 
     log_message(LOG_INFO, "Backend server pool initialized with %d servers", MAX_BACKENDS);
 
+    // 실제 요청이 실패하기 전에 죽은 서버를 찾도록 능동 헬스 체크 시작
+    struct health_check_options health_check;
+    health_check_options_init(&health_check);
+    if (health_check_start(&backend_pool, &health_check) < 0)
+        return 1;
+
     // 스레드 풀 초기화
     if (thread_pool_init(&thread_pool, NUM_THREADS) < 0)
     {
@@ -271,6 +497,30 @@ int run_proxy(int listen_port)
         return 1;
     }
 
+    // 관리 포트는 같은 이벤트 루프에서 처리 (환경 변수로 요청했을 때만 엶)
+    struct admin_server *admin = NULL;
+    const char *admin_spec = getenv(ADMIN_ENV);
+    char admin_address[ADMIN_ADDRESS_LEN];
+    int admin_port = 0;
+    if (admin_spec && admin_parse_listen(admin_spec, admin_address, &admin_port) < 0)
+    {
+        log_message(LOG_ERROR, "Invalid %s=%s, /metrics disabled", ADMIN_ENV, admin_spec);
+        admin_port = 0;
+    }
+    if (admin_port > 0)
+    {
+        admin = admin_server_create(admin_address, admin_port, render_metrics);
+        ev.events = EPOLLIN;
+        ev.data.fd = admin ? admin_server_fd(admin) : -1;
+        if (admin && epoll_ctl(epoll_fd, EPOLL_CTL_ADD, ev.data.fd, &ev) < 0)
+        {
+            admin_server_destroy(admin);
+            admin = NULL;
+        }
+        if (!admin)
+            log_message(LOG_ERROR, "Admin port %s:%d unavailable, /metrics disabled", admin_address, admin_port);
+    }
+
     struct epoll_event events[MAX_EVENTS];
 
     signal(SIGPIPE, SIG_IGN);
@@ -306,10 +556,16 @@ int run_proxy(int listen_port)
                 }
                 handle_new_connection(epoll_fd, listen_fd);
             }
+            else if (admin && events[n].data.fd == admin_server_fd(admin))
+            {
+                admin_server_poll(admin);
+            }
         }
     }
+    health_check_stop();
     log_message(LOG_INFO, "Destroying Thread Pool...");
     thread_pool_destroy(&thread_pool);
+    admin_server_destroy(admin);
     close(epoll_fd);
     close(listen_fd);
     return 0;
@@ -0,0 +1,149 @@
+// 요청 통계 카운터 경합 마이크로벤치마크
+// - 기존 방식: 서버별/pool 전체 카운터를 모든 스레드가 atomic으로 더하고 응답 시간 double을 그대로 더함
+//   (카운터, double, 헬스 상태가 같은 캐시 라인에 섞여 있음)
+// - 새 방식: health.c의 track_request_start/end (처리 중인 요청 수만 공유, 나머지는 스레드별 shard)
+// - 워커 스레드 6(기본 스레드 풀), 16, 64개가 동시에 요청 시작/종료를 기록하고 요청 하나당 시간을 비교
+//
+// 빌드/실행: make bench && ./counter_bench [스레드당 요청 수]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <time.h>
+#include "health.h"
+
+// 이전 backend_server / backend_pool의 카운터 배치
+struct shared_server
+{
+    char *address;
+    int port;
+    atomic_bool is_healthy;
+    atomic_int failed_responses;
+    atomic_int current_requests;
+    atomic_int total_requests;
+    atomic_int total_failures;
+    double total_response_time;
+    double avg_response_time;
+    double failure_rate;
+};
+
+struct shared_pool
+{
+    struct shared_server servers[MAX_BACKENDS];
+    atomic_int total_requests;
+    atomic_int total_failures;
+    double total_response_time;
+    double avg_response_time;
+};
+
+struct run
+{
+    int sharded;
+    int requests;
+    pthread_barrier_t *barrier;
+    int thread_idx;
+};
+
+static struct shared_pool shared_pool;
+static struct backend_pool pool;
+
+static double now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static void shared_request(int idx, double response_time)
+{
+    struct shared_server *server = &shared_pool.servers[idx];
+
+    atomic_fetch_add(&server->current_requests, 1);
+    atomic_fetch_add(&server->total_requests, 1);
+    atomic_fetch_add(&shared_pool.total_requests, 1);
+
+    atomic_fetch_sub(&server->current_requests, 1);
+    server->total_response_time += response_time;
+    server->avg_response_time = server->total_response_time / atomic_load(&server->total_requests);
+    server->failure_rate = ((double)atomic_load(&server->total_failures) / atomic_load(&server->total_requests)) * 100;
+    shared_pool.total_response_time += response_time;
+    shared_pool.avg_response_time = shared_pool.total_response_time / atomic_load(&shared_pool.total_requests);
+    atomic_store(&server->failed_responses, 0);
+    atomic_store(&server->is_healthy, true);
+}
+
+static void *worker(void *arg)
+{
+    struct run *run = arg;
+
+    pthread_barrier_wait(run->barrier);
+    for (int i = 0; i < run->requests; i++)
+    {
+        int idx = (run->thread_idx + i) % MAX_BACKENDS;
+        if (run->sharded)
+        {
+            track_request_start(&pool, idx);
+            track_request_end(&pool, idx, true, 1.0);
+        }
+        else
+        {
+            shared_request(idx, 1.0);
+        }
+    }
+    return NULL;
+}
+
+// 모든 스레드가 끝날 때까지의 시간을 전체 요청 수로 나눈 값
+static double measure(int sharded, int threads, int requests)
+{
+    pthread_t tids[threads];
+    struct run runs[threads];
+    pthread_barrier_t barrier;
+
+    pthread_barrier_init(&barrier, NULL, threads + 1);
+    for (int t = 0; t < threads; t++)
+    {
+        runs[t] = (struct run){sharded, requests, &barrier, t};
+        pthread_create(&tids[t], NULL, worker, &runs[t]);
+    }
+    pthread_barrier_wait(&barrier);
+    double start = now_ns();
+    for (int t = 0; t < threads; t++)
+        pthread_join(tids[t], NULL);
+    double ns = (now_ns() - start) / ((double)threads * requests);
+    pthread_barrier_destroy(&barrier);
+    return ns;
+}
+
+int main(int argc, char *argv[])
+{
+    static const int thread_counts[] = {6, 16, 64};
+    int requests = argc > 1 ? atoi(argv[1]) : 200000;
+    unsigned long long expected = 0;
+
+    init_backend_pool(&pool);
+
+    printf("%d requests per thread, %ld CPUs online, ns per request (start + end):\n",
+           requests, sysconf(_SC_NPROCESSORS_ONLN));
+    printf("  %8s %14s %14s\n", "threads", "shared", "sharded");
+    for (size_t i = 0; i < sizeof(thread_counts) / sizeof(thread_counts[0]); i++)
+    {
+        int threads = thread_counts[i];
+        double shared_ns = measure(0, threads, requests);
+        double sharded_ns = measure(1, threads, requests);
+        expected += (unsigned long long)threads * requests;
+        printf("  %8d %11.1f ns %11.1f ns\n", threads, shared_ns, sharded_ns);
+    }
+
+    // shard를 합친 값이 기록한 요청 수와 같은지 확인
+    struct backend_stats stats;
+    read_pool_stats(&pool, &stats);
+    printf("sharded total %llu of %llu requests, avg response %.2f ms\n",
+           stats.total_requests, expected, stats.avg_response_time);
+
+    cleanup_backend_pool(&pool);
+    return stats.total_requests == expected ? 0 : 1;
+}
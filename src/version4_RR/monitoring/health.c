@@ -4,15 +4,26 @@
 #include <stdlib.h>
 #include <stdatomic.h>
 
+// 스레드마다 처음 통계를 쓸 때 shard 하나를 차례로 배정
+static atomic_uint next_shard;
+static __thread int thread_shard = -1;
+
+static struct stat_shard *current_shard(struct backend_pool *pool)
+{
+    if (thread_shard < 0)
+        thread_shard = (int)(atomic_fetch_add(&next_shard, 1) & (STAT_SHARDS - 1));
+    return &pool->shards[thread_shard];
+}
+
 void init_backend_pool(struct backend_pool *pool)
 {
     // 풀 mutex 초기화
     // pthread_mutex_init(&pool->pool_mutex, NULL);
     pool->server_count = MAX_BACKENDS;
-    atomic_init(&pool->total_requests, 0);
-    atomic_init(&pool->total_failures, 0);
-    pool->total_response_time = 0;
-    pool->avg_response_time = 0;
+    memset(pool->shards, 0, sizeof(pool->shards));
+    for (int i = 0; i < STAT_SHARDS; i++)
+        for (int j = 0; j < MAX_BACKENDS; j++)
+            histogram_init(&pool->shards[i].latency[j]);
 
     for (int i = 0; i < pool->server_count; i++)
     {
@@ -23,11 +34,7 @@ void init_backend_pool(struct backend_pool *pool)
         atomic_init(&server->is_healthy, true);
         atomic_init(&server->failed_responses, 0);
         atomic_init(&server->current_requests, 0);
-        atomic_init(&server->total_requests, 0);
-        atomic_init(&server->total_failures, 0);
-        server->total_response_time = 0;
-        server->avg_response_time = 0;
-        server->failure_rate = 0;
+        upstream_pool_init(&server->idle_connections);
     }
 }
 
@@ -41,35 +48,32 @@ void cleanup_backend_pool(struct backend_pool *pool)
     // }
     // pthread_mutex_unlock(&pool->pool_mutex);
     // pthread_mutex_destroy(&pool->pool_mutex);
+
+    for (int i = 0; i < pool->server_count; i++)
+    {
+        upstream_pool_destroy(&pool->servers[i].idle_connections);
+    }
 }
 
 void track_request_start(struct backend_pool *pool, int server_idx)
 {
     struct backend_server *server = &pool->servers[server_idx];
 
+    // 다른 스레드와 함께 쓰는 값은 처리 중인 요청 수뿐이고, 총 요청 수는 이 스레드의 shard에 더함
     atomic_fetch_add(&server->current_requests, 1);
-    atomic_fetch_add(&server->total_requests, 1);
-    atomic_fetch_add(&pool->total_requests, 1);
+    atomic_fetch_add_explicit(&current_shard(pool)->requests[server_idx], 1, memory_order_relaxed);
 }
 
 void track_request_end(struct backend_pool *pool, int server_idx, bool success, double response_time)
 {
     struct backend_server *server = &pool->servers[server_idx];
+    struct stat_shard *shard = current_shard(pool);
 
     atomic_fetch_sub(&server->current_requests, 1);
 
     if (!success)
-    {
-        atomic_fetch_add(&server->total_failures, 1);
-        atomic_fetch_add(&pool->total_failures, 1);
-    }
-
-    server->total_response_time += response_time;
-    server->avg_response_time = server->total_response_time / atomic_load(&server->total_requests);
-    server->failure_rate = ((double)atomic_load(&server->total_failures) / atomic_load(&server->total_requests)) * 100;
-
-    pool->total_response_time += response_time;
-    pool->avg_response_time = pool->total_response_time / atomic_load(&pool->total_requests);
+        atomic_fetch_add_explicit(&shard->failures[server_idx], 1, memory_order_relaxed);
+    histogram_record(&shard->latency[server_idx], response_time > 0 ? (unsigned long long)(response_time * 1000) : 0);
 
     update_server_status(pool, server_idx, success);
 }
@@ -88,8 +92,11 @@ void update_server_status(struct backend_pool *pool, int server_idx, bool reques
     }
     else
     {
-        atomic_store(&server->failed_responses, 0);
-        atomic_store(&server->is_healthy, true);
+        // 성공한 요청마다 쓰면 모든 스레드가 서버 정보의 캐시 라인을 뺏으므로 값이 바뀔 때만 씀
+        if (atomic_load(&server->failed_responses) != 0)
+            atomic_store(&server->failed_responses, 0);
+        if (!atomic_load(&server->is_healthy))
+            atomic_store(&server->is_healthy, true);
     }
 }
 
@@ -97,4 +104,68 @@ bool is_server_available(struct backend_pool *pool, int server_idx)
 {
     struct backend_server *server = &pool->servers[server_idx];
     return atomic_load(&server->is_healthy);
-}
\ No newline at end of file
+}
+
+// 평균은 응답 시간을 기록한(끝난) 요청 수로 나눔
+static void fill_stats(struct backend_stats *stats, unsigned long long response_time_us, unsigned long long timed)
+{
+    stats->avg_response_time = timed > 0 ? response_time_us / 1000.0 / timed : 0;
+    stats->failure_rate = stats->total_requests > 0 ? (double)stats->total_failures / stats->total_requests * 100 : 0;
+}
+
+static void add_latency_totals(const struct latency_histogram *latency, unsigned long long *response_time_us,
+                               unsigned long long *timed)
+{
+    *response_time_us += atomic_load_explicit(&latency->sum_us, memory_order_relaxed);
+    *timed += atomic_load_explicit(&latency->total_count, memory_order_relaxed);
+}
+
+void read_server_stats(struct backend_pool *pool, int server_idx, struct backend_stats *stats)
+{
+    unsigned long long response_time_us = 0;
+    unsigned long long timed = 0;
+
+    stats->total_requests = 0;
+    stats->total_failures = 0;
+    for (int i = 0; i < STAT_SHARDS; i++)
+    {
+        struct stat_shard *shard = &pool->shards[i];
+        stats->total_requests += atomic_load_explicit(&shard->requests[server_idx], memory_order_relaxed);
+        stats->total_failures += atomic_load_explicit(&shard->failures[server_idx], memory_order_relaxed);
+        add_latency_totals(&shard->latency[server_idx], &response_time_us, &timed);
+    }
+    fill_stats(stats, response_time_us, timed);
+}
+
+void read_pool_stats(struct backend_pool *pool, struct backend_stats *stats)
+{
+    unsigned long long response_time_us = 0;
+    unsigned long long timed = 0;
+
+    stats->total_requests = 0;
+    stats->total_failures = 0;
+    for (int i = 0; i < STAT_SHARDS; i++)
+    {
+        struct stat_shard *shard = &pool->shards[i];
+        for (int j = 0; j < pool->server_count; j++)
+        {
+            stats->total_requests += atomic_load_explicit(&shard->requests[j], memory_order_relaxed);
+            stats->total_failures += atomic_load_explicit(&shard->failures[j], memory_order_relaxed);
+            add_latency_totals(&shard->latency[j], &response_time_us, &timed);
+        }
+    }
+    fill_stats(stats, response_time_us, timed);
+}
+
+void read_server_latency(struct backend_pool *pool, int server_idx, struct histogram_snapshot *snapshot)
+{
+    for (int i = 0; i < STAT_SHARDS; i++)
+        histogram_snapshot_add(snapshot, &pool->shards[i].latency[server_idx]);
+}
+
+void read_pool_latency(struct backend_pool *pool, struct histogram_snapshot *snapshot)
+{
+    for (int i = 0; i < STAT_SHARDS; i++)
+        for (int j = 0; j < pool->server_count; j++)
+            histogram_snapshot_add(snapshot, &pool->shards[i].latency[j]);
+}
@@ -0,0 +1,528 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <limits.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <sys/socket.h>
+#include <sys/epoll.h>
+#include <sys/timerfd.h>
+#include <sys/eventfd.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include "health_check.h"
+#include "../utils/logger.h"
+
+// epoll data로 구분하는 이벤트 (0 ~ MAX_BACKENDS - 1은 서버 인덱스)
+#define EVENT_INTERVAL (MAX_BACKENDS + 0)
+#define EVENT_DEADLINE (MAX_BACKENDS + 1)
+#define EVENT_STOP (MAX_BACKENDS + 2)
+
+#define PROBE_REQUEST_MAX (HEALTH_CHECK_PATH_MAX + 128)
+#define PROBE_STATUS_MAX 64 // 상태 줄("HTTP/1.1 200 OK")만 읽으면 되므로 앞부분만 보관
+
+enum probe_state
+{
+    PROBE_IDLE,
+    PROBE_CONNECTING,
+    PROBE_SENDING,
+    PROBE_READING,
+    PROBE_DRAINING // 결과는 이미 반영, 백엔드가 RST를 받지 않도록 남은 응답을 읽고 닫음
+};
+
+// 서버 하나에 대한 프로브 상태 (헬스 체크 스레드만 사용하므로 잠금 없음)
+struct probe
+{
+    int fd;
+    enum probe_state state;
+    char request[PROBE_REQUEST_MAX];
+    size_t request_len;
+    size_t sent;
+    char status[PROBE_STATUS_MAX];
+    size_t status_len;
+    char error[64]; // 마지막 실패 이유 (상태 변경 로그용)
+
+    int rise_count; // 비정상 상태에서 연속 성공 횟수
+    int fall_count; // 정상 상태에서 연속 실패 횟수
+};
+
+static struct
+{
+    pthread_t thread;
+    atomic_bool running;
+    struct backend_pool *pool;
+    struct health_check_options options;
+    int epoll_fd;
+    int interval_fd;
+    int deadline_fd;
+    int stop_fd;
+    int pending; // 이번 주기에서 아직 끝나지 않은 프로브 수
+    struct probe probes[MAX_BACKENDS];
+} checker = {.epoll_fd = -1, .interval_fd = -1, .deadline_fd = -1, .stop_fd = -1};
+
+void health_check_options_init(struct health_check_options *options)
+{
+    options->interval_ms = DEFAULT_HEALTH_CHECK_INTERVAL_MS;
+    options->timeout_ms = DEFAULT_HEALTH_CHECK_TIMEOUT_MS;
+    options->rise = DEFAULT_HEALTH_CHECK_RISE;
+    options->fall = DEFAULT_HEALTH_CHECK_FALL;
+    snprintf(options->path, sizeof(options->path), "%s", DEFAULT_HEALTH_CHECK_PATH);
+}
+
+static int parse_int(const char *text, int min, int *value)
+{
+    char *end;
+    long parsed = strtol(text, &end, 10);
+    if (end == text || *end != '\0' || parsed < min || parsed > INT_MAX)
+        return -1;
+    *value = (int)parsed;
+    return 0;
+}
+
+int health_check_options_set(struct health_check_options *options, const char *spec)
+{
+    const char *eq = strchr(spec, '=');
+    if (!eq)
+        return -1;
+    size_t key_len = (size_t)(eq - spec);
+    const char *value = eq + 1;
+
+    if (key_len == 8 && strncmp(spec, "interval", key_len) == 0)
+        return parse_int(value, 0, &options->interval_ms);
+    if (key_len == 7 && strncmp(spec, "timeout", key_len) == 0)
+        return parse_int(value, 1, &options->timeout_ms);
+    if (key_len == 4 && strncmp(spec, "rise", key_len) == 0)
+        return parse_int(value, 1, &options->rise);
+    if (key_len == 4 && strncmp(spec, "fall", key_len) == 0)
+        return parse_int(value, 1, &options->fall);
+    if (key_len == 4 && strncmp(spec, "path", key_len) == 0)
+    {
+        // 요청 줄에 그대로 들어가므로 공백이나 줄바꿈이 없는 절대 경로만 허용
+        size_t len = strlen(value);
+        if (value[0] != '/' || len >= sizeof(options->path) || strpbrk(value, " \t\r\n"))
+            return -1;
+        memcpy(options->path, value, len + 1);
+        return 0;
+    }
+    return -1;
+}
+
+int health_check_running(void)
+{
+    return atomic_load(&checker.running);
+}
+
+static void set_timer(int fd, int value_ms, int interval_ms)
+{
+    struct itimerspec spec;
+    memset(&spec, 0, sizeof(spec));
+    spec.it_value.tv_sec = value_ms / 1000;
+    spec.it_value.tv_nsec = (long)(value_ms % 1000) * 1000000;
+    spec.it_interval.tv_sec = interval_ms / 1000;
+    spec.it_interval.tv_nsec = (long)(interval_ms % 1000) * 1000000;
+    timerfd_settime(fd, 0, &spec, NULL);
+}
+
+static void drain_fd(int fd)
+{
+    uint64_t count;
+    while (read(fd, &count, sizeof(count)) == sizeof(count))
+        ;
+}
+
+// 프로브 결과를 rise/fall 기준에 반영하고, 기준을 넘으면 서버 상태를 바꿈
+static void apply_result(int idx, int success)
+{
+    struct backend_server *server = &checker.pool->servers[idx];
+    struct probe *probe = &checker.probes[idx];
+
+    // 요청 처리 중 실패(passive)로 바뀐 상태도 있으므로 매번 현재 상태를 읽음
+    bool healthy = atomic_load(&server->is_healthy);
+
+    if (success)
+    {
+        probe->fall_count = 0;
+        if (healthy)
+        {
+            probe->rise_count = 0;
+            return;
+        }
+        if (++probe->rise_count < checker.options.rise)
+            return;
+        probe->rise_count = 0;
+        atomic_store(&server->failed_responses, 0);
+        atomic_store(&server->is_healthy, true);
+    }
+    else
+    {
+        probe->rise_count = 0;
+        if (!healthy)
+        {
+            probe->fall_count = 0;
+            return;
+        }
+        if (++probe->fall_count < checker.options.fall)
+            return;
+        probe->fall_count = 0;
+        atomic_store(&server->is_healthy, false);
+        log_message(LOG_ERROR, "Health check %s:%d failed %d times: %s",
+                    server->address, server->port, checker.options.fall, probe->error);
+    }
+    log_server_status_change(server->address, server->port, success);
+}
+
+static void close_probe(int idx)
+{
+    struct probe *probe = &checker.probes[idx];
+
+    // close하면 epoll에서도 빠짐
+    close(probe->fd);
+    probe->fd = -1;
+    probe->state = PROBE_IDLE;
+    checker.pending--;
+}
+
+static void finish_probe(int idx, int success, const char *error)
+{
+    struct probe *probe = &checker.probes[idx];
+    if (probe->state == PROBE_IDLE || probe->state == PROBE_DRAINING)
+        return;
+
+    close_probe(idx);
+    snprintf(probe->error, sizeof(probe->error), "%s", error);
+    apply_result(idx, success);
+}
+
+// Connection: close로 보냈으므로 백엔드가 닫을 때까지 읽어서 버림
+static void probe_drain(int idx)
+{
+    char scratch[4096];
+
+    for (;;)
+    {
+        ssize_t n = recv(checker.probes[idx].fd, scratch, sizeof(scratch), 0);
+        if (n > 0)
+            continue;
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+            return;
+        close_probe(idx);
+        return;
+    }
+}
+
+static void watch_probe(int idx, uint32_t events, int op)
+{
+    struct epoll_event ev;
+    ev.events = events;
+    ev.data.u64 = (uint64_t)idx;
+    epoll_ctl(checker.epoll_fd, op, checker.probes[idx].fd, &ev);
+}
+
+// 요청을 보낼 수 있는 만큼 보내고, 다 보냈으면 응답 대기로 전환
+static void probe_send(int idx)
+{
+    struct probe *probe = &checker.probes[idx];
+
+    while (probe->sent < probe->request_len)
+    {
+        ssize_t n = send(probe->fd, probe->request + probe->sent, probe->request_len - probe->sent, MSG_NOSIGNAL);
+        if (n < 0)
+        {
+            if (errno == EAGAIN || errno == EWOULDBLOCK)
+                return;
+            if (errno == EINTR)
+                continue;
+            finish_probe(idx, 0, "send failed");
+            return;
+        }
+        probe->sent += (size_t)n;
+    }
+    probe->state = PROBE_READING;
+    watch_probe(idx, EPOLLIN, EPOLL_CTL_MOD);
+}
+
+// 상태 줄을 다 받으면 2xx/3xx인지 확인 (본문은 결과와 상관없이 읽고 버림)
+static void probe_receive(int idx)
+{
+    struct probe *probe = &checker.probes[idx];
+
+    for (;;)
+    {
+        ssize_t n = recv(probe->fd, probe->status + probe->status_len,
+                         sizeof(probe->status) - 1 - probe->status_len, 0);
+        if (n < 0)
+        {
+            if (errno == EAGAIN || errno == EWOULDBLOCK)
+                return;
+            if (errno == EINTR)
+                continue;
+            finish_probe(idx, 0, "recv failed");
+            return;
+        }
+        if (n == 0)
+        {
+            finish_probe(idx, 0, "connection closed before status line");
+            return;
+        }
+        probe->status_len += (size_t)n;
+        probe->status[probe->status_len] = '\0';
+        if (strstr(probe->status, "\r\n") || probe->status_len == sizeof(probe->status) - 1)
+            break;
+    }
+
+    int status = 0;
+    if (strncmp(probe->status, "HTTP/1.", 7) != 0 || sscanf(probe->status + 8, " %3d", &status) != 1)
+    {
+        finish_probe(idx, 0, "invalid status line");
+        return;
+    }
+    if (status < 200 || status >= 400)
+        snprintf(probe->error, sizeof(probe->error), "status %d", status);
+    probe->state = PROBE_DRAINING;
+    apply_result(idx, status >= 200 && status < 400);
+    probe_drain(idx);
+}
+
+static void start_probe(int idx)
+{
+    struct backend_server *server = &checker.pool->servers[idx];
+    struct probe *probe = &checker.probes[idx];
+    struct sockaddr_in addr;
+
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(server->port);
+    if (inet_pton(AF_INET, server->address, &addr.sin_addr) != 1)
+    {
+        snprintf(probe->error, sizeof(probe->error), "invalid address");
+        apply_result(idx, 0);
+        return;
+    }
+
+    probe->fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (probe->fd < 0)
+    {
+        // 프록시 쪽 자원 문제이므로 서버 상태에는 반영하지 않음
+        log_message(LOG_ERROR, "Health check socket failed: %s", strerror(errno));
+        return;
+    }
+
+    probe->request_len = (size_t)snprintf(probe->request, sizeof(probe->request),
+                                          "GET %s HTTP/1.1\r\n"
+                                          "Host: %s:%d\r\n"
+                                          "User-Agent: NginxX-health-check\r\n"
+                                          "Connection: close\r\n"
+                                          "\r\n",
+                                          checker.options.path, server->address, server->port);
+    probe->sent = 0;
+    probe->status_len = 0;
+    probe->state = PROBE_CONNECTING;
+    checker.pending++;
+
+    if (connect(probe->fd, (struct sockaddr *)&addr, sizeof(addr)) == 0)
+    {
+        probe->state = PROBE_SENDING;
+        watch_probe(idx, EPOLLOUT, EPOLL_CTL_ADD);
+        probe_send(idx);
+    }
+    else if (errno == EINPROGRESS)
+    {
+        watch_probe(idx, EPOLLOUT, EPOLL_CTL_ADD);
+    }
+    else
+    {
+        finish_probe(idx, 0, strerror(errno));
+    }
+}
+
+static void handle_probe_event(int idx)
+{
+    struct probe *probe = &checker.probes[idx];
+
+    switch (probe->state)
+    {
+    case PROBE_CONNECTING:
+    {
+        int err = 0;
+        socklen_t len = sizeof(err);
+        if (getsockopt(probe->fd, SOL_SOCKET, SO_ERROR, &err, &len) < 0)
+            err = errno;
+        if (err != 0)
+        {
+            finish_probe(idx, 0, strerror(err));
+            return;
+        }
+        probe->state = PROBE_SENDING;
+        probe_send(idx);
+        break;
+    }
+    case PROBE_SENDING:
+        probe_send(idx);
+        break;
+    case PROBE_READING:
+        // 상태 줄을 받기 전에 에러가 나도 recv가 확인함
+        probe_receive(idx);
+        break;
+    case PROBE_DRAINING:
+        probe_drain(idx);
+        break;
+    default:
+        break;
+    }
+}
+
+// 주기마다 모든 서버에 동시에 프로브를 보내고, 응답 제한 시간 타이머를 설정
+static void start_round(void)
+{
+    for (int i = 0; i < checker.pool->server_count; i++)
+        start_probe(i);
+    if (checker.pending > 0)
+        set_timer(checker.deadline_fd, checker.options.timeout_ms, 0);
+}
+
+// 제한 시간 안에 끝나지 않은 프로브는 실패로 처리
+static void expire_round(void)
+{
+    for (int i = 0; i < checker.pool->server_count; i++)
+    {
+        if (checker.probes[i].state == PROBE_DRAINING)
+            close_probe(i);
+        else
+            finish_probe(i, 0, "timed out");
+    }
+    set_timer(checker.deadline_fd, 0, 0);
+}
+
+static void *health_check_main(void *arg)
+{
+    struct epoll_event events[MAX_BACKENDS + 3];
+    (void)arg;
+
+    for (;;)
+    {
+        int n = epoll_wait(checker.epoll_fd, events, MAX_BACKENDS + 3, -1);
+        if (n < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            log_message(LOG_ERROR, "Health check epoll_wait failed: %s", strerror(errno));
+            break;
+        }
+
+        for (int i = 0; i < n; i++)
+        {
+            uint64_t tag = events[i].data.u64;
+            if (tag == EVENT_STOP)
+                return NULL;
+            if (tag == EVENT_DEADLINE)
+            {
+                drain_fd(checker.deadline_fd);
+                expire_round();
+            }
+            else if (tag == EVENT_INTERVAL)
+            {
+                drain_fd(checker.interval_fd);
+                // 이전 주기가 남아 있으면(이벤트가 한 번에 몰린 경우) 먼저 실패로 정리
+                if (checker.pending > 0)
+                    expire_round();
+                start_round();
+            }
+            else
+            {
+                handle_probe_event((int)tag);
+            }
+        }
+    }
+    return NULL;
+}
+
+static int watch_fd(int fd, uint64_t tag)
+{
+    struct epoll_event ev;
+    ev.events = EPOLLIN;
+    ev.data.u64 = tag;
+    return epoll_ctl(checker.epoll_fd, EPOLL_CTL_ADD, fd, &ev);
+}
+
+static void close_fds(void)
+{
+    int *fds[] = {&checker.epoll_fd, &checker.interval_fd, &checker.deadline_fd, &checker.stop_fd};
+    for (size_t i = 0; i < sizeof(fds) / sizeof(fds[0]); i++)
+    {
+        if (*fds[i] >= 0)
+            close(*fds[i]);
+        *fds[i] = -1;
+    }
+}
+
+int health_check_start(struct backend_pool *pool, const struct health_check_options *options)
+{
+    if (options->interval_ms <= 0 || atomic_load(&checker.running))
+        return 0;
+
+    checker.pool = pool;
+    checker.options = *options;
+    // 다음 주기가 시작되기 전에 이번 주기가 끝나도록 제한
+    if (checker.options.timeout_ms <= 0 || checker.options.timeout_ms > checker.options.interval_ms)
+        checker.options.timeout_ms = checker.options.interval_ms;
+    checker.pending = 0;
+    for (int i = 0; i < MAX_BACKENDS; i++)
+    {
+        memset(&checker.probes[i], 0, sizeof(checker.probes[i]));
+        checker.probes[i].fd = -1;
+    }
+
+    checker.epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    checker.interval_fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    checker.deadline_fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    checker.stop_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (checker.epoll_fd < 0 || checker.interval_fd < 0 || checker.deadline_fd < 0 || checker.stop_fd < 0 ||
+        watch_fd(checker.interval_fd, EVENT_INTERVAL) < 0 || watch_fd(checker.deadline_fd, EVENT_DEADLINE) < 0 ||
+        watch_fd(checker.stop_fd, EVENT_STOP) < 0)
+    {
+        log_message(LOG_ERROR, "Health check setup failed: %s", strerror(errno));
+        close_fds();
+        return -1;
+    }
+
+    // 시작하자마자 첫 주기를 돌리고 이후 interval마다 반복
+    set_timer(checker.interval_fd, 1, checker.options.interval_ms);
+
+    if (pthread_create(&checker.thread, NULL, health_check_main, NULL) != 0)
+    {
+        log_message(LOG_ERROR, "Health check thread creation failed");
+        close_fds();
+        return -1;
+    }
+    atomic_store(&checker.running, true);
+
+    log_message(LOG_INFO, "Health check started: GET %s every %d ms (timeout %d ms, rise %d, fall %d)",
+                checker.options.path, checker.options.interval_ms, checker.options.timeout_ms,
+                checker.options.rise, checker.options.fall);
+    return 0;
+}
+
+void health_check_stop(void)
+{
+    if (!atomic_load(&checker.running))
+        return;
+
+    uint64_t one = 1;
+    if (write(checker.stop_fd, &one, sizeof(one)) < 0)
+        log_message(LOG_ERROR, "Health check stop signal failed: %s", strerror(errno));
+    pthread_join(checker.thread, NULL);
+    atomic_store(&checker.running, false);
+
+    for (int i = 0; i < MAX_BACKENDS; i++)
+    {
+        if (checker.probes[i].fd >= 0)
+            close(checker.probes[i].fd);
+        checker.probes[i].fd = -1;
+        checker.probes[i].state = PROBE_IDLE;
+    }
+    close_fds();
+}
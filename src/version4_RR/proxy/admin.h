@@ -0,0 +1,35 @@
+#ifndef ADMIN_H
+#define ADMIN_H
+
+// 관리용 HTTP 포트 (GET /metrics에 Prometheus text format으로 응답)
+// - 별도 스레드 없이 기존 이벤트 루프에서 처리: 관리 포트 전용 epoll 인스턴스를 이벤트 루프에 등록하고,
+//   그 fd가 준비되면 admin_server_poll로 쌓인 이벤트를 처리
+// - 응답 본문은 render 함수가 atomic 카운터를 읽기만 해서 만들므로 요청 처리 경로를 잠그지 않음
+// - 응답을 보내면 연결을 닫음 (keep-alive 없음)
+
+#define ADMIN_MAX_CLIENTS 16     // 동시에 처리하는 관리 연결 수, 넘치면 가장 오래된 연결을 닫음
+#define ADMIN_REQUEST_MAX 4096   // 요청 헤더 최대 크기
+#define ADMIN_ADDRESS_LEN 16     // IPv4 주소 문자열 최대 길이 (NUL 포함)
+#define ADMIN_DEFAULT_ADDRESS "127.0.0.1" // 주소를 따로 주지 않으면 같은 호스트에서만 접근할 수 있게 엶
+
+struct admin_server;
+struct metrics_output;
+
+// /metrics 응답 본문을 쓰는 함수 (admin_server_poll을 호출한 스레드에서 실행)
+typedef void (*admin_render_fn)(struct metrics_output *out);
+
+// "[주소:]포트" 형식의 관리 포트 주소 (주소를 생략하면 ADMIN_DEFAULT_ADDRESS), 잘못된 형식이면 -1
+// address는 ADMIN_ADDRESS_LEN 크기 버퍼
+int admin_parse_listen(const char *spec, char *address, int *port);
+
+// address:port에 관리 포트를 열고 준비, 실패하면 NULL
+struct admin_server *admin_server_create(const char *address, int port, admin_render_fn render);
+void admin_server_destroy(struct admin_server *admin);
+
+// 이벤트 루프에 등록할 fd (읽을 수 있으면 처리할 이벤트가 있음)
+int admin_server_fd(const struct admin_server *admin);
+
+// 쌓인 이벤트를 기다리지 않고 처리 (항상 같은 스레드에서 호출)
+void admin_server_poll(struct admin_server *admin);
+
+#endif
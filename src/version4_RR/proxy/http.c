@@ -0,0 +1,510 @@
+#define _GNU_SOURCE
+#include <string.h>
+#include <strings.h>
+#include <stdlib.h>
+#include <ctype.h>
+#include <limits.h>
+#include "http.h"
+#include "http_scan.h"
+
+void http_response_init(struct http_response *resp, int head_request)
+{
+    memset(resp, 0, sizeof(*resp));
+    resp->head_request = head_request;
+    resp->content_length = -1;
+}
+
+// "name:" 으로 시작하는 헤더 줄이면 값의 시작 위치, 아니면 NULL
+static const char *header_value(const char *line, const char *name)
+{
+    size_t name_len = strlen(name);
+    if (strncasecmp(line, name, name_len) != 0 || line[name_len] != ':')
+        return NULL;
+
+    const char *value = line + name_len + 1;
+    while (*value == ' ' || *value == '\t')
+        value++;
+    return value;
+}
+
+static void parse_line(struct http_response *resp)
+{
+    resp->line[resp->line_len] = '\0';
+
+    if (!resp->status_line_done)
+    {
+        // HTTP/1.1 200 OK
+        resp->status_line_done = 1;
+        if (strncmp(resp->line, "HTTP/1.", 7) == 0 && isdigit((unsigned char)resp->line[7]))
+        {
+            resp->http_minor = resp->line[7] - '0';
+            resp->status = atoi(resp->line + 8);
+        }
+        return;
+    }
+
+    const char *value;
+    if ((value = header_value(resp->line, "Content-Length")) != NULL)
+    {
+        resp->content_length = strtoll(value, NULL, 10);
+    }
+    else if ((value = header_value(resp->line, "Transfer-Encoding")) != NULL)
+    {
+        if (strcasestr(value, "chunked"))
+            resp->chunked = 1;
+    }
+    else if ((value = header_value(resp->line, "Connection")) != NULL)
+    {
+        if (strcasestr(value, "close"))
+            resp->connection_close = 1;
+        if (strcasestr(value, "keep-alive"))
+            resp->connection_keep_alive = 1;
+    }
+}
+
+// 헤더가 끝났을 때 본문이 없는 응답인지 확인하고, 1xx 응답이면 다음 응답을 기다림
+static void finish_headers(struct http_response *resp)
+{
+    if (resp->status >= 100 && resp->status < 200 && resp->status != 101)
+    {
+        // 100 Continue 등 중간 응답 이후에 실제 응답이 이어짐
+        http_response_init(resp, resp->head_request);
+        return;
+    }
+
+    resp->headers_done = 1;
+    if (resp->head_request || resp->status == 204 || resp->status == 304)
+    {
+        resp->content_length = 0;
+        resp->chunked = 0;
+    }
+}
+
+// chunked 본문 해석 상태
+#define CHUNK_SIZE_LINE 0    // 16진수 청크 크기
+#define CHUNK_EXTENSION 1    // 크기 뒤의 ;확장 (무시하고 줄 끝까지 건너뜀)
+#define CHUNK_SIZE_LF 2      // 크기 줄의 \r 다음 \n
+#define CHUNK_DATA 3         // 청크 데이터
+#define CHUNK_DATA_CR 4      // 데이터 뒤의 \r\n
+#define CHUNK_DATA_LF 5
+#define CHUNK_TRAILER 6      // 마지막 청크 뒤 trailer 줄의 시작
+#define CHUNK_TRAILER_LINE 7 // trailer 줄 (무시하고 줄 끝까지 건너뜀)
+#define CHUNK_TRAILER_LF 8   // 빈 줄의 \r 다음 \n
+#define CHUNK_DONE 9
+
+// 이보다 큰 청크는 형식 오류로 처리 (16진수 15자리)
+#define CHUNK_SIZE_MAX (1ULL << 60)
+
+static int hex_value(char c)
+{
+    if (c >= '0' && c <= '9')
+        return c - '0';
+    c |= 0x20;
+    if (c >= 'a' && c <= 'f')
+        return c - 'a' + 10;
+    return -1;
+}
+
+// 청크 크기 줄이 끝났을 때 다음 상태
+static void chunk_size_done(struct http_response *resp)
+{
+    if (resp->chunk_size == 0)
+    {
+        resp->chunk_state = CHUNK_TRAILER;
+        return;
+    }
+    resp->chunk_remaining = resp->chunk_size;
+    resp->chunk_state = CHUNK_DATA;
+}
+
+/**
+ * chunked 본문 해석
+ * - 청크 데이터는 복사하거나 검사하지 않고 남은 길이만큼 한 번에 건너뜀
+ * - 반환값: 이 응답에 속하는 바이트 수 (마지막 청크와 trailer 이후의 데이터는 포함하지 않음)
+ */
+static size_t feed_chunked(struct http_response *resp, const char *data, size_t len)
+{
+    size_t i = 0;
+
+    while (i < len && resp->chunk_state != CHUNK_DONE)
+    {
+        if (resp->chunk_state == CHUNK_DATA)
+        {
+            size_t n = len - i;
+            if (n > resp->chunk_remaining)
+                n = (size_t)resp->chunk_remaining;
+            resp->chunk_remaining -= n;
+            i += n;
+            if (resp->chunk_remaining == 0)
+                resp->chunk_state = CHUNK_DATA_CR;
+            continue;
+        }
+
+        char c = data[i++];
+        int digit;
+        switch (resp->chunk_state)
+        {
+        case CHUNK_SIZE_LINE:
+            if ((digit = hex_value(c)) >= 0)
+            {
+                if (resp->chunk_size >= CHUNK_SIZE_MAX)
+                    goto malformed;
+                resp->chunk_size = resp->chunk_size * 16 + (unsigned long long)digit;
+                resp->chunk_digits++;
+            }
+            else if (resp->chunk_digits == 0)
+                goto malformed; // 크기 없이 줄이 시작됨
+            else if (c == ';' || c == ' ' || c == '\t')
+                resp->chunk_state = CHUNK_EXTENSION;
+            else if (c == '\r')
+                resp->chunk_state = CHUNK_SIZE_LF;
+            else if (c == '\n')
+                chunk_size_done(resp);
+            else
+                goto malformed;
+            break;
+        case CHUNK_EXTENSION:
+            if (c == '\n')
+                chunk_size_done(resp);
+            break;
+        case CHUNK_SIZE_LF:
+            if (c != '\n')
+                goto malformed;
+            chunk_size_done(resp);
+            break;
+        case CHUNK_DATA_CR:
+            if (c == '\r')
+                resp->chunk_state = CHUNK_DATA_LF;
+            else if (c == '\n')
+                goto next_chunk;
+            else
+                goto malformed;
+            break;
+        case CHUNK_DATA_LF:
+            if (c != '\n')
+                goto malformed;
+        next_chunk:
+            resp->chunk_state = CHUNK_SIZE_LINE;
+            resp->chunk_size = 0;
+            resp->chunk_digits = 0;
+            break;
+        case CHUNK_TRAILER:
+            if (c == '\r')
+                resp->chunk_state = CHUNK_TRAILER_LF;
+            else if (c == '\n')
+                resp->chunk_state = CHUNK_DONE;
+            else
+                resp->chunk_state = CHUNK_TRAILER_LINE;
+            break;
+        case CHUNK_TRAILER_LINE:
+            if (c == '\n')
+                resp->chunk_state = CHUNK_TRAILER;
+            break;
+        case CHUNK_TRAILER_LF:
+            if (c != '\n')
+                goto malformed;
+            resp->chunk_state = CHUNK_DONE;
+            break;
+        }
+    }
+    return i;
+
+malformed:
+    // 끝을 알 수 없으므로 백엔드가 연결을 닫을 때까지 그대로 전달하고, 연결은 재사용하지 않음
+    resp->malformed = 1;
+    return len;
+}
+
+size_t http_response_feed(struct http_response *resp, const char *data, size_t len)
+{
+    size_t i = 0;
+
+    while (!resp->headers_done && i < len)
+    {
+        char c = data[i++];
+        if (c == '\n')
+        {
+            // 빈 줄이면 헤더 끝
+            if (resp->line_len == 0 && resp->status_line_done)
+                finish_headers(resp);
+            else
+                parse_line(resp);
+            resp->line_len = 0;
+        }
+        else if (c != '\r' && resp->line_len < HTTP_LINE_MAX - 1)
+        {
+            resp->line[resp->line_len++] = c;
+        }
+    }
+
+    if (!resp->headers_done || i == len)
+        return i;
+
+    size_t body = len - i;
+    if (resp->chunked && !resp->malformed)
+    {
+        body = feed_chunked(resp, data + i, body);
+        resp->body_received += body;
+        if (i + body < len)
+            resp->trailing_data = 1;
+        return i + body;
+    }
+
+    size_t remaining = http_response_remaining(resp);
+    if (body > remaining)
+    {
+        resp->trailing_data = 1;
+        body = remaining;
+    }
+    resp->body_received += body;
+    return i + body;
+}
+
+int http_response_complete(const struct http_response *resp)
+{
+    if (!resp->headers_done || resp->malformed)
+        return 0;
+    if (resp->chunked)
+        return resp->chunk_state == CHUNK_DONE;
+    return resp->content_length >= 0 && resp->body_received >= (unsigned long long)resp->content_length;
+}
+
+int http_response_length_known(const struct http_response *resp)
+{
+    return resp->headers_done && !resp->chunked;
+}
+
+size_t http_response_remaining(const struct http_response *resp)
+{
+    if (!resp->headers_done || resp->chunked || resp->content_length < 0)
+        return (size_t)-1;
+    return (size_t)(resp->content_length - (long long)resp->body_received);
+}
+
+int http_response_keep_alive(const struct http_response *resp)
+{
+    if (!http_response_complete(resp) || resp->trailing_data || resp->connection_close)
+        return 0;
+    // HTTP/1.1은 기본이 keep-alive, HTTP/1.0은 명시한 경우에만
+    return resp->http_minor >= 1 || resp->connection_keep_alive;
+}
+
+#define HTTP_REQUEST_LINE 0
+#define HTTP_REQUEST_HEADERS 1
+#define HTTP_REQUEST_DONE 2
+
+void http_request_init(struct http_request *req)
+{
+    memset(req, 0, sizeof(*req));
+    req->content_length = -1;
+    req->line_colon = HTTP_SCAN_NONE;
+}
+
+static struct http_slice make_slice(const char *data, const char *start, const char *end)
+{
+    struct http_slice slice = {(uint32_t)(start - data), (uint32_t)(end - start)};
+    return slice;
+}
+
+// 쉼표로 구분된 값 목록에 token이 있는지 (Connection: keep-alive, Upgrade 등)
+static int has_token(const char *value, size_t len, const char *token)
+{
+    size_t token_len = strlen(token);
+    const char *end = value + len;
+
+    while (value < end)
+    {
+        while (value < end && (*value == ' ' || *value == '\t' || *value == ','))
+            value++;
+        const char *item = value;
+        while (value < end && *value != ',')
+            value++;
+        const char *item_end = value;
+        while (item_end > item && (item_end[-1] == ' ' || item_end[-1] == '\t'))
+            item_end--;
+
+        if ((size_t)(item_end - item) == token_len && strncasecmp(item, token, token_len) == 0)
+            return 1;
+    }
+    return 0;
+}
+
+// RFC 9110 9.2.2의 멱등 메서드인지 (실패한 요청을 다른 서버로 다시 보내도 되는지)
+static int method_idempotent(const char *method, size_t len)
+{
+    static const char *const methods[] = {"GET", "HEAD", "PUT", "DELETE", "OPTIONS", "TRACE"};
+    for (size_t i = 0; i < sizeof(methods) / sizeof(methods[0]); i++)
+    {
+        if (strlen(methods[i]) == len && memcmp(method, methods[i], len) == 0)
+            return 1;
+    }
+    return 0;
+}
+
+// 요청 줄 해석: GET /path HTTP/1.1
+static int parse_request_line(struct http_request *req, const char *data, const char *line, const char *end)
+{
+    const char *method_end = memchr(line, ' ', (size_t)(end - line));
+    if (!method_end || method_end == line)
+        return HTTP_PARSE_ERROR;
+
+    const char *uri = method_end + 1;
+    const char *uri_end = memchr(uri, ' ', (size_t)(end - uri));
+    if (!uri_end || uri_end == uri)
+        return HTTP_PARSE_ERROR;
+
+    const char *version = uri_end + 1;
+    if (end - version != 8 || memcmp(version, "HTTP/1.", 7) != 0 || !isdigit((unsigned char)version[7]))
+        return HTTP_PARSE_ERROR;
+
+    req->method = make_slice(data, line, method_end);
+    req->uri = make_slice(data, uri, uri_end);
+    req->http_minor = version[7] - '0';
+    req->head_request = (method_end - line == 4 && memcmp(line, "HEAD", 4) == 0);
+    req->idempotent = method_idempotent(line, (size_t)(method_end - line));
+    req->keep_alive = req->http_minor >= 1;
+    return HTTP_PARSE_AGAIN;
+}
+
+// 이름 길이로 후보를 좁힌 뒤 한 번만 비교
+static int header_id(const char *name, size_t len)
+{
+    switch (len)
+    {
+    case 4:
+        return strncasecmp(name, "Host", 4) == 0 ? HTTP_HEADER_HOST : -1;
+    case 10:
+        return strncasecmp(name, "Connection", 10) == 0 ? HTTP_HEADER_CONNECTION : -1;
+    case 14:
+        return strncasecmp(name, "Content-Length", 14) == 0 ? HTTP_HEADER_CONTENT_LENGTH : -1;
+    case 17:
+        return strncasecmp(name, "Transfer-Encoding", 17) == 0 ? HTTP_HEADER_TRANSFER_ENCODING : -1;
+    default:
+        return -1;
+    }
+}
+
+static int parse_header_line(struct http_request *req, const char *data, const char *line, const char *end,
+                             size_t colon_pos)
+{
+    if (colon_pos == HTTP_SCAN_NONE || data + colon_pos == line)
+        return HTTP_PARSE_ERROR;
+    const char *colon = data + colon_pos;
+
+    int id = header_id(line, (size_t)(colon - line));
+    if (id < 0)
+        return HTTP_PARSE_AGAIN;
+
+    const char *value = colon + 1;
+    while (value < end && (*value == ' ' || *value == '\t'))
+        value++;
+    const char *value_end = end;
+    while (value_end > value && (value_end[-1] == ' ' || value_end[-1] == '\t'))
+        value_end--;
+    size_t value_len = (size_t)(value_end - value);
+
+    // 같은 헤더가 여러 번 오면 첫 번째를 기록
+    if (req->headers[id].length == 0)
+        req->headers[id] = make_slice(data, value, value_end);
+
+    switch (id)
+    {
+    case HTTP_HEADER_CONTENT_LENGTH:
+    {
+        long long length = 0;
+        if (value_len == 0)
+            return HTTP_PARSE_ERROR;
+        for (const char *p = value; p < value_end; p++)
+        {
+            if (!isdigit((unsigned char)*p) || length > (LLONG_MAX - 9) / 10)
+                return HTTP_PARSE_ERROR;
+            length = length * 10 + (*p - '0');
+        }
+        // 값이 다른 Content-Length가 여러 개면 본문의 끝을 정할 수 없음
+        if (req->content_length >= 0 && req->content_length != length)
+            return HTTP_PARSE_ERROR;
+        req->content_length = length;
+        break;
+    }
+    case HTTP_HEADER_TRANSFER_ENCODING:
+        req->chunked = 1;
+        break;
+    case HTTP_HEADER_CONNECTION:
+        if (has_token(value, value_len, "close"))
+            req->keep_alive = 0;
+        else if (has_token(value, value_len, "keep-alive"))
+            req->keep_alive = 1;
+        break;
+    }
+    return HTTP_PARSE_AGAIN;
+}
+
+int http_request_parse(struct http_request *req, const char *data, size_t len)
+{
+    while (req->state != HTTP_REQUEST_DONE)
+    {
+        struct http_scan scan;
+        size_t nl = req->scan_pos + http_scan_line(data + req->scan_pos, len - req->scan_pos, &scan);
+        if (req->line_colon == HTTP_SCAN_NONE && scan.colon != HTTP_SCAN_NONE)
+            req->line_colon = req->scan_pos + scan.colon;
+        if (scan.invalid)
+            return HTTP_PARSE_ERROR;
+        if (nl == len)
+        {
+            // 다음 호출에서는 새로 받은 부분부터 검사
+            req->scan_pos = len;
+            return HTTP_PARSE_AGAIN;
+        }
+
+        const char *line = data + req->line_start;
+        const char *end = data + nl;
+        if (end > line && end[-1] == '\r')
+            end--;
+
+        size_t colon_pos = req->line_colon;
+        req->scan_pos = req->line_start = nl + 1;
+        req->line_colon = HTTP_SCAN_NONE;
+
+        int rc;
+        if (req->state == HTTP_REQUEST_LINE)
+        {
+            // 요청 사이의 빈 줄은 무시 (RFC 9112 2.2)
+            if (end == line)
+            {
+                req->request_start = req->line_start;
+                continue;
+            }
+            rc = parse_request_line(req, data, line, end);
+            req->state = HTTP_REQUEST_HEADERS;
+        }
+        else if (end == line)
+        {
+            req->header_len = req->line_start;
+            req->state = HTTP_REQUEST_DONE;
+            rc = HTTP_PARSE_AGAIN;
+        }
+        else
+        {
+            rc = parse_header_line(req, data, line, end, colon_pos);
+        }
+
+        if (rc == HTTP_PARSE_ERROR)
+            return rc;
+    }
+    return HTTP_PARSE_DONE;
+}
+
+const char *http_request_header(const struct http_request *req, const char *data,
+                                enum http_header_id id, size_t *len)
+{
+    const struct http_slice *slice = &req->headers[id];
+    *len = slice->length;
+    return slice->length ? data + slice->offset : NULL;
+}
+
+long long http_request_length(const struct http_request *req)
+{
+    if (req->state != HTTP_REQUEST_DONE || req->chunked)
+        return -1;
+    return (long long)(req->header_len - req->request_start) + (req->content_length > 0 ? req->content_length : 0);
+}